@@ -28,11 +28,21 @@ namespace squads {
     namespace arch {
         
         class arch_mutex_simple_impl : public basic_lock{
+        protected:
+            struct defer_create_t { };
+
+            /**
+             * ctor for sub classes, that create a other native mutex
+             */
+            explicit arch_mutex_simple_impl(defer_create_t)
+                : m_pHandle(NULL),
+                  m_bLocked(false) { }
         public:
+            using basic_lock::lock;
 
             arch_mutex_simple_impl()
                 : m_pHandle(NULL),  
-                  m_bLocked(false) { }
+                  m_bLocked(false) { arch_mutex_simple_impl::create(); }
 
             arch_mutex_simple_impl(arch_mutex_simple_impl& other) 
                 : m_pHandle(other.m_pHandle), 
@@ -64,7 +74,10 @@ namespace squads {
              * @return true if the Lock was acquired, false when not
              */
             bool try_lock() noexcept {
-                return (take(0) == 0);
+                if(!take(0)) return false;
+
+                m_bLocked = true;
+                return true;
             }
 
             /**
@@ -109,14 +122,15 @@ namespace squads {
 
         public:
             virtual int lock(unsigned int timeout = 0) noexcept override { 
-                return take(timeout) ? 0 : 1;
+                if(!take(timeout)) return 1;
+
+                m_bLocked = true;
+                return 0;
             }
             virtual int unlock() noexcept override {
+                m_bLocked = false;
                 return give() ? 0 : 1;
             }
-            virtual int time_lock(const struct timespec *timeout) noexcept override {
-                return 1;
-            }
         protected:
             void* m_pHandle;
             bool m_bLocked;
@@ -124,7 +138,7 @@ namespace squads {
 
         class arch_mutex_recursive_impl : public arch_mutex_simple_impl {
         public:
-            arch_mutex_recursive_impl() : arch_mutex_simple_impl() { }
+            arch_mutex_recursive_impl() : arch_mutex_simple_impl(defer_create_t()) { create(); }
 
             arch_mutex_recursive_impl(arch_mutex_recursive_impl& other) 
                 : arch_mutex_simple_impl(other) { }
@@ -27,6 +27,11 @@ namespace squads {
     namespace arch {
         class arch_queue_impl {
         public:
+            /**
+             * @brief Function called after a item was added, with the listener context.
+             */
+            using listener_type = void (*)(void* ctx);
+
             /**
              *  ctor
              * 
@@ -35,15 +40,16 @@ namespace squads {
              */
             arch_queue_impl(unsigned int maxItems, unsigned int itemSize) 
                 : m_pHandle(0), m_imaxItems(maxItems), 
-                  m_iitemSize(itemSize) { }
+                  m_iitemSize(itemSize), m_pListener(nullptr), m_pListenerCtx(nullptr) { }
 
             arch_queue_impl(const arch_queue_impl& other) 
                 : m_pHandle(other.m_pHandle), m_imaxItems(other.m_imaxItems), 
-                  m_iitemSize(other.m_iitemSize) {  }
+                  m_iitemSize(other.m_iitemSize), m_pListener(nullptr), m_pListenerCtx(nullptr) {  }
 
             arch_queue_impl(const arch_queue_impl&& other) 
                 : m_pHandle(squads::move(other.m_pHandle)), m_imaxItems(squads::move(other.m_imaxItems)), 
-                  m_iitemSize(squads::move(other.m_iitemSize)) {  }
+                  m_iitemSize(squads::move(other.m_iitemSize)),
+                  m_pListener(nullptr), m_pListenerCtx(nullptr) {  }
             
 
             /**
@@ -138,6 +144,18 @@ namespace squads {
 
             bool   is_created() const { return m_pHandle != NULL; }
 
+            /**
+             * Set the listener, that is called after each added item.
+             * Use for readiness notification, like the event_loop.
+             *
+             * @param listener The listener or nullptr to remove it.
+             * @param ctx The context for the listener.
+             */
+            void set_listener(listener_type listener, void* ctx) {
+                m_pListenerCtx = ctx;
+                m_pListener = listener;
+            }
+
             /**
              *  Is the basic_queue empty?
              *  @return true the basic_queue is empty and false when not
@@ -178,6 +196,11 @@ namespace squads {
                 return (m_pHandle != other.m_pHandle);
             }
 
+        private:
+            void notify_listener() {
+                listener_type _listener = m_pListener;
+                if(_listener != nullptr) _listener(m_pListenerCtx);
+            }
         private:
             /**
              *  Arch basic_queue handle.
@@ -187,6 +210,12 @@ namespace squads {
             unsigned int m_imaxItems;
             unsigned int m_iitemSize;
 
+            /**
+             *  The readiness listener and his context.
+             */
+            listener_type m_pListener;
+            void* m_pListenerCtx;
+
         };
 
         inline void swap(arch_queue_impl& a, arch_queue_impl& b) noexcept {
@@ -44,6 +44,68 @@ namespace squads {
          *  @return Current tick count.
          */
         unsigned int arch_get_ticks();
+
+        /**
+         * Get the id of the core, on that the caller run
+         * @return The core id
+         */
+        int arch_get_core_id();
+
+        /**
+         * Is the caller in a ISR context?
+         * @return true in a ISR and false in a task
+         */
+        bool arch_in_isr();
+
+        /**
+         * Get the native handle of the current task
+         * @return The native task handle
+         */
+        void* arch_get_current_task();
+
+        /**
+         * Give a notification to a native task, from a task or ISR context - automatic switch
+         * @param handle The native task handle, nothing happens when NULL
+         */
+        void arch_notify_give(void* handle);
+
+        /**
+         * Abort the blocking wait of a native task, the blocking call returns
+         * like on timeout
+         * @param handle The native task handle
+         * @return true if the task was blocked and false if not
+         */
+        bool arch_abort_delay(void* handle);
+
+        /**
+         * The short, spinning cross core lock, with disabled interrupts on the owning core.
+         * Use only for short sections, no blocking calls inside.
+         */
+        typedef SQUADS_ARCH_CONFIG_MUX_TYPE arch_mux_t;
+
+        void arch_mux_init(arch_mux_t* mux);
+        void arch_mux_lock(arch_mux_t* mux);
+        void arch_mux_unlock(arch_mux_t* mux);
+
+        /**
+         * Block the current task, until arch_unpark or the timeout.
+         * Use a own task notification index, see SQUADS_ARCH_CONFIG_PARK_NOTIFY_INDEX
+         * @param timeout How long to wait in ticks
+         * @return true if unparked and false on timeout (or abort)
+         */
+        bool arch_park(unsigned int timeout);
+
+        /**
+         * Wake up a parked task, a unpark before the park is not lost.
+         * @param handle The native task handle
+         * @note Can call from a ISR.
+         */
+        void arch_unpark(void* handle);
+
+        /**
+         * A short pause in a spin loop.
+         */
+        void arch_cpu_relax();
     
         
 
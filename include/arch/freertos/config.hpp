@@ -49,6 +49,8 @@
 #define SQUADS_THREAD_CONFIG_CORE_IFNO  tskNO_AFFINITY
 
 #define SQUADS_ARCH_CONFIG_BASE_CORE            0
+#define SQUADS_ARCH_CONFIG_NUM_CORES            portNUM_PROCESSORS
+#define SQUADS_ARCH_CONFIG_CACHE_LINE_SIZE      32
 #define SQUADS_ARCH_CONFIG_WORKQUEUE_CORE       1
 #define SQUADS_ARCH_CONFIG_STACK_DEPTH          8192
 #define SQUADS_ARCH_CONFIG_MIN_STACK_DEPTH      4096
@@ -56,9 +58,51 @@
 #define SQUADS_ARCH_CONFIG_TASK_MAXPRO          configMAX_PRIORITIES   
 
 #define SQUADS_ARCH_CONFIG_MAX_DELAY            portMAX_DELAY
+#define SQUADS_ARCH_CONFIG_MUX_TYPE             portMUX_TYPE
+#define SQUADS_ARCH_CONFIG_MUX_INIT             portMUX_INITIALIZER_UNLOCKED
+
+/**
+ * The task notification index for park and unpark, use the second index when
+ * the notification array has more then one entry, so park and unpark don't
+ * collide with the task::notify functions
+ */
+#if defined(configTASK_NOTIFICATION_ARRAY_ENTRIES) && (configTASK_NOTIFICATION_ARRAY_ENTRIES > 1)
+#define SQUADS_ARCH_CONFIG_PARK_NOTIFY_INDEX    1
+#else
+#define SQUADS_ARCH_CONFIG_PARK_NOTIFY_INDEX    0
+#endif
 #define SQUADS_ARCH_NSPER_TICK                  (  1000000000LL / configTICK_RATE_HZ )
 #define SQUADS_ARCH_CLOCKS_PER_SEC              ( ( clock_t ) configTICK_RATE_HZ )
 #define SQUADS_ARCH_TIMESTAMP_RESELUTION        1000000LL
 #define SQUADS_ARCH_SUPPORT_DYNAMIC_ALLOCATION  configSUPPORT_DYNAMIC_ALLOCATION
 #define SQUADS_ARCH_QUEUE_REGISTRY_SIZE         configQUEUE_REGISTRY_SIZE
+#define SQUADS_ARCH_TLS_POINTERS                configNUM_THREAD_LOCAL_STORAGE_POINTERS
+
+/**
+ * The native thread local storage indices from 0, that the platform self uses:
+ * the pthread keys of ESP-IDF are in index 0
+ */
+#ifdef ESP_PLATFORM
+#define SQUADS_ARCH_TLS_RESERVED                1
+#else
+#define SQUADS_ARCH_TLS_RESERVED                0
+#endif
+/**
+ * Read and write a native thread local storage pointer of the current task
+ */
+#define SQUADS_ARCH_TLS_GET(index)              pvTaskGetThreadLocalStoragePointer(NULL, (index))
+#define SQUADS_ARCH_TLS_SET(index, value)       vTaskSetThreadLocalStoragePointer(NULL, (index), (value))
+/**
+ * The data address range of the nodes of a atomic tagged pointer: the base and
+ * the bits of the span. The pointer and the tag are packed in one word, with a
+ * single word compare and swap. ESP32: external RAM (0x3F800000) up to the end
+ * of the internal DRAM (0x40000000). 64 bit hosts: the 48 bit user space.
+ */
+#if defined(CONFIG_IDF_TARGET_ESP32)
+#define SQUADS_ARCH_TAGGED_PTR_BASE             0x3F800000u
+#define SQUADS_ARCH_TAGGED_PTR_ADDRESS_BITS     23
+#elif !defined(ESP_PLATFORM) && (defined(__x86_64__) || defined(__aarch64__))
+#define SQUADS_ARCH_TAGGED_PTR_BASE             0
+#define SQUADS_ARCH_TAGGED_PTR_ADDRESS_BITS     48
+#endif
 #endif
\ No newline at end of file
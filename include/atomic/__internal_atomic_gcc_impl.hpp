@@ -18,8 +18,10 @@
 #ifndef __SQUADS_ATOMIC_INTERNAL_GCC_H__
 #define __SQUADS_ATOMIC_INTERNAL_GCC_H__
 
+#include "config.hpp"
 #include "defines.hpp"
 #include "flags.hpp"
+#include "arch/arch_utils.hpp"
 
 #ifdef __GCC_ATOMIC_BOOL_LOCK_FREE
 #define	ATOMIC_BOOL_LOCK_FREE		__GCC_ATOMIC_BOOL_LOCK_FREE
@@ -54,8 +56,86 @@
 
 namespace squads {
     namespace atomic {
+        namespace internal {
+            /**
+             * @brief The way a basic_atomic_gcc is implemented.
+             */
+            enum atomic_path {
+                atomic_path_native = 0,   /*!< the __atomic builtins, lock free */
+                atomic_path_dwcas = 1,    /*!< a 16 byte compare and swap (cmpxchg16b), lock free */
+                atomic_path_locked = 2    /*!< a stripe of the atomic lock table */
+            };
+
+            template <typename T>
+            struct atomic_path_of {
+                static constexpr int value =
+                    __atomic_always_lock_free(sizeof(T), 0) ? atomic_path_native :
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16) && defined(__SIZEOF_INT128__)
+                    (sizeof(T) == 16) ? atomic_path_dwcas :
+#endif
+                    atomic_path_locked;
+            };
+
+            /**
+             * @brief A stripe of the atomic lock table: writers hold the mux and readers
+             * are lock free, with the sequence counter (seqlock).
+             */
+            struct alignas(SQUADS_CONFIG_CACHE_LINE_SIZE) atomic_stripe {
+                arch::arch_mux_t mux;
+                volatile uint32_t seq;
+
+                atomic_stripe() : seq(0) { arch::arch_mux_init(&mux); }
+
+                void lock() {
+                    arch::arch_mux_lock(&mux);
+                    __atomic_store_n(&seq, seq + 1, __ATOMIC_RELAXED);
+                    __atomic_thread_fence(__ATOMIC_RELEASE);
+                }
+                void unlock() {
+                    __atomic_store_n(&seq, seq + 1, __ATOMIC_RELEASE);
+                    arch::arch_mux_unlock(&mux);
+                }
+            };
+
+            /**
+             * @brief Get the stripe of the atomic lock table for a address.
+             */
+            atomic_stripe& get_atomic_stripe(const volatile void* address);
+        }
+
+        /**
+         * @brief A memory fence between tasks (and cores).
+         */
+        inline void thread_fence(memory_order order) {
+            __atomic_thread_fence(static_cast<int>(order));
+        }
+
+        /**
+         * @brief A compiler fence, between a task and a ISR on the same core.
+         */
+        inline void signal_fence(memory_order order) {
+            __atomic_signal_fence(static_cast<int>(order));
+        }
+
         /**
          *  @brief Generic atomic type, primary class template.
+         *
+         *  Any trivially copyable type can be made atomic. The implementation is chosen at
+         *  compile time: the __atomic builtins for lock free sizes, a 16 byte compare and
+         *  swap when the target has one, else a striped lock table with lock free loads.
+         *  is_lock_free reports, which way was chosen.
+         *
+         *  @code
+         *  struct tagged { void* ptr; uint32_t tag; };
+         *  atomic::basic_atomic_gcc<tagged> top;
+         *
+         *  tagged expected = top.load();
+         *  tagged desired = { node, expected.tag + 1 };
+         *  top.compare_exchange_strong(expected, desired);
+         *  @endcode
+         *
+         *  @note The arithmetic and bit functions can only used with types, that have the
+         *  operators.
          *  @tparam T  Type to be made atomic, must be trivally copyable.
          */
         template <typename T >
@@ -63,7 +143,8 @@ namespace squads {
             static_assert(__is_trivially_copyable(T),"squads::atomic requires a trivially copyable type");
             static_assert(sizeof(T) > 0, "Incomplete or zero-sized types are not supported");
 
-            static constexpr bool is_always_lock_free  = __atomic_always_lock_free(sizeof(T), 0);
+            static constexpr int path = internal::atomic_path_of<T>::value;
+            static constexpr bool is_always_lock_free  = path != internal::atomic_path_locked;
 
             using value_type = T;
             using difference_type = T;
@@ -80,76 +161,161 @@ namespace squads {
 
             value_type get() { return __tValue; }
 
-            void store (value_type v, memory_order order = memory_order::SeqCst)
-                { __atomic_store_n (&__tValue, v, static_cast<int>(order)); }
-
-            value_type load (memory_order order = memory_order::SeqCst) const
-                { return __atomic_load_n (&__tValue, static_cast<int>(order)); }
-
-            value_type exchange (value_type v, memory_order order = memory_order::SeqCst)
-                { return __atomic_exchange_n (&__tValue, v, static_cast<int>(order)); }
-
-            bool compare_exchange_n (value_type& expected, value_type& desired, bool b,
-                                    memory_order order = memory_order::SeqCst)
-                { return __atomic_compare_exchange_n (&__tValue, &expected, desired, b,
-                                                    order, static_cast<int>(order)); }
+            void store (value_type v, memory_order order = memory_order::SeqCst) {
+                if constexpr (path == internal::atomic_path_native) {
+                    __atomic_store (&__tValue, &v, static_cast<int>(order));
+                } else {
+                    exchange(v, order);
+                }
+            }
+
+            value_type load (memory_order order = memory_order::SeqCst) const {
+                value_type _value;
+
+                if constexpr (path == internal::atomic_path_native) {
+                    __atomic_load (&__tValue, &_value, static_cast<int>(order));
+                } else if constexpr (path == internal::atomic_path_dwcas) {
+                    // a compare and swap with the same value is the only 16 byte load
+                    _value = from_dw(__sync_val_compare_and_swap(dw_address(), 0, 0));
+                } else {
+                    internal::atomic_stripe& _stripe = internal::get_atomic_stripe(&__tValue);
+
+                    for(;;) {
+                        uint32_t _seq = __atomic_load_n(&_stripe.seq, __ATOMIC_ACQUIRE);
+                        if((_seq & 1) == 0) {
+                            copy_from_value(_value);
+                            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+                            if(__atomic_load_n(&_stripe.seq, __ATOMIC_RELAXED) == _seq) break;
+                        }
+                        arch::arch_cpu_relax();
+                    }
+                }
+                return _value;
+            }
+
+            value_type exchange (value_type v, memory_order order = memory_order::SeqCst) {
+                value_type _old;
+
+                if constexpr (path == internal::atomic_path_native) {
+                    __atomic_exchange (&__tValue, &v, &_old, static_cast<int>(order));
+                } else if constexpr (path == internal::atomic_path_dwcas) {
+                    _old = load(memory_order::Relaxed);
+                    while(!compare_exchange_weak(_old, v, order)) { }
+                } else {
+                    internal::atomic_stripe& _stripe = internal::get_atomic_stripe(&__tValue);
+
+                    _stripe.lock();
+                    copy_from_value(_old);
+                    copy_to_value(v);
+                    _stripe.unlock();
+                }
+                return _old;
+            }
+
+            bool compare_exchange_n (value_type& expected, value_type desired, bool b,
+                                    memory_order order = memory_order::SeqCst) {
+                if constexpr (path == internal::atomic_path_native) {
+                    return __atomic_compare_exchange (&__tValue, &expected, &desired, b,
+                                                    static_cast<int>(order), failure_order(order));
+                } else if constexpr (path == internal::atomic_path_dwcas) {
+                    dw_type _expected = to_dw(expected);
+                    dw_type _old = __sync_val_compare_and_swap(dw_address(), _expected, to_dw(desired));
+
+                    if(_old == _expected) return true;
+                    expected = from_dw(_old);
+                    return false;
+                } else {
+                    internal::atomic_stripe& _stripe = internal::get_atomic_stripe(&__tValue);
+                    value_type _current;
+                    bool _equal;
+
+                    _stripe.lock();
+                    copy_from_value(_current);
+                    _equal = __builtin_memcmp(&_current, &expected, sizeof(value_type)) == 0;
+                    if(_equal) copy_to_value(desired);
+                    _stripe.unlock();
+
+                    if(!_equal) expected = _current;
+                    return _equal;
+                }
+            }
 
             bool compare_exchange_t (value_type expected, value_type desired,
                                     memory_order order = memory_order::SeqCst)
-                { return compare_exchange_n (&expected, desired, true,
-                                            static_cast<int>(order)); }
+                { return compare_exchange_n (expected, desired, true, order); }
 
-            bool compare_exchange_f (value_type& expected, value_type& desired,
+            bool compare_exchange_f (value_type& expected, value_type desired,
                                     memory_order order = memory_order::SeqCst)
-                { return compare_exchange_n (&expected, desired, false,
-                                            static_cast<int>(order)); }
+                { return compare_exchange_n (expected, desired, false, order); }
 
 
-            bool compare_exchange_strong(value_type& expected, value_type& desired,
+            bool compare_exchange_strong(value_type& expected, value_type desired,
                                         memory_order order = memory_order::SeqCst)
-                { return _atomic_compare_exchange (&__tValue, &expected, &desired, 0,
-                                                order, static_cast<int>(order)); }
+                { return compare_exchange_n (expected, desired, false, order); }
 
-            bool compare_exchange_weak(value_type& expected, value_type& desired,
+            bool compare_exchange_weak(value_type& expected, value_type desired,
                                     memory_order order = memory_order::SeqCst)
-                { return _atomic_compare_exchange (&__tValue, &expected, &desired, 1,
-                                                order, static_cast<int>(order)); }
-
-            value_type fetch_add (value_type v, memory_order order = memory_order::SeqCst )
-                { return __atomic_fetch_add (&__tValue, v, static_cast<int>(order)); }
-
-            value_type fetch_sub (value_type v, memory_order order = memory_order::SeqCst )
-                { return __atomic_fetch_sub (&__tValue, v, static_cast<int>(order)); }
-
-            value_type fetch_and (value_type v, memory_order order = memory_order::SeqCst )
-                { return __atomic_fetch_and (&__tValue, v, static_cast<int>(order)); }
-
-            value_type fetch_or (value_type v, memory_order order = memory_order::SeqCst )
-                { return __atomic_fetch_or (&__tValue, v, static_cast<int>(order)); }
-
-            value_type fetch_xor (value_type v, memory_order order = memory_order::SeqCst )
-                { return __atomic_fetch_xor (&__tValue, v, static_cast<int>(order)); }
+                { return compare_exchange_n (expected, desired, true, order); }
+
+            value_type fetch_add (value_type v, memory_order order = memory_order::SeqCst ) {
+                if constexpr (path == internal::atomic_path_native)
+                    return __atomic_fetch_add (&__tValue, v, static_cast<int>(order));
+                else
+                    return fetch_op([v](value_type x) { return value_type(x + v); }, order);
+            }
+
+            value_type fetch_sub (value_type v, memory_order order = memory_order::SeqCst ) {
+                if constexpr (path == internal::atomic_path_native)
+                    return __atomic_fetch_sub (&__tValue, v, static_cast<int>(order));
+                else
+                    return fetch_op([v](value_type x) { return value_type(x - v); }, order);
+            }
+
+            value_type fetch_and (value_type v, memory_order order = memory_order::SeqCst ) {
+                if constexpr (path == internal::atomic_path_native)
+                    return __atomic_fetch_and (&__tValue, v, static_cast<int>(order));
+                else
+                    return fetch_op([v](value_type x) { return value_type(x & v); }, order);
+            }
+
+            value_type fetch_or (value_type v, memory_order order = memory_order::SeqCst ) {
+                if constexpr (path == internal::atomic_path_native)
+                    return __atomic_fetch_or (&__tValue, v, static_cast<int>(order));
+                else
+                    return fetch_op([v](value_type x) { return value_type(x | v); }, order);
+            }
+
+            value_type fetch_xor (value_type v, memory_order order = memory_order::SeqCst ) {
+                if constexpr (path == internal::atomic_path_native)
+                    return __atomic_fetch_xor (&__tValue, v, static_cast<int>(order));
+                else
+                    return fetch_op([v](value_type x) { return value_type(x ^ v); }, order);
+            }
 
             value_type add_fetch (value_type v, memory_order order = memory_order::SeqCst )
-                { return __atomic_add_fetch (&__tValue, v, static_cast<int>(order)); }
+                { return value_type(fetch_add(v, order) + v); }
 
             value_type sub_fetch (value_type v, memory_order order = memory_order::SeqCst )
-                { return __atomic_sub_fetch (&__tValue, v, static_cast<int>(order)); }
+                { return value_type(fetch_sub(v, order) - v); }
 
             value_type and_fetch (value_type v, memory_order order = memory_order::SeqCst )
-                { return __atomic_and_fetch (&__tValue, v, static_cast<int>(order)); }
+                { return value_type(fetch_and(v, order) & v); }
 
             value_type or_fetch (value_type v, memory_order order = memory_order::SeqCst )
-                { return __atomic_or_fetch (&__tValue, v, static_cast<int>(order)); }
+                { return value_type(fetch_or(v, order) | v); }
 
             value_type xor_fetch (value_type v, memory_order order = memory_order::SeqCst )
-                { return __atomic_xor_fetch (&__tValue, v, static_cast<int>(order)); }
+                { return value_type(fetch_xor(v, order) ^ v); }
 
+            /**
+             * @brief Is the atomic lock free, false when the lock table is used.
+             */
             bool is_lock_free() const
-                { return __atomic_is_lock_free (sizeof(value_type), &__tValue); }
+                { return is_always_lock_free; }
 
             bool is_lock_free() const volatile
-                { return __atomic_is_lock_free (sizeof(value_type), &__tValue); }
+                { return is_always_lock_free; }
 
             inline operator value_type() const	         { return load(); }
             inline operator value_type() const volatile  { return load(); }
@@ -174,7 +340,73 @@ namespace squads {
             inline value_type operator  = (value_type v) { store(v); return v; }
             inline value_type operator  = (value_type v) volatile { store(v); return v; }
 
-            volatile value_type __tValue;
+            alignas(path == internal::atomic_path_locked ? alignof(T) : sizeof(T)) volatile value_type __tValue;
+        private:
+#if defined(__SIZEOF_INT128__)
+            using dw_type = unsigned __int128;
+#else
+            using dw_type = uint64_t;
+#endif
+
+            dw_type* dw_address() const {
+                return reinterpret_cast<dw_type*>(const_cast<value_type*>(&__tValue));
+            }
+            static dw_type to_dw(const value_type& v) {
+                dw_type _dw = 0;
+                __builtin_memcpy(&_dw, &v, sizeof(value_type));
+                return _dw;
+            }
+            static value_type from_dw(dw_type dw) {
+                value_type _v;
+                __builtin_memcpy(&_v, &dw, sizeof(value_type));
+                return _v;
+            }
+
+            /**
+             * @brief Copy the value, with the stripe locked or in a seqlock read.
+             */
+            void copy_from_value(value_type& dest) const {
+                const volatile unsigned char* _src = reinterpret_cast<const volatile unsigned char*>(&__tValue);
+                unsigned char* _dest = reinterpret_cast<unsigned char*>(&dest);
+
+                for(size_t i = 0; i < sizeof(value_type); i++) _dest[i] = _src[i];
+            }
+            void copy_to_value(const value_type& src) {
+                const unsigned char* _src = reinterpret_cast<const unsigned char*>(&src);
+                volatile unsigned char* _dest = reinterpret_cast<volatile unsigned char*>(&__tValue);
+
+                for(size_t i = 0; i < sizeof(value_type); i++) _dest[i] = _src[i];
+            }
+
+            /**
+             * @brief A read modify write without native builtin.
+             * @return The old value.
+             */
+            template <class TOP>
+            value_type fetch_op(TOP op, memory_order order) {
+                value_type _old;
+
+                if constexpr (path == internal::atomic_path_locked) {
+                    internal::atomic_stripe& _stripe = internal::get_atomic_stripe(&__tValue);
+
+                    _stripe.lock();
+                    copy_from_value(_old);
+                    copy_to_value(op(_old));
+                    _stripe.unlock();
+                } else {
+                    _old = load(memory_order::Relaxed);
+                    while(!compare_exchange_weak(_old, op(_old), order)) { }
+                }
+                return _old;
+            }
+
+            /**
+             * @brief The order for a failed compare exchange, it can not be a release order.
+             */
+            static constexpr int failure_order(memory_order order) {
+                return (order == memory_order::Release) ? __ATOMIC_RELAXED :
+                       (order == memory_order::AcqRel)  ? __ATOMIC_ACQUIRE : static_cast<int>(order);
+            }
         };
     }
 }
@@ -31,21 +31,24 @@
 #error Unsupported compiler / system.
 #endif
 
-#include "waitstate.hpp"
+#include "core/parking_lot.hpp"
 
 namespace squads {
     namespace atomic {
         namespace internal {
-            template<typename TATOMIC, class TSTATE>
+            /**
+             * @brief The notify of a atomic, wakes the tasks parked on the address of the atomic.
+             */
+            template<typename TATOMIC>
             class notify_token {
             public:
-                void notify_one(unsigned int timeout) noexcept { m_state->notify(timeout); }
-                void notify_all(unsigned int timeout) noexcept { m_state->notify(timeout); }
+                void notify_one(unsigned int timeout = 0) noexcept { parking_lot::unpark_one(m_pAddress); }
+                void notify_all(unsigned int timeout = 0) noexcept { parking_lot::unpark_all(m_pAddress); }
 
-                explicit notify_token(TSTATE& state) 
-                    : m_state(&state) {}
+                explicit notify_token(TATOMIC* address)
+                    : m_pAddress(address) {}
             private:
-                TSTATE* m_state;
+                TATOMIC* m_pAddress;
             };
         }
 
@@ -57,9 +60,8 @@ namespace squads {
             using difference_type = typename base_type::difference_type;
             using self_type = basic_atomic_impl<value_type, TTASKTYPE>;
             
-            using waitstate_type = basic_wait_state<basic_atomic_impl<uint64_t, TTASKTYPE>, TTASKTYPE >;
-            using notify_type = internal::notify_token<self_type, waitstate_type>;
-            using vnotify_type = internal::notify_token<volatile self_type, waitstate_type>;
+            using notify_type = internal::notify_token<self_type>;
+            using vnotify_type = internal::notify_token<volatile self_type>;
 
             basic_atomic_impl()  = default;
             ~basic_atomic_impl()  = default;
@@ -71,40 +73,59 @@ namespace squads {
             constexpr basic_atomic_impl(value_type value)  : base_type(value) { }
 
 
-            void notify_one(unsigned int timeout) 
-                { get_notify_token().notify_one(timeout); }
+            /**
+             * @brief Wake up one task, that waits on this atomic.
+             * @param timeout Not used, the notify never blocks.
+             */
+            void notify_one(unsigned int timeout = 0)
+                { get_notify_token().notify_one(); }
 
-            void notify_one(unsigned int timeout) volatile  
-                { get_notify_token().notify_one(timeout); }
-    
-            void notify_all(unsigned int timeout)  
-                { get_notify_token().notify_all(timeout); }
-                
-            void notify_all(unsigned int timeout) volatile 
-                { get_notify_token().notify_all(timeout); }
+            void notify_one(unsigned int timeout = 0) volatile
+                { get_notify_token().notify_one(); }
+
+            /**
+             * @brief Wake up all tasks, that wait on this atomic.
+             * @param timeout Not used, the notify never blocks.
+             */
+            void notify_all(unsigned int timeout = 0)
+                { get_notify_token().notify_all(); }
+
+            void notify_all(unsigned int timeout = 0) volatile
+                { get_notify_token().notify_all(); }
 
             notify_type get_notify_token()  {
-                waitstate_type& temp = waitstate_type::for_address(this);
-                return notify_type{temp};
+                return notify_type{this};
             }
 
             vnotify_type get_notify_token() volatile {
-                waitstate_type& temp = waitstate_type::for_address(this);
-                return notify_type{temp};
+                return vnotify_type{this};
             }
 
-            void wait(T old, memory_order mo = memory_order::SeqCst, unsigned int timeout = SQUADS_PORTMAX_DELAY) const {
-                
-                auto pred = [mo, old, this]() { return this->load(mo) != old; };
-                auto& s = waitstate_type::for_address(this);
-                s.wait(pred, timeout);
+            /**
+             * @brief Wait until the value is not old, parks in the parking lot.
+             * @param old The old value.
+             * @param mo The memory order of the loads.
+             * @param timeout How long to wait in ticks.
+             * @return true if the value changed and false on timeout.
+             */
+            bool wait(T old, memory_order mo = memory_order::SeqCst, unsigned int timeout = SQUADS_PORTMAX_DELAY) const {
+                basic_deadline _dl = basic_deadline::from_ticks(timeout);
+
+                while(this->load(mo) == old) {
+                    if(parking_lot::park(this, [mo, old, this]() { return this->load(mo) == old; },
+                        _dl.remaining_ticks()) == parking_lot::park_timeout) return this->load(mo) != old;
+                }
+                return true;
             }
 
-            void wait(T old, memory_order mo = memory_order::SeqCst, unsigned int timeout = SQUADS_PORTMAX_DELAY) const volatile {
-                
-                auto pred = [mo, old, this]() { return this->load(mo) != old; };
-                auto& s = waitstate_type::for_address(this);
-                s.wait(pred, timeout);
+            bool wait(T old, memory_order mo = memory_order::SeqCst, unsigned int timeout = SQUADS_PORTMAX_DELAY) const volatile {
+                basic_deadline _dl = basic_deadline::from_ticks(timeout);
+
+                while(this->load(mo) == old) {
+                    if(parking_lot::park(this, [mo, old, this]() { return this->load(mo) == old; },
+                        _dl.remaining_ticks()) == parking_lot::park_timeout) return this->load(mo) != old;
+                }
+                return true;
             }
 
         };
@@ -0,0 +1,231 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_ATOMIC_TAGGED_PTR_H__
+#define __SQUADS_ATOMIC_TAGGED_PTR_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    namespace atomic {
+        /**
+         * @brief A pointer with a version counter, against the ABA problem.
+         */
+        template <typename T>
+        struct tagged_ptr {
+            using value_type = T;
+            using pointer = T*;
+            using tag_type = uintptr_t;
+
+            pointer ptr;
+            tag_type tag;
+
+            bool operator == (const tagged_ptr& other) const { return ptr == other.ptr && tag == other.tag; }
+            bool operator != (const tagged_ptr& other) const { return !(*this == other); }
+        };
+
+        /**
+         * @brief A atomic pointer with a version counter, that is incremented on each change.
+         *
+         * A compare exchange fails, when the pointer was changed and changed back
+         * between the load and the compare exchange (the ABA problem), because the
+         * version is changed.
+         *
+         * With SQUADS_CONFIG_TAGGED_PTR_ADDRESS_BITS (ESP32 and 64 bit hosts) the
+         * pointer is packed as index of a pointer sized unit in the address range,
+         * with the version in the free high bits of one word: a single word compare
+         * and swap. Else the pointer and the version are a double word: on targets
+         * with a double word compare and swap it is lock free, else basic_atomic_gcc
+         * uses the atomic lock table (is_lock_free reports it).
+         *
+         * @note The packed version has only the free bits (10 on the ESP32), a
+         * compare exchange detects the ABA problem, when less then 2^bits changes
+         * happen between the load and the compare exchange.
+         *
+         * @code
+         * basic_atomic_tagged_ptr<node> head;
+         *
+         * tagged_ptr<node> top = head.load();
+         * do {
+         *     if(top.ptr == nullptr) return nullptr;
+         * } while(!head.compare_exchange_weak(top, top.ptr->next));
+         * @endcode
+         */
+#if defined(SQUADS_CONFIG_TAGGED_PTR_ADDRESS_BITS)
+        template <typename T>
+        class basic_atomic_tagged_ptr {
+        public:
+            using self_type = basic_atomic_tagged_ptr<T>;
+            using value_type = tagged_ptr<T>;
+            using pointer = T*;
+            using tag_type = typename value_type::tag_type;
+
+            explicit basic_atomic_tagged_ptr(pointer ptr = nullptr) : m_uiWord(pack(ptr, 0)) { }
+
+            basic_atomic_tagged_ptr(const self_type&) = delete;
+            self_type& operator = (const self_type&) = delete;
+
+            /**
+             * @brief Load the pointer and the version.
+             */
+            value_type load(memory_order order = memory_order::SeqCst) const {
+                return unpack(m_uiWord.load(order));
+            }
+
+            /**
+             * @brief Store a new pointer and increment the version.
+             */
+            void store(pointer ptr, memory_order order = memory_order::SeqCst) {
+                exchange(ptr, order);
+            }
+
+            /**
+             * @brief Exchange the pointer and increment the version.
+             * @return The old pointer and version.
+             */
+            value_type exchange(pointer ptr, memory_order order = memory_order::SeqCst) {
+                uintptr_t _old = m_uiWord.load(memory_order::Relaxed);
+
+                while(!m_uiWord.compare_exchange_weak(_old, pack(ptr, unpack(_old).tag + 1), order)) { }
+                return unpack(_old);
+            }
+
+            /**
+             * @brief Set the pointer, when the pointer and the version are the expected,
+             * the version is incremented.
+             * @param expected The expected value, updated with the current value on failure.
+             * @param desired The new pointer.
+             * @return true if the pointer was set.
+             */
+            bool compare_exchange_weak(value_type& expected, pointer desired,
+                                       memory_order order = memory_order::SeqCst) {
+                uintptr_t _expected = pack(expected.ptr, expected.tag);
+                if(m_uiWord.compare_exchange_weak(_expected, pack(desired, expected.tag + 1), order))
+                    return true;
+
+                expected = unpack(_expected);
+                return false;
+            }
+
+            bool compare_exchange_strong(value_type& expected, pointer desired,
+                                         memory_order order = memory_order::SeqCst) {
+                uintptr_t _expected = pack(expected.ptr, expected.tag);
+                if(m_uiWord.compare_exchange_strong(_expected, pack(desired, expected.tag + 1), order))
+                    return true;
+
+                expected = unpack(_expected);
+                return false;
+            }
+
+            bool is_lock_free() const { return m_uiWord.is_lock_free(); }
+        private:
+            /** The nodes hold a pointer, so they are pointer aligned */
+            static constexpr unsigned shift = (sizeof(void*) == 8) ? 3 : 2;
+            /** The index of the unit plus one, 0 is nullptr */
+            static constexpr unsigned index_bits = SQUADS_CONFIG_TAGGED_PTR_ADDRESS_BITS - shift + 1;
+            static constexpr uintptr_t index_mask = (uintptr_t(1) << index_bits) - 1;
+
+            static_assert(sizeof(uintptr_t) * 8 >= index_bits + 8,
+                          "squads::atomic::basic_atomic_tagged_ptr: less then 8 bits for the tag");
+
+            static uintptr_t pack(pointer ptr, tag_type tag) {
+                uintptr_t _index = 0;
+
+                if(ptr != nullptr)
+                    _index = ((reinterpret_cast<uintptr_t>(ptr) - uintptr_t(SQUADS_CONFIG_TAGGED_PTR_BASE)) >> shift) + 1;
+
+                return _index | (uintptr_t(tag) << index_bits);
+            }
+
+            static value_type unpack(uintptr_t word) {
+                uintptr_t _index = word & index_mask;
+                pointer _ptr = nullptr;
+
+                if(_index != 0)
+                    _ptr = reinterpret_cast<pointer>(((_index - 1) << shift) + uintptr_t(SQUADS_CONFIG_TAGGED_PTR_BASE));
+
+                return value_type{ _ptr, tag_type(word >> index_bits) };
+            }
+        private:
+            basic_atomic_gcc<uintptr_t> m_uiWord;
+        };
+#else
+        template <typename T>
+        class basic_atomic_tagged_ptr {
+        public:
+            using self_type = basic_atomic_tagged_ptr<T>;
+            using value_type = tagged_ptr<T>;
+            using pointer = T*;
+
+            explicit basic_atomic_tagged_ptr(pointer ptr = nullptr) : m_value(value_type{ ptr, 0 }) { }
+
+            basic_atomic_tagged_ptr(const self_type&) = delete;
+            self_type& operator = (const self_type&) = delete;
+
+            /**
+             * @brief Load the pointer and the version.
+             */
+            value_type load(memory_order order = memory_order::SeqCst) const {
+                return m_value.load(order);
+            }
+
+            /**
+             * @brief Store a new pointer and increment the version.
+             */
+            void store(pointer ptr, memory_order order = memory_order::SeqCst) {
+                exchange(ptr, order);
+            }
+
+            /**
+             * @brief Exchange the pointer and increment the version.
+             * @return The old pointer and version.
+             */
+            value_type exchange(pointer ptr, memory_order order = memory_order::SeqCst) {
+                value_type _old = m_value.load(memory_order::Relaxed);
+
+                while(!m_value.compare_exchange_weak(_old, value_type{ ptr, _old.tag + 1 }, order)) { }
+                return _old;
+            }
+
+            /**
+             * @brief Set the pointer, when the pointer and the version are the expected,
+             * the version is incremented.
+             * @param expected The expected value, updated with the current value on failure.
+             * @param desired The new pointer.
+             * @return true if the pointer was set.
+             */
+            bool compare_exchange_weak(value_type& expected, pointer desired,
+                                       memory_order order = memory_order::SeqCst) {
+                return m_value.compare_exchange_weak(expected, value_type{ desired, expected.tag + 1 }, order);
+            }
+
+            bool compare_exchange_strong(value_type& expected, pointer desired,
+                                         memory_order order = memory_order::SeqCst) {
+                return m_value.compare_exchange_strong(expected, value_type{ desired, expected.tag + 1 }, order);
+            }
+
+            bool is_lock_free() const { return m_value.is_lock_free(); }
+        private:
+            basic_atomic_gcc<value_type> m_value;
+        };
+#endif
+    }
+}
+
+#endif
@@ -71,6 +71,11 @@
 #define SQUADS_CONFIG_DEFAULT_CORE   SQUADS_ARCH_CONFIG_BASE_CORE
 #define SQUADS_CONFIG_STACK_DEPTH    SQUADS_ARCH_CONFIG_STACK_DEPTH
 
+/// @brief The number of cores, that can run squads tasks
+#define SQUADS_CONFIG_NUM_CORES      SQUADS_ARCH_CONFIG_NUM_CORES
+/// @brief The size of a cache line, use for padding shared data
+#define SQUADS_CONFIG_CACHE_LINE_SIZE SQUADS_ARCH_CONFIG_CACHE_LINE_SIZE
+
 /**
  * @brief Pre defined on which core must run the work queue task,
  * can override in the create function
@@ -161,6 +166,25 @@
     #define SQUADS_THREAD_NATIVE_HANDLE      SQUADS_THREAD_CONFIG_NATIVE_HANDLE
 
 #endif
+
+#ifndef SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS
+    /**
+     * @brief The maximal number of task_local objects in the application
+     * @note default: 16, one slot is used by the cancellation_scope
+     */
+    #define SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS     16
+#endif
+
+#ifndef SQUADS_CONFIG_TASK_LOCAL_TLS_INDEX
+    /**
+     * @brief The native thread local storage index, reserved for the task_local block.
+     * Don't use this index with task::set_storage_pointer. It must be above the
+     * indices of the platform (SQUADS_ARCH_TLS_RESERVED, on ESP-IDF index 0 of the
+     * pthreads), so configNUM_THREAD_LOCAL_STORAGE_POINTERS must be 2 or more there.
+     * @note default: the last native index
+     */
+    #define SQUADS_CONFIG_TASK_LOCAL_TLS_INDEX     (SQUADS_ARCH_TLS_POINTERS - 1)
+#endif
 //==================================
 // end task config
 
@@ -230,9 +254,48 @@
      */
     #define SQUADS_CONFIG_WORKQUEUE_MULTI_PRIORITY     1
 #endif
+
+#ifndef SQUADS_CONFIG_JOBSCHEDULER_MAXJOBS
+    /**
+     * How many jobs can be pending in the deadline (EDF) job scheduler
+     * @note default: 32
+     */
+    #define SQUADS_CONFIG_JOBSCHEDULER_MAXJOBS          32
+#endif
+
+#ifndef SQUADS_CONFIG_JOBSCHEDULER_ARITY
+    /**
+     * The arity (children per node) of the indexed heap in the job scheduler
+     * @note default: 4
+     */
+    #define SQUADS_CONFIG_JOBSCHEDULER_ARITY            4
+#endif
+
+#ifndef SQUADS_CONFIG_JOBSCHEDULER_AGING_LIMIT
+    /**
+     * Aging limit in microseconds: a job is never served later than
+     * submit time + this limit, even when its deadline is later.
+     * Prevents starvation of jobs with far deadlines.
+     * @note default: 1000000 (1 second)
+     */
+    #define SQUADS_CONFIG_JOBSCHEDULER_AGING_LIMIT      1000000LL
+#endif
 //==================================
 // end workqueue config
 
+// start mailbox config
+//==================================
+#ifndef SQUADS_CONFIG_MAILBOX_CAPACITY
+    /**
+     * @brief The number of messages of one cross core mailbox channel,
+     * must be a power of two
+     * @note default: 16
+     */
+    #define SQUADS_CONFIG_MAILBOX_CAPACITY              16
+#endif
+//==================================
+// end mailbox config
+
 
 
 #ifndef SQUADS_CONFIG_CSEMAPHORE_MIN_COUNT
@@ -259,6 +322,32 @@
      */
     #define SQUADS_CONFIG_RECURSIVE_MUTEX_CHEAKING     SQUADS_CONFIG_YES
 #endif
+
+#ifndef SQUADS_CONFIG_FAST_MUTEX_SPIN_MAX
+    /**
+     * @brief The maximal spin rounds of the fast_mutex, before the task parks.
+     * The fast_mutex adapt the spin rounds between 1 and this value.
+     * @note default: 100 and 0 on single core systems (no spinning)
+     */
+    #if SQUADS_CONFIG_NUM_CORES > 1
+    #define SQUADS_CONFIG_FAST_MUTEX_SPIN_MAX          100
+    #else
+    #define SQUADS_CONFIG_FAST_MUTEX_SPIN_MAX          0
+    #endif
+#endif
+
+#ifndef SQUADS_CONFIG_SEQLOCK_SPIN_MAX
+    /**
+     * @brief The spin rounds of a seqlock reader or writer, before it sleeps one
+     * tick, so a preempted writer of lower priority can finish the write.
+     * @note default: 100 and 0 on single core systems (sleep at once)
+     */
+    #if SQUADS_CONFIG_NUM_CORES > 1
+    #define SQUADS_CONFIG_SEQLOCK_SPIN_MAX             100
+    #else
+    #define SQUADS_CONFIG_SEQLOCK_SPIN_MAX             0
+    #endif
+#endif
 // end mutex config
 
 
@@ -334,6 +423,134 @@
 
 
 
+#ifndef SQUADS_CONFIG_EBR_MAX_TASKS
+    /**
+     * @brief The maximal count of tasks, that can use one ebr_domain at the same time.
+     */
+    #define SQUADS_CONFIG_EBR_MAX_TASKS                16
+#endif
+
+#ifndef SQUADS_CONFIG_EBR_RETIRE_THRESHOLD
+    /**
+     * @brief The count of retired objects of a task, after that the
+     * ebr_domain trys to advance the epoch and free the retired objects.
+     */
+    #define SQUADS_CONFIG_EBR_RETIRE_THRESHOLD         32
+#endif
+
+#ifndef SQUADS_CONFIG_HAZARD_MAX_TASKS
+    /**
+     * @brief The maximal count of tasks, that can use one hazard_domain at the same time.
+     */
+    #define SQUADS_CONFIG_HAZARD_MAX_TASKS             16
+#endif
+
+#if !defined(SQUADS_CONFIG_TAGGED_PTR_ADDRESS_BITS) && defined(SQUADS_ARCH_TAGGED_PTR_ADDRESS_BITS)
+    /**
+     * @brief The address range of the nodes of atomic::basic_atomic_tagged_ptr, the
+     * pointer is packed with the tag in one word. Undefined: a double word.
+     * @note default: from the arch, on the ESP32 a 10 bit tag and on 64 bit hosts a 18 bit tag
+     */
+    #define SQUADS_CONFIG_TAGGED_PTR_BASE              SQUADS_ARCH_TAGGED_PTR_BASE
+    #define SQUADS_CONFIG_TAGGED_PTR_ADDRESS_BITS      SQUADS_ARCH_TAGGED_PTR_ADDRESS_BITS
+#endif
+
+#ifndef SQUADS_CONFIG_HAZARD_SLOTS
+    /**
+     * @brief The count of hazard pointers of each task.
+     * @note 2 for a lock free queue or stack
+     */
+    #define SQUADS_CONFIG_HAZARD_SLOTS                 2
+#endif
+
+#ifndef SQUADS_CONFIG_HAZARD_SCAN_THRESHOLD
+    /**
+     * @brief The count of retired objects of a task, after that the hazard_domain
+     * scans the hazard pointers and frees the unprotected objects.
+     * @note default: two times of all hazard pointers, so each scan frees the half
+     */
+    #define SQUADS_CONFIG_HAZARD_SCAN_THRESHOLD        (SQUADS_CONFIG_HAZARD_MAX_TASKS * SQUADS_CONFIG_HAZARD_SLOTS * 2)
+#endif
+
+#ifndef SQUADS_CONFIG_BARRIER_ARITY
+    /**
+     * @brief The fan-in of the combining tree of the barrier: how many arrivals
+     * share one counter (one cache line).
+     * @note default: 4
+     */
+    #define SQUADS_CONFIG_BARRIER_ARITY                4
+#endif
+
+#ifndef SQUADS_CONFIG_PARKING_LOT_BUCKETS
+    /**
+     * @brief The default count of buckets of the parking lot, a power of two.
+     * Can changed at init with parking_lot::init.
+     * @note default: 64
+     */
+    #define SQUADS_CONFIG_PARKING_LOT_BUCKETS          64
+#endif
+
+#ifndef SQUADS_CONFIG_LOCK_PROFILER
+    /**
+     * @brief When SQUADS_CONFIG_YES then debug_lock profiles the contention of the
+     * wrapped lock, when SQUADS_CONFIG_NO then debug_lock only forwards to the lock.
+     * @note default: SQUADS_CONFIG_NO
+     */
+    #define SQUADS_CONFIG_LOCK_PROFILER                SQUADS_CONFIG_NO
+#endif
+
+#ifndef SQUADS_CONFIG_LOCK_PROFILER_TOP_TASKS
+    /**
+     * @brief How many of the most waiting tasks the lock profiler holds per lock.
+     * @note default: 4
+     */
+    #define SQUADS_CONFIG_LOCK_PROFILER_TOP_TASKS      4
+#endif
+
+#ifndef SQUADS_CONFIG_ATOMIC_LOCK_STRIPES
+    /**
+     * @brief The count of stripes of the lock table of the atomics, that are not
+     * lock free (like 64 bit or struct types on 32 bit targets), a power of two.
+     * @note default: 16
+     */
+    #define SQUADS_CONFIG_ATOMIC_LOCK_STRIPES          16
+#endif
+
+#ifndef SQUADS_CONFIG_REF_COUNTED_QUEUES
+    /**
+     * @brief The count of the merge queues of the biased ref_counted objects, the
+     * owner tasks are hashed in the queues. A power of two.
+     * @note default: 16
+     */
+    #define SQUADS_CONFIG_REF_COUNTED_QUEUES           16
+#endif
+
+#ifndef SQUADS_CONFIG_SLAB_MAX_SIZE
+    /**
+     * @brief The size of the biggest size class of the slab allocator, bigger
+     * requests go to the backing allocator.
+     * @note default: 1024
+     */
+    #define SQUADS_CONFIG_SLAB_MAX_SIZE                1024
+#endif
+
+#ifndef SQUADS_CONFIG_SLAB_MAGAZINE_SIZE
+    /**
+     * @brief The max count of free objects in a magazine of a task, per size class.
+     * The depot is refilled and drained in batches of the half.
+     * @note default: 16
+     */
+    #define SQUADS_CONFIG_SLAB_MAGAZINE_SIZE           16
+#endif
+
+#ifndef SQUADS_CONFIG_SLAB_PAGE_SIZE
+    /**
+     * @brief The size of a slab page, taken from the backing allocator.
+     * @note default: 4096
+     */
+    #define SQUADS_CONFIG_SLAB_PAGE_SIZE               4096
+#endif
+
 #if defined(__has_builtin)
 	#define SQUADS_CONFIG_HAS_BUILTIN 	SQUADS_CONFIG_YES
 #else
@@ -0,0 +1,198 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_ATOMIC_SHARED_PTR_H__
+#define __SQUADS_ATOMIC_SHARED_PTR_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "shared_ptr.hpp"
+#include "memory/hazard_pointer.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    /**
+     * @brief A shared pointer with atomic load, store, exchange and compare exchange.
+     *
+     * The shared pointer is held in a box, the atomic is a pointer to the box. A store
+     * publishes a new box and retires the old box in a hazard domain. A load protects
+     * the box with a hazard pointer and copies the shared pointer, so readers never
+     * block and never are blocked by writers: ideal for snapshots, that are read often
+     * and seldom changed.
+     *
+     * @code
+     * atomic_shared_ptr<config> g_config;
+     *
+     * // writer
+     * g_config.store(make_shared<config>(new_values));
+     *
+     * // reader
+     * shared_ptr<config> cfg = g_config.load();
+     * @endcode
+     *
+     * @note Each store allocates a box. The load uses the last hazard slot of the task
+     * (SQUADS_CONFIG_HAZARD_SLOTS - 1). Up to SQUADS_CONFIG_HAZARD_MAX_TASKS tasks have a
+     * own hazard record, more tasks take a overflow record of the domain for each
+     * load and compare exchange, a new one is allocated when all are in use.
+     *
+     * @tparam T The type of the object.
+     * @tparam TPOLICY The count policy of the shared pointer.
+     * @tparam TDOMAIN The type of the hazard domain.
+     */
+    template <typename T, class TPOLICY = shared_count_atomic, class TDOMAIN = memory::hazard_domain<> >
+    class basic_atomic_shared_ptr {
+    public:
+        using self_type = basic_atomic_shared_ptr<T, TPOLICY, TDOMAIN>;
+        using shared_type = basic_shared_ptr<T, TPOLICY>;
+        using domain_type = TDOMAIN;
+
+        static constexpr bool is_always_lock_free = false;
+
+        explicit basic_atomic_shared_ptr(domain_type& domain = memory::get_default_hazard_domain())
+            : m_refDomain(domain), m_pBox(nullptr) { }
+
+        explicit basic_atomic_shared_ptr(const shared_type& value,
+                                         domain_type& domain = memory::get_default_hazard_domain())
+            : m_refDomain(domain), m_pBox(nullptr) {
+            m_pBox.store(make_box(value), atomic::memory_order::Release);
+        }
+
+        /**
+         * @note No task may use the pointer.
+         */
+        ~basic_atomic_shared_ptr() {
+            box* _box = m_pBox.load(atomic::memory_order::Acquire);
+            if(_box != nullptr) m_refDomain.get_allocator().destroy(_box);
+        }
+
+        basic_atomic_shared_ptr(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Get a copy of the current shared pointer.
+         */
+        shared_type load() const {
+            typename domain_type::guard _hp(m_refDomain, hazard_slot);
+
+            // protect never fails, the guard falls back to the overflow record
+            box* _box = _hp.protect(m_pBox);
+            if(_box == nullptr) return shared_type();
+
+            // the box is protected, so the value holds a reference
+            return _box->value;
+        }
+
+        /**
+         * @brief Publish a new shared pointer.
+         */
+        void store(const shared_type& value) {
+            retire(m_pBox.exchange(make_box(value), atomic::memory_order::AcqRel));
+        }
+
+        /**
+         * @brief Publish a new shared pointer.
+         * @return The old shared pointer.
+         */
+        shared_type exchange(const shared_type& value) {
+            box* _old = m_pBox.exchange(make_box(value), atomic::memory_order::AcqRel);
+            if(_old == nullptr) return shared_type();
+
+            // the box is no more published, so it is owned here
+            shared_type _value = _old->value;
+            retire(_old);
+
+            return _value;
+        }
+
+        /**
+         * @brief Publish the desired shared pointer, when the current is the expected.
+         * @param expected The expected pointer, the current on failure.
+         * @param desired The new pointer.
+         * @return true if the desired was published.
+         */
+        bool compare_exchange_strong(shared_type& expected, const shared_type& desired) {
+            typename domain_type::guard _hp(m_refDomain, hazard_slot);
+            box* _new = make_box(desired);
+
+            for(;;) {
+                box* _box = _hp.protect(m_pBox);
+
+                if(!is_equal(_box, expected)) {
+                    expected = (_box != nullptr) ? _box->value : shared_type();
+                    if(_new != nullptr) m_refDomain.get_allocator().destroy(_new);
+                    return false;
+                }
+                if(m_pBox.compare_exchange_strong(_box, _new, atomic::memory_order::AcqRel)) {
+                    _hp.clear();
+                    retire(_box);
+                    return true;
+                }
+            }
+        }
+
+        /**
+         * @brief Like compare_exchange_strong, this never fails spurious.
+         */
+        bool compare_exchange_weak(shared_type& expected, const shared_type& desired) {
+            return compare_exchange_strong(expected, desired);
+        }
+
+        operator shared_type () const                   { return load(); }
+        self_type& operator = (const shared_type& value) { store(value); return *this; }
+
+        /**
+         * @brief Never lock free: each store allocates a box, and a task without a own
+         * hazard record can allocate a overflow record, both can take the lock of the
+         * allocator.
+         */
+        bool is_lock_free() const { return is_always_lock_free; }
+    private:
+        struct box {
+            shared_type value;
+
+            explicit box(const shared_type& v) : value(v) { }
+        };
+
+        enum { hazard_slot = SQUADS_CONFIG_HAZARD_SLOTS - 1 };
+
+        box* make_box(const shared_type& value) {
+            if(value.get() == nullptr && value.use_count() == 0) return nullptr;
+
+            return m_refDomain.template construct<box>(value);
+        }
+
+        void retire(box* old) {
+            if(old != nullptr) m_refDomain.retire(old);
+        }
+
+        static bool is_equal(const box* current, const shared_type& expected) {
+            if(current == nullptr)
+                return expected.get() == nullptr && expected.use_count() == 0;
+
+            return current->value.get() == expected.get() &&
+                   !current->value.owner_before(expected) && !expected.owner_before(current->value);
+        }
+    private:
+        domain_type& m_refDomain;
+        atomic::basic_atomic_gcc<box*> m_pBox;
+    };
+
+    template <typename T, class TPOLICY = shared_count_atomic>
+    using atomic_shared_ptr = basic_atomic_shared_ptr<T, TPOLICY>;
+}
+
+#endif
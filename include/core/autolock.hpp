@@ -40,6 +40,7 @@
  */
 #define LOCKED_SECTION(LOCK, OBJECT) if( (squads::basic_autolock<LOCK> lock(OBJECT)) )
 #define UNLOCKED_SECTION(LOCK, OBJECT) if( (squads::basic_autounlock<LOCK> ulock(OBJECT)) )
+#define LOCKED_SHARED_SECTION(LOCK, OBJECT) if( squads::basic_shared_autolock<LOCK> slock(OBJECT); slock )
 
 namespace squads {
 
@@ -64,7 +65,7 @@ namespace squads {
          */
         basic_autolock(LOCK &m)
         : m_ref_lock(m) {
-        assert( (m_ref_lock.lock(portMAX_DELAY) != 0) );
+            m_ref_lock.lock(SQUADS_PORTMAX_DELAY);
         }
         /**
          * Create a basic_autolock with a specific LockType, with timeout
@@ -75,7 +76,7 @@ namespace squads {
          */
         basic_autolock(LOCK &m, unsigned long xTicksToWait)
         : m_ref_lock(m) {
-        assert( (m_ref_lock.lock(xTicksToWait) != 0) );
+            m_ref_lock.lock(xTicksToWait);
         }
         /**
          *  Destroy a basic_autolock.
@@ -133,7 +134,7 @@ namespace squads {
          *  @post The basic_lock  will be locked.
          */
         ~basic_autounlock() {
-            assert( (m_ref_lock.lock(m_xTicksToWait) != 0) );
+            m_ref_lock.lock(m_xTicksToWait);
         }
 
         void set_timeout(unsigned long xTicksToWait = SQUADS_PORTMAX_DELAY) {
@@ -158,6 +159,63 @@ namespace squads {
 
     template <class LOCK>
     using autounlock = basic_autounlock<LOCK>;
+
+    /**
+     *  The shared version of basic_autolock, for reader-writer locks.
+     *  The constructor locks the lock shared (lock_shared),
+     *  the destructor unlocks the shared lock (unlock_shared).
+     *
+     * \ingroup lock
+     */
+    template <class LOCK>
+    class  basic_shared_autolock   {
+    public:
+        /**
+         *  Create a basic_shared_autolock, without timeout
+         *
+         *  @post The lock will be locked shared.
+         */
+        basic_shared_autolock(LOCK &m)
+        : m_ref_lock(m) {
+            m_bLocked = (m_ref_lock.lock_shared(SQUADS_PORTMAX_DELAY) == 0);
+        }
+        /**
+         * Create a basic_shared_autolock, with timeout
+         *
+         * @param xTicksToWait How long to wait to get the lock until giving up.
+         */
+        basic_shared_autolock(LOCK &m, unsigned long xTicksToWait)
+        : m_ref_lock(m) {
+            m_bLocked = (m_ref_lock.lock_shared(xTicksToWait) == 0);
+        }
+        /**
+         *  Destroy a basic_shared_autolock.
+         *
+         *  @post The shared lock will be unlocked, when it was locked.
+         */
+        ~basic_shared_autolock() {
+            if(m_bLocked) m_ref_lock.unlock_shared();
+        }
+
+        basic_shared_autolock(const basic_shared_autolock&) = delete;
+        basic_shared_autolock& operator = (const basic_shared_autolock&) = delete;
+
+        operator bool () {
+            return m_bLocked;
+        }
+    private:
+        /**
+         *  Reference to the lock we locked shared.
+         */
+        LOCK &m_ref_lock;
+        /**
+         *  Was the shared lock acquired?
+         */
+        bool m_bLocked;
+    };
+
+    template <class LOCK>
+    using shared_autolock = basic_shared_autolock<LOCK>;
 }
 
 #endif
\ No newline at end of file
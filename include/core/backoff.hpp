@@ -0,0 +1,66 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_BACKOFF_H__
+#define __SQUADS_BACKOFF_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "arch/arch_utils.hpp"
+
+namespace squads {
+    /**
+     * @brief Backoff policy for spin loops: one cpu pause per round.
+     * @note A backoff object is created for each acquisition.
+     */
+    struct pause_backoff {
+        void pause() { arch::arch_cpu_relax(); }
+    };
+
+    /**
+     * @brief Backoff policy for spin loops: yield the cpu each round.
+     * Use when the lock owner can run on the same core.
+     */
+    struct yield_backoff {
+        void pause() { arch::arch_yield(); }
+    };
+
+    /**
+     * @brief Backoff policy for spin loops: exponential growing pauses.
+     * @tparam TMIN The pause rounds of the first round.
+     * @tparam TMAX The maximal pause rounds.
+     */
+    template <unsigned int TMIN = 1, unsigned int TMAX = 64>
+    class exponential_backoff {
+        static_assert(TMIN > 0 && TMIN <= TMAX, "invalid backoff limits");
+    public:
+        exponential_backoff() : m_uiRounds(TMIN) { }
+
+        void pause() {
+            for(unsigned int i = 0; i < m_uiRounds; i++)
+                arch::arch_cpu_relax();
+
+            m_uiRounds = (m_uiRounds >= TMAX / 2) ? TMAX : m_uiRounds * 2;
+        }
+
+        void reset() { m_uiRounds = TMIN; }
+    private:
+        unsigned int m_uiRounds;
+    };
+}
+
+#endif
@@ -0,0 +1,283 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_BARRIER_H__
+#define __SQUADS_BARRIER_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "wait_queue.hpp"
+#include "arch/arch_utils.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    /**
+     * @brief The default completion function of the barrier, does nothing.
+     */
+    struct barrier_empty_completion {
+        void operator()() noexcept { }
+    };
+
+    /**
+     * @brief A reusable phase barrier for a fixed group of tasks.
+     *
+     * Each phase completes, when all participants have arrived. The last arriver
+     * runs the completion function, exactly once per phase, then all waiters of the
+     * phase are woken up and the next phase begins.
+     *
+     * The arrivals are counted in a combining tree: SQUADS_CONFIG_BARRIER_ARITY arrivals
+     * share one counter on a own cache line, and the last arriver of a counter arrives
+     * at the parent counter. So no counter takes all arrivals.
+     *
+     * @code
+     * barrier<> frame_barrier(4);
+     *
+     * // in each of the 4 worker tasks
+     * for(;;) {
+     *     do_stage();
+     *     frame_barrier.arrive_and_wait();
+     * }
+     * @endcode
+     *
+     * @note Each participant arrives once per phase.
+     *
+     * @tparam TCOMPLETION The type of the completion function, void() noexcept.
+     *
+     * @ingroup lock
+     */
+    template <class TCOMPLETION = barrier_empty_completion>
+    class basic_barrier {
+    public:
+        using self_type = basic_barrier<TCOMPLETION>;
+        using completion_type = TCOMPLETION;
+        using arrival_token = uint32_t;
+
+        static constexpr ptrdiff_t max() { return 0x7FFFFFFF; }
+
+        /**
+         * @brief Create the barrier.
+         * @param expected The count of participants.
+         * @param completion The completion function, run by the last arriver of each phase.
+         */
+        explicit basic_barrier(ptrdiff_t expected, completion_type completion = completion_type())
+            : m_pNodes(nullptr), m_iNodes(0), m_iLevels(0), m_iExpected(expected),
+              m_uiDrops(0), m_uiPhase(0), m_fnCompletion(completion), m_queue() {
+            build(expected);
+            configure(expected);
+        }
+
+        ~basic_barrier() {
+            delete[] m_pNodes;
+        }
+
+        basic_barrier(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Arrive at the barrier, without waiting.
+         * @return The token of the current phase, for wait.
+         */
+        arrival_token arrive() {
+            arrival_token _phase = m_uiPhase.load(atomic::memory_order::Acquire);
+
+            int _leaves = m_aLevelSize[0];
+            int _start = int((reinterpret_cast<uintptr_t>(arch::arch_get_current_task()) >> 4) % _leaves);
+
+            // find a leaf with a free place, start on the leaf of the task
+            for(int i = 0; i < _leaves; i++) {
+                int _index = (_start + i) % _leaves;
+                node& _node = m_pNodes[_index];
+
+                uint32_t _arrived = _node.arrived.load(atomic::memory_order::Relaxed);
+                while(_arrived < _node.expected) {
+                    if(_node.arrived.compare_exchange_weak(_arrived, _arrived + 1, atomic::memory_order::AcqRel)) {
+                        if(_arrived + 1 == _node.expected) climb(_node.parent, _phase);
+                        return _phase;
+                    }
+                }
+            }
+            return _phase;
+        }
+
+        /**
+         * @brief Wait until the phase of the token is completed.
+         * @param phase The token of arrive.
+         * @param timeout How long to wait in ticks.
+         * @return 0 when the phase is completed and 1 on timeout.
+         */
+        int wait(arrival_token phase, unsigned int timeout = SQUADS_PORTMAX_DELAY) {
+            if(m_uiPhase.load(atomic::memory_order::Acquire) != phase) return 0;
+            if(timeout == 0) return 1;
+
+            wait_node _node;
+
+            m_queue.lock();
+            if(m_uiPhase.load(atomic::memory_order::Acquire) != phase) {
+                m_queue.unlock();
+                return 0;
+            }
+            m_queue.push_back(&_node);
+
+            if(m_queue.wait(_node, timeout)) return 0;
+            return (m_uiPhase.load(atomic::memory_order::Acquire) != phase) ? 0 : 1;
+        }
+
+        /**
+         * @brief Arrive and wait until the phase is completed.
+         * @param timeout How long to wait in ticks.
+         * @return 0 when the phase is completed and 1 on timeout.
+         */
+        int arrive_and_wait(unsigned int timeout = SQUADS_PORTMAX_DELAY) {
+            return wait(arrive(), timeout);
+        }
+
+        /**
+         * @brief Arrive and leave the group, the next phases expect one participant less.
+         */
+        void arrive_and_drop() {
+            m_uiDrops.fetch_add(1, atomic::memory_order::Relaxed);
+            arrive();
+        }
+
+        /**
+         * @brief Get the current phase.
+         */
+        uint32_t get_phase() const {
+            return m_uiPhase.load(atomic::memory_order::Relaxed);
+        }
+
+        /**
+         * @brief Get the count of participants of the current phase.
+         */
+        ptrdiff_t get_expected() const {
+            return m_iExpected;
+        }
+    private:
+        struct alignas(SQUADS_CONFIG_CACHE_LINE_SIZE) node {
+            atomic::basic_atomic_gcc<uint32_t> arrived;
+            uint32_t expected;
+            int parent;
+
+            node() : arrived(0), expected(0), parent(-1) { }
+        };
+
+        /**
+         * @brief Arrive at the parents, the last arriver of the root completes the phase.
+         */
+        void climb(int index, arrival_token phase) {
+            while(index >= 0) {
+                node& _node = m_pNodes[index];
+
+                if(_node.arrived.fetch_add(1, atomic::memory_order::AcqRel) + 1 < _node.expected)
+                    return;
+                index = _node.parent;
+            }
+            complete(phase);
+        }
+
+        void complete(arrival_token phase) {
+            m_fnCompletion();
+
+            uint32_t _drops = m_uiDrops.exchange(0, atomic::memory_order::Relaxed);
+            if(_drops != 0) {
+                m_iExpected -= _drops;
+                configure(m_iExpected);
+            }
+            for(int i = 0; i < m_iNodes; i++)
+                m_pNodes[i].arrived.store(0, atomic::memory_order::Relaxed);
+
+            m_uiPhase.store(phase + 1, atomic::memory_order::Release);
+
+            wait_node* _head = nullptr;
+
+            m_queue.lock();
+            while(!m_queue.empty()) {
+                wait_node* _node = m_queue.front();
+                m_queue.pop(_node);
+
+                _node->next = _head;
+                _head = _node;
+            }
+            m_queue.unlock();
+
+            wait_queue::wake_chain(_head);
+        }
+
+        /**
+         * @brief Build the tree for the count of participants, leaves first and the root last.
+         */
+        void build(ptrdiff_t expected) {
+            int _size = int((expected + SQUADS_CONFIG_BARRIER_ARITY - 1) / SQUADS_CONFIG_BARRIER_ARITY);
+            if(_size < 1) _size = 1;
+
+            for(;;) {
+                m_aLevelStart[m_iLevels] = m_iNodes;
+                m_aLevelSize[m_iLevels] = _size;
+                m_iLevels++;
+                m_iNodes += _size;
+
+                if(_size == 1) break;
+                _size = (_size + SQUADS_CONFIG_BARRIER_ARITY - 1) / SQUADS_CONFIG_BARRIER_ARITY;
+            }
+            m_pNodes = new node[m_iNodes];
+
+            for(int l = 0; l + 1 < m_iLevels; l++) {
+                for(int j = 0; j < m_aLevelSize[l]; j++)
+                    m_pNodes[m_aLevelStart[l] + j].parent = m_aLevelStart[l + 1] + j / SQUADS_CONFIG_BARRIER_ARITY;
+            }
+        }
+
+        /**
+         * @brief Set the expected arrivals of each node, for a count of participants.
+         */
+        void configure(ptrdiff_t expected) {
+            for(int j = 0; j < m_aLevelSize[0]; j++) {
+                ptrdiff_t _left = expected - ptrdiff_t(j) * SQUADS_CONFIG_BARRIER_ARITY;
+
+                if(_left < 0) _left = 0;
+                if(_left > SQUADS_CONFIG_BARRIER_ARITY) _left = SQUADS_CONFIG_BARRIER_ARITY;
+                m_pNodes[j].expected = uint32_t(_left);
+            }
+            for(int l = 1; l < m_iLevels; l++) {
+                for(int j = 0; j < m_aLevelSize[l]; j++)
+                    m_pNodes[m_aLevelStart[l] + j].expected = 0;
+
+                // each used child arrives once
+                for(int j = 0; j < m_aLevelSize[l - 1]; j++) {
+                    node& _child = m_pNodes[m_aLevelStart[l - 1] + j];
+                    if(_child.expected != 0) m_pNodes[_child.parent].expected++;
+                }
+            }
+        }
+    private:
+        node* m_pNodes;
+        int m_iNodes;
+        int m_iLevels;
+        int m_aLevelStart[32];
+        int m_aLevelSize[32];
+        ptrdiff_t m_iExpected;
+        atomic::basic_atomic_gcc<uint32_t> m_uiDrops;
+        atomic::basic_atomic_gcc<uint32_t> m_uiPhase;
+        completion_type m_fnCompletion;
+        wait_queue m_queue;
+    };
+
+    template <class TCOMPLETION = barrier_empty_completion>
+    using barrier = basic_barrier<TCOMPLETION>;
+}
+
+#endif
@@ -20,6 +20,10 @@
 
 #include "config.hpp"
 #include "defines.hpp"
+#include "deadline.hpp"
+#include "cancellation_token.hpp"
+
+#include <time.h>
 
 namespace squads {
     /**
@@ -44,7 +48,32 @@ namespace squads {
          */
         virtual int lock(unsigned int timeout = 0) noexcept = 0;
 
-        virtual int time_lock(const struct timespec *timeout) noexcept = 0;
+        /**
+         *  lock (take) a LokObject until the deadline
+         *  @param dl The deadline, the remaining ticks are computed once.
+         *  @param token The optional cancellation token.
+         *  @return 0 on success, 1 on timeout and SQUADS_RESULT_CANCELLED when cancelled
+         *  @note A spinning lock can't be aborted, it returns when it gets the lock.
+         */
+        int lock(const basic_deadline& dl, cancellation_token* token = nullptr) noexcept {
+            cancellation_scope _scope(token);
+            if(_scope.is_cancelled()) return SQUADS_RESULT_CANCELLED;
+
+            return (lock(dl.remaining_ticks()) == 0) ? 0 : _scope.failed_result();
+        }
+
+        /**
+         *  lock (take) a LokObject until the absolute time
+         *  @param timeout The absolute time, since the Unix epoch.
+         *  @return 0 on success and 1 on timeout
+         */
+        virtual int time_lock(const struct timespec *timeout) noexcept {
+            if(timeout == nullptr) return lock(SQUADS_PORTMAX_DELAY);
+
+            basic_timestamp _abs( basic_timestamp::time_type(timeout->tv_sec) * 1000000LL +
+                                  timeout->tv_nsec / 1000 );
+            return lock(basic_deadline(_abs));
+        }
         /**
          *  unlock (give) a semaphore.
          */
@@ -0,0 +1,153 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_CANCELLATION_TOKEN_H__
+#define __SQUADS_CANCELLATION_TOKEN_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "arch/arch_utils.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+/**
+ * @brief The return value of a blocking call with a cancellation_token,
+ * that was cancelled.
+ */
+#define SQUADS_RESULT_CANCELLED 2
+
+namespace squads {
+    class cancellation_scope;
+
+    /**
+     * @brief A token to cancel blocking calls of other tasks.
+     *
+     * The blocking calls with deadline take a optional token. When the token
+     * is cancelled, all tasks blocked with this token wake up immediately and
+     * the calls return SQUADS_RESULT_CANCELLED (or false).
+     *
+     * @code
+     * cancellation_token token;
+     *
+     * // worker task
+     * if(queue.pop(&item, deadline(), &token) == false && token.is_cancelled()) return;
+     *
+     * // control task
+     * token.cancel();
+     * @endcode
+     */
+    class cancellation_token {
+        friend class cancellation_scope;
+    public:
+        using self_type = cancellation_token;
+
+        cancellation_token();
+
+        cancellation_token(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Is the token cancelled?
+         */
+        bool is_cancelled() const {
+            return m_uiCancelled.load(atomic::memory_order::Acquire) != 0;
+        }
+
+        /**
+         * @brief Cancel the token and wake up all blocked tasks of this token.
+         * @note Each registered task is woken once, the call don't wait for the
+         * tasks. A task, that is registered but not blocked yet, don't park anymore
+         * on the primitives of this library, but a native kernel wait (queue,
+         * eventgroup), that starts after the wake up, waits until the deadline.
+         * A spinlock is not abortable, the task spins until it gets the lock.
+         * Don't call from a ISR.
+         */
+        void cancel();
+
+        /**
+         * @brief Reset the token, for reuse.
+         */
+        void reset() {
+            m_uiCancelled.store(0, atomic::memory_order::Release);
+        }
+    private:
+        /**
+         * @brief A registered blocked task, on the stack of the task.
+         */
+        struct waiter {
+            void* task;
+            waiter* next;
+            waiter* prev;
+            bool pending;
+            volatile bool aborting;
+        };
+
+        bool enter(waiter* node);
+        void leave(waiter* node);
+    private:
+        arch::arch_mux_t m_mux;
+        waiter* m_pWaiters;
+        atomic::basic_atomic_gcc<uint32_t> m_uiCancelled;
+    };
+
+    /**
+     * @brief Register the current task as waiter of a token, for one blocking call.
+     * @note The token can be nullptr, then nothing is registered.
+     */
+    class cancellation_scope {
+    public:
+        explicit cancellation_scope(cancellation_token* token);
+        ~cancellation_scope();
+
+        cancellation_scope(const cancellation_scope&) = delete;
+        cancellation_scope& operator = (const cancellation_scope&) = delete;
+
+        /**
+         * @brief Unregister the task before the end of the scope, so the blocking
+         * call can't be aborted anymore. Can called more then once.
+         */
+        void leave();
+
+        /**
+         * @brief Is the token cancelled?
+         */
+        bool is_cancelled() const {
+            return (m_pToken != nullptr) && m_pToken->is_cancelled();
+        }
+
+        /**
+         * @brief Get the result for a failed blocking call, 1 on timeout
+         * or SQUADS_RESULT_CANCELLED.
+         */
+        int failed_result() const {
+            return is_cancelled() ? SQUADS_RESULT_CANCELLED : 1;
+        }
+
+        /**
+         * @brief Is the innermost scope of the current task cancelled?
+         * @note Used by the wait_queue, so a wake up of the cancel is not taken
+         * for a foreign notification.
+         */
+        static bool current_cancelled();
+    private:
+        cancellation_token* m_pToken;
+        cancellation_token::waiter m_node;
+        cancellation_scope* m_pOuter;
+        bool m_bRegistered;
+    };
+}
+
+#endif
@@ -23,9 +23,9 @@
 #include "defines.hpp"
 #include "mutex.hpp"
 #include "autolock.hpp"
-#include "list"
-
-//TODO: Add own list 
+#include "deadline.hpp"
+#include "cancellation_token.hpp"
+#include "wait_queue.hpp"
 
 namespace squads {
     class task;
@@ -36,6 +36,12 @@ namespace squads {
      *  A condition variable isn't really a variable. It's a list
      *  of threads.
      *
+     *  The waiting tasks are wait nodes on the stack of the waiting task, so a wait
+     *  allocates nothing. A notify wakes up the task direct with the task notification.
+     *  notify_all wakes the waiters one after the other: each woken waiter wakes
+     *  the next one, after it has the mutex again. So the waiters enter the mutex
+     *  in order and not all at the same time.
+     *
      *  The design here is that a basic_convar_task "waits", and a condition_variable
      *  "signals". This affects where the public interfaces reside.
      */
@@ -56,6 +62,9 @@ namespace squads {
          */
         condition_variable();
 
+        condition_variable(const this_type&) = delete;
+        this_type& operator = (const this_type&) = delete;
+
         /**
          *  Signal a thread waiting on this condition_variable (FIFO list).
          */
@@ -74,25 +83,64 @@ namespace squads {
             broadcast();
         }
 
-        int wait(mutex& mx, unsigned int timeOut);
+        /**
+         * @brief Wait until notified or the timeout.
+         * @param mx The locked lock (mutex, fast_mutex, ...), unlocked while waiting.
+         * @param timeOut How long to wait in ticks.
+         * @return 0 when notified and 1 on timeout
+         */
+        template <class TLOCK>
+        int wait(TLOCK& mx, unsigned int timeOut = SQUADS_PORTMAX_DELAY) {
+            return wait_for(mx, timeOut, nullptr);
+        }
+
+        /**
+         * @brief Wait until notified, the deadline is expired or the token is cancelled.
+         * @param mx The locked lock, unlocked while waiting.
+         * @param dl The deadline, the remaining ticks are computed once.
+         * @param token The optional cancellation token.
+         * @return 0 when notified, 1 on timeout and SQUADS_RESULT_CANCELLED when cancelled
+         * @note The lock is held again on return, also when cancelled.
+         */
+        template <class TLOCK>
+        int wait(TLOCK& mx, const basic_deadline& dl, cancellation_token* token = nullptr) {
+            cancellation_scope _scope(token);
+            if(_scope.is_cancelled()) return SQUADS_RESULT_CANCELLED;
+
+            return (wait_for(mx, dl.remaining_ticks(), &_scope) == 0) ? 0 : _scope.failed_result();
+        }
     private:
+        template <class TLOCK>
+        int wait_for(TLOCK& mx, unsigned int timeOut, cancellation_scope* scope) {
+            wait_node _node;
+
+            m_queue.lock();
+            m_queue.push_back(&_node);
+            m_queue.unlock();
+
+            mx.unlock();
+            bool _woken = m_queue.park(_node, timeOut);
+
+            // a cancel must not abort the re-lock, the caller owns the lock on return
+            if(scope != nullptr) scope->leave();
+            while(mx.lock(SQUADS_PORTMAX_DELAY) != 0) { }
+
+            if(_woken) wake_next(_node);
+            return _woken ? 0 : 1;
+        }
+
         /**
-         *  Internal helper function to queue a task to
-         *  this condition_variable's wait list.
-         *
-         * @param task The task to add to the waiting list
+         * @brief Wake the next waiter of a notify_all chain.
          */
-        void add_list(task_type *task);
+        static void wake_next(wait_node& node) {
+            if(node.next != nullptr) wait_queue::wake(node.next);
+        }
     protected:
-         /**
-         *  Protect the internal condition_variable state.
-         */
-        mutex                           m_mutex;
         /**
-         *  Implementation of a wait list of Threads.
+         *  The queue of the waiting tasks.
          */
-        std::list<task_type*>    m_waitList;
+        wait_queue                      m_queue;
     };
 }
 
-#endif
\ No newline at end of file
+#endif
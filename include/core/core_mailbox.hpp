@@ -0,0 +1,308 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_CORE_MAILBOX_H__
+#define __SQUADS_CORE_MAILBOX_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "task.hpp"
+#include "arch/arch_utils.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+
+    /**
+     * @brief A bounded single producer, single consumer ring channel.
+     *
+     * The head (written by the producer) and the tail (written by the consumer)
+     * are on own cache lines, each side caches the index of the other side and
+     * reads the shared index only when the cached copy says full or empty.
+     *
+     * @tparam T The message type, must be default constructible and copyable.
+     * @tparam TCAPACITY The number of messages, must be a power of two.
+     */
+    template <typename T, size_t TCAPACITY = SQUADS_CONFIG_MAILBOX_CAPACITY>
+    class basic_spsc_channel {
+        static_assert(TCAPACITY > 1 && (TCAPACITY & (TCAPACITY - 1)) == 0,
+            "the channel capacity must be a power of two");
+    public:
+        using value_type = T;
+        using self_type = basic_spsc_channel<T, TCAPACITY>;
+        using index_type = uint32_t;
+        using size_type = size_t;
+
+        static constexpr index_type mask = TCAPACITY - 1;
+
+        basic_spsc_channel()
+            : m_uiHead(0), m_uiCachedTail(0), m_uiTail(0), m_uiCachedHead(0) { }
+
+        basic_spsc_channel(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Push one message (producer side).
+         * @return true if the message was pushed and false if the channel is full.
+         */
+        bool try_push(const value_type& msg) {
+            return push_batch(&msg, 1) == 1;
+        }
+
+        /**
+         * @brief Push a batch of messages, with one publish of the head (producer side).
+         * @param msgs The messages to push.
+         * @param count The number of messages.
+         * @return The number of pushed messages.
+         */
+        size_type push_batch(const value_type* msgs, size_type count) {
+            index_type _head = m_uiHead.load(atomic::memory_order::Relaxed);
+            index_type _free = TCAPACITY - (_head - m_uiCachedTail);
+
+            if(_free < count) {
+                m_uiCachedTail = m_uiTail.load(atomic::memory_order::Acquire);
+                _free = TCAPACITY - (_head - m_uiCachedTail);
+            }
+            if(count > _free) count = _free;
+
+            for(size_type i = 0; i < count; i++)
+                m_aBuffer[(_head + i) & mask] = msgs[i];
+
+            if(count > 0)
+                m_uiHead.store(_head + count, atomic::memory_order::Release);
+
+            return count;
+        }
+
+        /**
+         * @brief Pop all ready messages (consumer side).
+         * @param func Called with each message.
+         * @param max The maximal number of messages to pop.
+         * @return The number of poped messages.
+         */
+        template <typename TFUNC>
+        size_type drain(TFUNC&& func, size_type max = TCAPACITY) {
+            index_type _tail = m_uiTail.load(atomic::memory_order::Relaxed);
+
+            if(_tail == m_uiCachedHead) {
+                m_uiCachedHead = m_uiHead.load(atomic::memory_order::Acquire);
+                if(_tail == m_uiCachedHead) return 0;
+            }
+
+            size_type _count = m_uiCachedHead - _tail;
+            if(_count > max) _count = max;
+
+            for(size_type i = 0; i < _count; i++)
+                func(m_aBuffer[(_tail + i) & mask]);
+
+            m_uiTail.store(_tail + _count, atomic::memory_order::Release);
+            return _count;
+        }
+
+        /**
+         * @brief Is the channel empty?
+         * @note Only a snapshot, use from the consumer side.
+         */
+        bool empty() const {
+            return m_uiTail.load(atomic::memory_order::Relaxed) ==
+                   m_uiHead.load(atomic::memory_order::Acquire);
+        }
+    private:
+        // producer cache line
+        alignas(SQUADS_CONFIG_CACHE_LINE_SIZE) atomic::basic_atomic_gcc<index_type> m_uiHead;
+        index_type m_uiCachedTail;
+
+        // consumer cache line
+        alignas(SQUADS_CONFIG_CACHE_LINE_SIZE) atomic::basic_atomic_gcc<index_type> m_uiTail;
+        index_type m_uiCachedHead;
+
+        alignas(SQUADS_CONFIG_CACHE_LINE_SIZE) value_type m_aBuffer[TCAPACITY];
+    };
+
+    /**
+     * @brief Per core mailboxes for cross core messaging without a shared lock.
+     *
+     * Each core has one inbound basic_spsc_channel from every core (the own core
+     * included), so a message is only touched by the sending and the receiving core.
+     * A sender is the single producer of his channel, because the channel of the
+     * current core is selected with the local interrupts masked. The receiver of a core
+     * drains all inbound channels in one pass.
+     *
+     * When a receiver task is registered with set_receiver, the receiver can sleep in
+     * wait() and a post to a sleeping core rings the doorbell (a task notification).
+     *
+     * @code
+     * core_mailbox<message_t> mailbox;
+     *
+     * // receiver task on core 1
+     * mailbox.set_receiver(1, this);
+     * for(;;) {
+     *     mailbox.wait(1, SQUADS_PORTMAX_DELAY);
+     *     mailbox.drain(1, [](message_t& msg) { handle(msg); });
+     * }
+     *
+     * // any task on core 0
+     * mailbox.post(1, msg);
+     * @endcode
+     *
+     * @note drain and wait of a core must only call from the receiver task on this core.
+     *
+     * @tparam T The message type.
+     * @tparam TCAPACITY The number of messages per channel, must be a power of two.
+     * @tparam TCORES The number of cores.
+     */
+    template <typename T, size_t TCAPACITY = SQUADS_CONFIG_MAILBOX_CAPACITY,
+              size_t TCORES = SQUADS_CONFIG_NUM_CORES>
+    class basic_core_mailbox {
+    public:
+        using value_type = T;
+        using self_type = basic_core_mailbox<T, TCAPACITY, TCORES>;
+        using channel_type = basic_spsc_channel<T, TCAPACITY>;
+        using size_type = size_t;
+
+        static constexpr size_type num_cores = TCORES;
+
+        basic_core_mailbox() {
+            for(size_type i = 0; i < TCORES; i++) {
+                m_aDoorbell[i].receiver = nullptr;
+                m_aDoorbell[i].sleeping.store(0, atomic::memory_order::Relaxed);
+            }
+        }
+
+        basic_core_mailbox(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Register the receiver task of a core, for the doorbell.
+         * @param core The core id, like task::get_on_core.
+         * @param receiver The receiver task or nullptr for disable the doorbell.
+         */
+        void set_receiver(int32_t core, task* receiver) {
+            if(!is_valid_core(core)) return;
+            m_aDoorbell[core].receiver = receiver;
+        }
+
+        /**
+         * @brief Post one message to a core.
+         * @param core The core id of the receiver, like task::get_on_core.
+         * @param msg The message.
+         * @return 0 on success, 1 if the channel is full and -1 on a invalid core id.
+         */
+        int post(int32_t core, const value_type& msg) {
+            return (post_batch(core, &msg, 1) == 1) ? 0 : (is_valid_core(core) ? 1 : -1);
+        }
+
+        /**
+         * @brief Post a batch of messages to a core, with one publish and at most one doorbell.
+         * @param core The core id of the receiver, like task::get_on_core.
+         * @param msgs The messages.
+         * @param count The number of messages.
+         * @return The number of posted messages.
+         */
+        size_type post_batch(int32_t core, const value_type* msgs, size_type count) {
+            if(!is_valid_core(core) || msgs == nullptr) return 0;
+
+            int _state = arch::arch_disable_interrupts_isr();
+            size_type _src = size_type(arch::arch_get_core_id());
+            size_type _pushed = m_aChannels[core][_src].push_batch(msgs, count);
+            arch::arch_enable_interrupts_isr(_state);
+
+            if(_pushed > 0) ring(core);
+
+            return _pushed;
+        }
+
+        /**
+         * @brief Drain all inbound channels of a core in one pass.
+         * @param core The core id of the receiver.
+         * @param func Called with each message.
+         * @return The number of received messages.
+         */
+        template <typename TFUNC>
+        size_type drain(int32_t core, TFUNC&& func) {
+            if(!is_valid_core(core)) return 0;
+
+            size_type _count = 0;
+            for(size_type _src = 0; _src < TCORES; _src++)
+                _count += m_aChannels[core][_src].drain(func);
+
+            return _count;
+        }
+
+        /**
+         * @brief Sleep until a message is posted to the core or the timeout is over.
+         * @param core The core id of the receiver.
+         * @param xTicksToWait How long to wait.
+         * @return true when messages are ready and false on timeout.
+         */
+        bool wait(int32_t core, unsigned int xTicksToWait = SQUADS_PORTMAX_DELAY) {
+            if(!is_valid_core(core)) return false;
+
+            doorbell& _bell = m_aDoorbell[core];
+            _bell.sleeping.store(1, atomic::memory_order::SeqCst);
+
+            if(!is_empty(core)) {
+                _bell.sleeping.store(0, atomic::memory_order::Relaxed);
+                return true;
+            }
+            task::notify_take(true, xTicksToWait);
+            _bell.sleeping.store(0, atomic::memory_order::Relaxed);
+
+            return !is_empty(core);
+        }
+
+        /**
+         * @brief Is no message for the core ready?
+         */
+        bool is_empty(int32_t core) {
+            if(!is_valid_core(core)) return true;
+
+            for(size_type _src = 0; _src < TCORES; _src++)
+                if(!m_aChannels[core][_src].empty()) return false;
+
+            return true;
+        }
+    private:
+        bool is_valid_core(int32_t core) const {
+            return core >= 0 && size_type(core) < TCORES;
+        }
+
+        void ring(int32_t core) {
+            doorbell& _bell = m_aDoorbell[core];
+
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+            if(_bell.receiver == nullptr) return;
+            if(_bell.sleeping.load(atomic::memory_order::Relaxed) == 0) return;
+
+            if(_bell.sleeping.exchange(0, atomic::memory_order::AcqRel) != 0)
+                task::notify_give(_bell.receiver);
+        }
+    private:
+        struct doorbell {
+            alignas(SQUADS_CONFIG_CACHE_LINE_SIZE) atomic::basic_atomic_gcc<uint32_t> sleeping;
+            task* volatile receiver;
+        };
+
+        channel_type m_aChannels[TCORES][TCORES];
+        doorbell     m_aDoorbell[TCORES];
+    };
+
+    template <typename T>
+    using core_mailbox = basic_core_mailbox<T>;
+}
+
+#endif
@@ -18,7 +18,7 @@
 #ifndef __SQUADS_BASIC_COUNTER_H__
 #define __SQUADS_BASIC_COUNTER_H__
 
-#include "config.h"
+#include "config.hpp"
 #include "atomic/atomic.hpp"
 #include "copyable.hpp"
 
@@ -46,7 +46,7 @@ namespace squads {
          * value.
          * @param value The start value for this the basic_atomic_counter .
          */
-        basic_atomic_counter (const ref_type value) : m_atomicCount(counter) { }
+        basic_atomic_counter (const value_type& value) : m_atomicCount(value) { }
         /**
          * @brief Construct a new basic_atomic_counter  from a other basic_atomic_counter .
          * @param other The other basic_atomic_counter  from copyed it.
@@ -93,7 +93,7 @@ namespace squads {
          * @brief Assigns the value of another this_type .
          */
         this_type& operator = (const this_type & other) {
-            m_atomicCount.store(counter.m_atomicCount.load()); return *this;
+            m_atomicCount.store(other.m_atomicCount.load()); return *this;
         }
         /**
          * @brief Assigns a value to the basic_atomic_counter .
@@ -0,0 +1,136 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_DEADLINE_H__
+#define __SQUADS_DEADLINE_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "timespan.hpp"
+#include "timestamp.hpp"
+#include "arch/arch_utils.hpp"
+
+namespace squads {
+    /**
+     * @brief A absolute point in time, use as shared time budget of blocking calls.
+     *
+     * The deadline is stored in ticks, so a multi step operation can pass the same
+     * deadline to each step and each step waits only the remaining time.
+     *
+     * @code
+     * deadline dl(timespan_t(20000)); // 20 ms for all
+     * if(mtx.lock(dl) == 0) {
+     *     queue.pop(&item, dl);
+     *     mtx.unlock();
+     * }
+     * @endcode
+     */
+    class basic_deadline {
+    public:
+        using self_type = basic_deadline;
+        using tick_type = unsigned int;
+
+        /**
+         * @brief Construct a infinite deadline.
+         */
+        basic_deadline() : m_uiExpire(0), m_bInfinite(true) { }
+
+        /**
+         * @brief Construct a deadline relative to now.
+         */
+        explicit basic_deadline(const basic_timespan& relative)
+            : m_uiExpire(arch::arch_get_ticks() + ticks_from_us(relative.get_total_microseconds())),
+              m_bInfinite(false) { }
+
+        /**
+         * @brief Construct a deadline from a absolute timestamp.
+         */
+        explicit basic_deadline(const basic_timestamp& absolute)
+            : m_uiExpire(0), m_bInfinite(false) {
+            basic_timestamp _now;
+            m_uiExpire = arch::arch_get_ticks() + ticks_from_us(absolute - _now);
+        }
+
+        basic_deadline(const self_type& other)
+            : m_uiExpire(other.m_uiExpire), m_bInfinite(other.m_bInfinite) { }
+
+        /**
+         * @brief Create a deadline in the given ticks from now.
+         */
+        static self_type from_ticks(tick_type ticks) {
+            if(ticks == tick_type(SQUADS_PORTMAX_DELAY)) return self_type();
+
+            self_type _dl;
+            _dl.m_uiExpire = arch::arch_get_ticks() + ticks;
+            _dl.m_bInfinite = false;
+            return _dl;
+        }
+
+        /**
+         * @brief Create a deadline, that never expired.
+         */
+        static self_type infinite() { return self_type(); }
+
+        bool is_infinite() const { return m_bInfinite; }
+
+        /**
+         * @brief Get the tick count of the expire, not valid when infinite.
+         */
+        tick_type get_expire_tick() const { return m_uiExpire; }
+
+        /**
+         * @brief Is the deadline expired?
+         */
+        bool is_expired() const {
+            return !m_bInfinite && int32_t(m_uiExpire - arch::arch_get_ticks()) <= 0;
+        }
+
+        /**
+         * @brief Get the remaining ticks, use as timeout for a blocking call.
+         * @return The remaining ticks, 0 when expired and SQUADS_PORTMAX_DELAY when infinite.
+         */
+        tick_type remaining_ticks() const {
+            if(m_bInfinite) return SQUADS_PORTMAX_DELAY;
+
+            int32_t _left = int32_t(m_uiExpire - arch::arch_get_ticks());
+            return (_left > 0) ? tick_type(_left) : 0;
+        }
+
+        self_type& operator = (const self_type& other) {
+            m_uiExpire = other.m_uiExpire;
+            m_bInfinite = other.m_bInfinite;
+            return *this;
+        }
+
+        /**
+         * @brief Convert microseconds to ticks, rounded up.
+         */
+        static tick_type ticks_from_us(int64_t us) {
+            if(us <= 0) return 0;
+
+            int64_t _ticks = (us * 1000LL + SQUADS_ARCH_NSPER_TICK - 1) / SQUADS_ARCH_NSPER_TICK;
+            return (_ticks >= int64_t(INT32_MAX)) ? tick_type(INT32_MAX) : tick_type(_ticks);
+        }
+    private:
+        tick_type m_uiExpire;
+        bool m_bInfinite;
+    };
+
+    using deadline = basic_deadline;
+}
+
+#endif
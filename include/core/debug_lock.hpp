@@ -18,74 +18,350 @@
 #ifndef __SQUADS_DEBUG_LOCK_H__
 #define __SQUADS_DEBUG_LOCK_H__
 
+#include "config.hpp"
+#include "defines.hpp"
 #include "basic_lock.hpp"
+#include "arch/arch_utils.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
 
 namespace squads {
+#if SQUADS_CONFIG_LOCK_PROFILER == SQUADS_CONFIG_YES
     /**
-     * @ingroup Interface
+     * @brief The contention statistic of one named lock.
+     *
+     * All counters are lock free atomics, so the profile don't change the timing
+     * of the lock much. All times are in microseconds (arch_micros), the totals
+     * wrap after about 71 minutes, use reset for a new measurement.
+     *
+     * Each profile is registered in a global list, for dump_all.
+     *
      * @ingroup lock
      */
-    template <class TLOCK, TLOCK reflock, const char* name>
-    class debug_lock {
+    class lock_profile {
     public:
-        using this_type = debug_lock<TLOCK, reflock, name>;
+        using self_type = lock_profile;
 
         /**
-         *  lock (take) a LokObject
-         *  @param timeout How long to wait to get the Lock until giving up.
+         * @brief A task in the list of the most waiting tasks.
          */
-        virtual int lock(unsigned int timeout = 0) noexcept  { 
-            int _ret = reflock.lock(timeout);
-            if(_ret == 0) { printf("%s lock %d", name, _ret);  }
+        struct waiter {
+            atomic::basic_atomic_gcc<void*> task;
+            atomic::basic_atomic_gcc<uint32_t> wait;
 
-            return _ret;
+            waiter() : task(nullptr), wait(0) { }
+        };
+
+        explicit lock_profile(const char* name);
+        ~lock_profile();
+
+        lock_profile(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Count a acquisition of the lock.
+         * @param contended Was the lock held by a other task?
+         * @param wait The wait time in microseconds, 0 when not contended.
+         */
+        void on_acquire(bool contended, uint32_t wait) {
+            m_uiAcquisitions.fetch_add(1, atomic::memory_order::Relaxed);
+            if(!contended) return;
+
+            m_uiContended.fetch_add(1, atomic::memory_order::Relaxed);
+            m_uiWaitTotal.fetch_add(wait, atomic::memory_order::Relaxed);
+            update_max(m_uiWaitMax, wait);
+            add_waiter(arch::arch_get_current_task(), wait);
+        }
+
+        /**
+         * @brief Count a timeout of a lock try.
+         * @param wait The wait time in microseconds.
+         */
+        void on_timeout(uint32_t wait) {
+            m_uiTimeouts.fetch_add(1, atomic::memory_order::Relaxed);
+            m_uiWaitTotal.fetch_add(wait, atomic::memory_order::Relaxed);
+            update_max(m_uiWaitMax, wait);
+            add_waiter(arch::arch_get_current_task(), wait);
         }
 
-        virtual int time_lock(const struct timespec *timeout) noexcept  { 
-            int _ret = reflock.time_lock(timeout);
-            if(_ret == 0) { printf("%s time_lock %d", name, _ret); }
+        /**
+         * @brief Count a failed try_lock, no wait time and no timeout.
+         */
+        void on_try_fail() {
+            m_uiTryFails.fetch_add(1, atomic::memory_order::Relaxed);
+        }
 
-            return _ret;
+        /**
+         * @brief Count the hold time of a release.
+         * @param hold The hold time in microseconds.
+         */
+        void on_release(uint32_t hold) {
+            m_uiHoldTotal.fetch_add(hold, atomic::memory_order::Relaxed);
+            update_max(m_uiHoldMax, hold);
+        }
+
+        /**
+         * @brief Reset all counters.
+         */
+        void reset();
+
+        /**
+         * @brief Print the statistic with printf.
+         */
+        void dump() const;
+
+        /**
+         * @brief Print the statistic of all profiled locks with printf.
+         */
+        static void dump_all();
+
+        const char* get_name() const            { return m_strName; }
+        uint32_t get_acquisitions() const       { return m_uiAcquisitions.load(atomic::memory_order::Relaxed); }
+        uint32_t get_contended() const          { return m_uiContended.load(atomic::memory_order::Relaxed); }
+        uint32_t get_timeouts() const           { return m_uiTimeouts.load(atomic::memory_order::Relaxed); }
+        uint32_t get_try_fails() const          { return m_uiTryFails.load(atomic::memory_order::Relaxed); }
+        uint32_t get_wait_total() const         { return m_uiWaitTotal.load(atomic::memory_order::Relaxed); }
+        uint32_t get_wait_max() const           { return m_uiWaitMax.load(atomic::memory_order::Relaxed); }
+        uint32_t get_hold_total() const         { return m_uiHoldTotal.load(atomic::memory_order::Relaxed); }
+        uint32_t get_hold_max() const           { return m_uiHoldMax.load(atomic::memory_order::Relaxed); }
+
+        /**
+         * @brief Get a entry of the most waiting tasks, 0 to SQUADS_CONFIG_LOCK_PROFILER_TOP_TASKS - 1.
+         */
+        const waiter& get_waiter(int index) const { return m_aWaiters[index]; }
+    private:
+        static void update_max(atomic::basic_atomic_gcc<uint32_t>& max, uint32_t value) {
+            uint32_t _max = max.load(atomic::memory_order::Relaxed);
+
+            while(value > _max) {
+                if(max.compare_exchange_weak(_max, value, atomic::memory_order::Relaxed)) break;
+            }
         }
+
+        /**
+         * @brief Add the wait time to the entry of the task.
+         * @note When all entries are used, the entry with the smallest wait time is
+         * replaced, when it is smaller than the wait. A race of two replaces can lose
+         * one, so the list is only a approximation.
+         */
+        void add_waiter(void* task, uint32_t wait) {
+            int _min = 0;
+
+            for(int i = 0; i < SQUADS_CONFIG_LOCK_PROFILER_TOP_TASKS; i++) {
+                void* _task = m_aWaiters[i].task.load(atomic::memory_order::Relaxed);
+
+                if(_task == nullptr) {
+                    if(m_aWaiters[i].task.compare_exchange_strong(_task, task, atomic::memory_order::Relaxed))
+                        _task = task;
+                }
+                if(_task == task) {
+                    m_aWaiters[i].wait.fetch_add(wait, atomic::memory_order::Relaxed);
+                    return;
+                }
+                if(m_aWaiters[i].wait.load(atomic::memory_order::Relaxed) <
+                   m_aWaiters[_min].wait.load(atomic::memory_order::Relaxed)) _min = i;
+            }
+
+            if(m_aWaiters[_min].wait.load(atomic::memory_order::Relaxed) < wait) {
+                m_aWaiters[_min].task.store(task, atomic::memory_order::Relaxed);
+                m_aWaiters[_min].wait.store(wait, atomic::memory_order::Relaxed);
+            }
+        }
+    private:
+        const char* m_strName;
+        atomic::basic_atomic_gcc<uint32_t> m_uiAcquisitions;
+        atomic::basic_atomic_gcc<uint32_t> m_uiContended;
+        atomic::basic_atomic_gcc<uint32_t> m_uiTimeouts;
+        atomic::basic_atomic_gcc<uint32_t> m_uiTryFails;
+        atomic::basic_atomic_gcc<uint32_t> m_uiWaitTotal;
+        atomic::basic_atomic_gcc<uint32_t> m_uiWaitMax;
+        atomic::basic_atomic_gcc<uint32_t> m_uiHoldTotal;
+        atomic::basic_atomic_gcc<uint32_t> m_uiHoldMax;
+        waiter m_aWaiters[SQUADS_CONFIG_LOCK_PROFILER_TOP_TASKS];
+
+        /** the links of the global list, protected by the list lock */
+        lock_profile* m_pNext;
+        lock_profile* m_pPrev;
+    };
+#endif
+
+    /**
+     * @brief A named wrapper of a basic_lock (mutex, spinlock, critical_lock, ...),
+     * that profiles the contention of the lock.
+     *
+     * Each acquisition is counted in a lock_profile: first a try_lock, when that
+     * fails, the lock is contended and the wait time is measured. The hold time is
+     * measured from the acquisition to the unlock. A failed try_lock (or lock with
+     * timeout 0) is counted as a try fail, not as a timeout.
+     *
+     * When SQUADS_CONFIG_LOCK_PROFILER is SQUADS_CONFIG_NO, basic_debug_lock is a
+     * non virtual class with only the reference of the lock, see below.
+     *
+     * @code
+     * mutex g_mutex;
+     * debug_lock<mutex> g_dbgmutex(g_mutex, "net");
+     *
+     * LOCKED_SECTION(debug_lock<mutex>, g_dbgmutex) {
+     *     ...
+     * }
+     *
+     * debug_lock_dump_all();
+     * @endcode
+     *
+     * @tparam TLOCK The type of the wrapped lock.
+     *
+     * @ingroup Interface
+     * @ingroup lock
+     */
+#if SQUADS_CONFIG_LOCK_PROFILER == SQUADS_CONFIG_YES
+    template <class TLOCK>
+    class basic_debug_lock : public basic_lock {
+    public:
+        using self_type = basic_debug_lock<TLOCK>;
+        using base_type = basic_lock;
+        using lock_type = TLOCK;
+
+        using base_type::lock;
+
+        /**
+         * @param lock The lock to wrap, must live longer as the wrapper.
+         * @param name The name of the lock in the dump, must be a static string.
+         */
+        basic_debug_lock(lock_type& lock, const char* name)
+            : m_refLock(lock), m_profile(name), m_uiHoldStart(0) { }
+
+        basic_debug_lock(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
         /**
-         *  unlock (give) a semaphore.
+         *  lock (take) the wrapped lock
+         *  @param timeout How long to wait to get the Lock until giving up.
          */
-        virtual int unlock() noexcept   { 
-            int _ret = reflock.unlock();
-            if(_ret == 0) { printf("%s unlock %d", name, _ret); }
+        virtual int lock(unsigned int timeout = 0) noexcept {
+            if(m_refLock.try_lock()) {
+                m_profile.on_acquire(false, 0);
+                m_uiHoldStart = arch::arch_micros();
+                return 0;
+            }
+            if(timeout == 0) {
+                m_profile.on_try_fail();
+                return 1;
+            }
+
+            unsigned long _start = arch::arch_micros();
+            int _ret = m_refLock.lock(timeout);
+            unsigned long _now = arch::arch_micros();
 
+            if(_ret == 0) {
+                m_profile.on_acquire(true, uint32_t(_now - _start));
+                m_uiHoldStart = _now;
+            } else {
+                m_profile.on_timeout(uint32_t(_now - _start));
+            }
             return _ret;
         }
 
         /**
-         * Try to lock the ILockObject
-         *
-         * @note call lock with timeout from 0
+         *  unlock (give) the wrapped lock
+         */
+        virtual int unlock() noexcept {
+            // the hold start is only written by the owner
+            m_profile.on_release(uint32_t(arch::arch_micros() - m_uiHoldStart));
+            return m_refLock.unlock();
+        }
+
+        /**
+         * Try to lock the wrapped lock
          *
          * @return true if the Lock was acquired, false when not
          */
         virtual bool try_lock() noexcept {
-            int _ret = reflock.try_lock();
-            if(_ret == 0) { printf("%s try_lock %d", name, _ret); }
-
-            return _ret;
+            if(!m_refLock.try_lock()) {
+                m_profile.on_try_fail();
+                return false;
+            }
+            m_profile.on_acquire(false, 0);
+            m_uiHoldStart = arch::arch_micros();
+            return true;
         }
 
         /**
-         * Is the ILockObject created (initialized) ?
-         *
-         * @return true if the ILockObject created (initialized) and false when not
+         * Is the wrapped lock created (initialized) ?
+         */
+        virtual bool is_initialized() const { return m_refLock.is_initialized(); }
+
+        /**
+         * @brief Is the wrapped lock locked?
+         */
+        virtual bool is_locked() const { return m_refLock.is_locked(); }
+
+        /**
+         * @brief Print the profile of the lock.
          */
-        virtual bool is_initialized() const { return reflock.is_initialized(); }
+        void dump() const { m_profile.dump(); }
 
         /**
-         * @brief Is locked?
-         * @return True if locked and false when not.
+         * @brief Reset the profile of the lock.
          */
-        virtual bool is_locked() const { return reflock.is_locked(); }
+        void reset() { m_profile.reset(); }
+
+        const lock_profile& get_profile() const { return m_profile; }
+
+        lock_type& get_lock() { return m_refLock; }
+    private:
+        lock_type& m_refLock;
+        lock_profile m_profile;
+        unsigned long m_uiHoldStart;
+    };
+#else
+    /**
+     * @brief The disabled debug_lock: no virtual functions, no profile, only the
+     * reference of the lock. All functions are inline and forward to the lock,
+     * so the wrapper costs nothing.
+     * @note Not a basic_lock, it can't be passed as basic_lock&.
+     */
+    template <class TLOCK>
+    class basic_debug_lock {
+    public:
+        using self_type = basic_debug_lock<TLOCK>;
+        using lock_type = TLOCK;
 
+        basic_debug_lock(lock_type& lock, const char* name) : m_refLock(lock) { (void)name; }
+
+        basic_debug_lock(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        int lock(unsigned int timeout = 0) noexcept { return m_refLock.lock(timeout); }
+
+        int lock(const basic_deadline& dl, cancellation_token* token = nullptr) noexcept {
+            return m_refLock.lock(dl, token);
+        }
+
+        int unlock() noexcept { return m_refLock.unlock(); }
+        bool try_lock() noexcept { return m_refLock.try_lock(); }
+
+        bool is_initialized() const { return m_refLock.is_initialized(); }
+        bool is_locked() const { return m_refLock.is_locked(); }
+
+        void dump() const { }
+        void reset() { }
+
+        lock_type& get_lock() { return m_refLock; }
+    private:
+        lock_type& m_refLock;
     };
+#endif
+
+    template <class TLOCK>
+    using debug_lock = basic_debug_lock<TLOCK>;
 
+    /**
+     * @brief Print the profiles of all debug_lock's, does nothing when the profiler is disabled.
+     */
+    inline void debug_lock_dump_all() {
+#if SQUADS_CONFIG_LOCK_PROFILER == SQUADS_CONFIG_YES
+        lock_profile::dump_all();
+#endif
+    }
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,414 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_EVENT_FLAGS_H__
+#define __SQUADS_EVENT_FLAGS_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "uint128.hpp"
+#include "deadline.hpp"
+#include "cancellation_token.hpp"
+#include "wait_queue.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    namespace internal {
+        /**
+         * @brief Split a event mask in 32 bit words (bit 0 in word 0) and join it.
+         */
+        template <typename T>
+        struct event_mask_traits;
+
+        template <>
+        struct event_mask_traits<uint32_t> {
+            enum { words = 1 };
+
+            static void split(uint32_t mask, uint32_t* w) { w[0] = mask; }
+            static uint32_t join(const uint32_t* w) { return w[0]; }
+        };
+
+        template <>
+        struct event_mask_traits<uint64_t> {
+            enum { words = 2 };
+
+            static void split(uint64_t mask, uint32_t* w) {
+                w[0] = uint32_t(mask);
+                w[1] = uint32_t(mask >> 32);
+            }
+            static uint64_t join(const uint32_t* w) {
+                return uint64_t(w[0]) | (uint64_t(w[1]) << 32);
+            }
+        };
+
+        template <>
+        struct event_mask_traits<basic_uint128_t> {
+            enum { words = 4 };
+
+            static void split(const basic_uint128_t& mask, uint32_t* w) {
+                event_mask_traits<uint64_t>::split(mask.low, w);
+                event_mask_traits<uint64_t>::split(mask.high, w + 2);
+            }
+            static basic_uint128_t join(const uint32_t* w) {
+                basic_uint128_t _mask;
+                _mask.low = event_mask_traits<uint64_t>::join(w);
+                _mask.high = event_mask_traits<uint64_t>::join(w + 2);
+                return _mask;
+            }
+        };
+    }
+
+    /**
+     * @brief Event flags with a 32, 64 or 128 bit mask, without kernel calls on the fast path.
+     *
+     * Unlike the eventgroup, all bits of the mask are usable. The mask is held in
+     * atomic 32 bit words: set, clear and get are atomic operations on the words and
+     * take no lock, when no task is waiting, so set and clear can used in a ISR.
+     * A task parks only, when the bits that it waits for are not already set.
+     *
+     * A setter wakes the waiters, which condition is met, under the lock of the wait
+     * queue. Like the eventgroup, all woken waiters see the same value and the
+     * bits of the waiters with clear on exit are cleared after all waiters are checked.
+     *
+     * @code
+     * event_flags g_channels;
+     *
+     * // ISR of channel 40
+     * g_channels.set(uint64_t(1) << 40);
+     *
+     * // task
+     * uint64_t bits = g_channels.wait(uint64_t(0xFF) << 40, true, false);
+     * @endcode
+     *
+     * @note A mask over more as one word is set and cleared word by word.
+     *
+     * @tparam TMASK The type of the mask: uint32_t, uint64_t or basic_uint128_t.
+     *
+     * @ingroup base
+     */
+    template <typename TMASK>
+    class basic_event_flags {
+    public:
+        using self_type = basic_event_flags<TMASK>;
+        using event_bit_type = TMASK;
+        using traits_type = internal::event_mask_traits<TMASK>;
+
+        enum { words = traits_type::words };
+
+        basic_event_flags() : m_uiWaiters(0), m_queue() {
+            for(int i = 0; i < words; i++)
+                m_aWords[i].store(0, atomic::memory_order::Relaxed);
+        }
+
+        basic_event_flags(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Set bits, and wake the waiters which condition is met.
+         * @note Can call from a ISR.
+         * @return The value of the flags, after the set and the clear of the woken waiters.
+         */
+        event_bit_type set(const event_bit_type& bits) {
+            uint32_t _bits[words];
+            traits_type::split(bits, _bits);
+
+            for(int i = 0; i < words; i++) {
+                if(_bits[i] != 0) m_aWords[i].fetch_or(_bits[i], atomic::memory_order::SeqCst);
+            }
+            if(m_uiWaiters.load(atomic::memory_order::SeqCst) != 0) {
+                m_queue.lock();
+                wait_node* _chain = wake_locked();
+                m_queue.unlock();
+
+                unpark_chain(_chain);
+            }
+            return get();
+        }
+
+        /**
+         * @brief Clear bits.
+         * @note Can call from a ISR.
+         * @return The value of the flags before the clear.
+         */
+        event_bit_type clear(const event_bit_type& bits) {
+            uint32_t _bits[words], _old[words];
+            traits_type::split(bits, _bits);
+
+            for(int i = 0; i < words; i++)
+                _old[i] = m_aWords[i].fetch_and(~_bits[i], atomic::memory_order::AcqRel);
+
+            return traits_type::join(_old);
+        }
+
+        /**
+         * @brief Get the current value of the flags.
+         * @note Can call from a ISR.
+         */
+        event_bit_type get() const {
+            uint32_t _value[words];
+            load(_value);
+
+            return traits_type::join(_value);
+        }
+
+        /**
+         * @brief Block to wait for one or all bits of the mask.
+         *
+         * @param bits The bits to wait for.
+         * @param clear_on_exit When true then the bits of the mask are cleared, when the
+         * condition is met.
+         * @param wait_all When true then wait for all bits, when false for any bit.
+         * @param timeout How long to wait in ticks.
+         *
+         * @return The value of the flags, when the condition was met (before the clear),
+         * or the current value on timeout. Test the return value to know which bits was set.
+         */
+        event_bit_type wait(const event_bit_type& bits, bool clear_on_exit, bool wait_all,
+                            unsigned int timeout = SQUADS_PORTMAX_DELAY) {
+            waiter _waiter(wait_all, clear_on_exit);
+            traits_type::split(bits, _waiter.mask);
+
+            if(!clear_on_exit) {
+                uint32_t _value[words];
+                load(_value);
+
+                // no change of the flags, so no lock
+                if(test(_value, _waiter) || timeout == 0) return traits_type::join(_value);
+            }
+
+            m_queue.lock();
+            return block(_waiter, timeout);
+        }
+
+        /**
+         * @brief Block to wait for one or all bits until the deadline.
+         *
+         * The remaining ticks of the deadline are computed once. When the token is
+         * cancelled, the wait returns immediately with the current value of the flags.
+         *
+         * @param status The optional status of the wait: 0 when the bits was set,
+         * 1 on timeout and SQUADS_RESULT_CANCELLED when cancelled.
+         */
+        event_bit_type wait(const event_bit_type& bits, bool clear_on_exit, bool wait_all,
+                            const basic_deadline& dl, cancellation_token* token = nullptr,
+                            int* status = nullptr) {
+            cancellation_scope _scope(token);
+            if(_scope.is_cancelled()) {
+                if(status != nullptr) *status = SQUADS_RESULT_CANCELLED;
+                return get();
+            }
+            event_bit_type _value = wait(bits, clear_on_exit, wait_all, dl.remaining_ticks());
+
+            if(status != nullptr) {
+                waiter _waiter(wait_all, false);
+                uint32_t _words[words];
+
+                traits_type::split(bits, _waiter.mask);
+                traits_type::split(_value, _words);
+                *status = test(_words, _waiter) ? 0 : _scope.failed_result();
+            }
+            return _value;
+        }
+
+        /**
+         * @brief Block to wait for one or more bits.
+         * @return If true then was one of the bits set and false if not.
+         */
+        bool is_bit(const event_bit_type& bits, unsigned int timeout) {
+            waiter _waiter(false, false);
+            uint32_t _value[words];
+
+            traits_type::split(bits, _waiter.mask);
+            traits_type::split(wait(bits, false, false, timeout), _value);
+
+            return test(_value, _waiter);
+        }
+
+        /**
+         * @brief Allow two or more tasks to sync each other, like xEventGroupSync.
+         *
+         * Set the bits, then wait until all bits of the wait mask are set. The bits
+         * of the wait mask are cleared, when the condition is met.
+         *
+         * @param set_bits The bits to set, before the wait.
+         * @param wait_bits The bits to wait for.
+         * @param timeout How long to wait in ticks.
+         *
+         * @return The value of the flags, when all bits was set (before the clear),
+         * or the current value on timeout.
+         */
+        event_bit_type sync(const event_bit_type& set_bits, const event_bit_type& wait_bits,
+                            unsigned int timeout = SQUADS_PORTMAX_DELAY) {
+            uint32_t _bits[words];
+            waiter _waiter(true, true);
+
+            traits_type::split(set_bits, _bits);
+            traits_type::split(wait_bits, _waiter.mask);
+
+            m_queue.lock();
+
+            // set, then wake the other tasks and test the own condition on the same
+            // value, all under the lock: the last arriver sees all bits before the clear
+            for(int i = 0; i < words; i++) {
+                if(_bits[i] != 0) m_aWords[i].fetch_or(_bits[i], atomic::memory_order::SeqCst);
+            }
+            bool _met = false;
+            wait_node* _chain = wake_locked(&_waiter, &_met);
+
+            if(_met || timeout == 0) {
+                m_queue.unlock();
+                unpark_chain(_chain);
+
+                return _met ? traits_type::join(_waiter.result) : get();
+            }
+            if(_chain != nullptr) {
+                m_queue.unlock();
+                unpark_chain(_chain);
+                m_queue.lock();
+            }
+            return block(_waiter, timeout);
+        }
+
+        /**
+         * @brief Get the count of the waiting tasks.
+         */
+        uint32_t get_waiters() const {
+            return m_uiWaiters.load(atomic::memory_order::Relaxed);
+        }
+    private:
+        /**
+         * @brief A waiting task, lives on the stack of the task.
+         */
+        struct waiter {
+            wait_node node;
+            uint32_t mask[words];
+            uint32_t result[words];
+            bool all;
+            bool clear;
+
+            waiter(bool wait_all, bool clear_on_exit) : node(), all(wait_all), clear(clear_on_exit) {
+                node.data = reinterpret_cast<uintptr_t>(this);
+            }
+        };
+
+        void load(uint32_t* value) const {
+            for(int i = 0; i < words; i++)
+                value[i] = m_aWords[i].load(atomic::memory_order::Acquire);
+        }
+
+        static bool test(const uint32_t* value, const waiter& w) {
+            uint32_t _any = 0;
+
+            for(int i = 0; i < words; i++) {
+                if(w.all && (value[i] & w.mask[i]) != w.mask[i]) return false;
+                _any |= value[i] & w.mask[i];
+            }
+            return w.all || _any != 0;
+        }
+
+        /**
+         * @brief Test the condition of the waiter, or park until it is met.
+         * @note Hold the lock, returns unlocked.
+         */
+        event_bit_type block(waiter& w, unsigned int timeout) {
+            uint32_t _value[words];
+
+            // count the waiter before the test, so a set after the test takes the lock
+            m_uiWaiters.fetch_add(1, atomic::memory_order::SeqCst);
+            load(_value);
+
+            if(test(_value, w) || timeout == 0) {
+                m_uiWaiters.fetch_sub(1, atomic::memory_order::Relaxed);
+
+                if(w.clear && test(_value, w)) {
+                    for(int i = 0; i < words; i++) {
+                        if(w.mask[i] != 0) m_aWords[i].fetch_and(~w.mask[i], atomic::memory_order::AcqRel);
+                    }
+                }
+                m_queue.unlock();
+                return traits_type::join(_value);
+            }
+            m_queue.push_back(&w.node);
+
+            if(m_queue.wait(w.node, timeout)) return traits_type::join(w.result);
+
+            m_uiWaiters.fetch_sub(1, atomic::memory_order::Relaxed);
+            return get();
+        }
+
+        /**
+         * @brief Pop all waiters, which condition is met, and clear the bits of them.
+         * @note Hold the lock, unpark the chain after unlock.
+         * @param self A not queued waiter, tested on the same value as the queued waiters.
+         * @param met Set to true, when the condition of self is met.
+         * @return The chain of the woken nodes, linked by next.
+         */
+        wait_node* wake_locked(waiter* self = nullptr, bool* met = nullptr) {
+            uint32_t _value[words];
+            uint32_t _clear[words] = { };
+            wait_node* _chain = nullptr;
+
+            load(_value);
+
+            if(self != nullptr && test(_value, *self)) {
+                for(int i = 0; i < words; i++) {
+                    self->result[i] = _value[i];
+                    if(self->clear) _clear[i] |= self->mask[i];
+                }
+                *met = true;
+            }
+
+            wait_node* _node = m_queue.front();
+            while(_node != nullptr) {
+                wait_node* _next = _node->next;
+                waiter* _waiter = reinterpret_cast<waiter*>(_node->data);
+
+                if(test(_value, *_waiter)) {
+                    for(int i = 0; i < words; i++) {
+                        _waiter->result[i] = _value[i];
+                        if(_waiter->clear) _clear[i] |= _waiter->mask[i];
+                    }
+                    m_queue.pop(_node);
+                    m_uiWaiters.fetch_sub(1, atomic::memory_order::Relaxed);
+
+                    _node->next = _chain;
+                    _chain = _node;
+                }
+                _node = _next;
+            }
+
+            for(int i = 0; i < words; i++) {
+                if(_clear[i] != 0) m_aWords[i].fetch_and(~_clear[i], atomic::memory_order::AcqRel);
+            }
+            return _chain;
+        }
+
+        static void unpark_chain(wait_node* chain) {
+            wait_queue::wake_chain(chain);
+        }
+    private:
+        atomic::basic_atomic_gcc<uint32_t> m_aWords[words];
+        atomic::basic_atomic_gcc<uint32_t> m_uiWaiters;
+        wait_queue m_queue;
+    };
+
+    using event_flags32 = basic_event_flags<uint32_t>;
+    using event_flags = basic_event_flags<uint64_t>;
+    using event_flags128 = basic_event_flags<basic_uint128_t>;
+}
+
+#endif
@@ -0,0 +1,316 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_EVENT_LOOP_H__
+#define __SQUADS_EVENT_LOOP_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "task.hpp"
+#include "mutex.hpp"
+#include "timespan.hpp"
+#include "eventgroup.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    class event_loop;
+
+    /**
+     * @brief Base of all readiness sources of a event_loop.
+     *
+     * A source is a intrusive node, attach and ready notification allocate nothing.
+     * When the source signals, it is put in the ready list of the loop and
+     * on_dispatch is called inline on the loop task.
+     *
+     * @ingroup task
+     */
+    class event_source {
+        friend class event_loop;
+    public:
+        event_source() : m_pLoop(nullptr), m_pNextReady(nullptr), m_uiQueued(0) { }
+        virtual ~event_source() { }
+
+        event_source(const event_source&) = delete;
+        event_source& operator = (const event_source&) = delete;
+
+        /**
+         * @brief Is the source attached to a event loop?
+         */
+        bool is_attached() const { return m_pLoop != nullptr; }
+
+        /**
+         * @brief Mark the source as ready and wake up the loop.
+         * @note Can call from a ISR.
+         */
+        void signal();
+    protected:
+        /**
+         * @brief Called on the loop task, when the source was signaled.
+         */
+        virtual void on_dispatch() = 0;
+
+        /**
+         * @brief Is the source after on_dispatch still ready?
+         * When true, then the source is dispatched again in the next pass.
+         */
+        virtual bool is_ready() { return false; }
+
+        /**
+         * @brief Called on attach, use to install the readiness listener.
+         */
+        virtual void on_attach() { }
+
+        /**
+         * @brief Called on detach, use to remove the readiness listener.
+         */
+        virtual void on_detach() { }
+
+        /**
+         * @brief Listener thunk for arch_queue_impl and eventgroup, ctx is the source.
+         */
+        static void signal_thunk(void* ctx) {
+            static_cast<event_source*>(ctx)->signal();
+        }
+    private:
+        event_loop* volatile m_pLoop;
+        event_source* m_pNextReady;
+        atomic::basic_atomic_gcc<uint32_t> m_uiQueued;
+    };
+
+    /**
+     * @brief Watch a basic_queue for items.
+     *
+     * on_ready is called, when the queue has items. The handler should pop with
+     * a timeout of 0, when items left, the handler is called again in the next pass.
+     *
+     * @note The queue listener is used by this watch.
+     */
+    template <class TQUEUE>
+    class basic_queue_watch : public event_source {
+    public:
+        using queue_type = TQUEUE;
+        using base_type = event_source;
+
+        explicit basic_queue_watch(queue_type& queue) : m_refQueue(queue) { }
+
+        queue_type& get_queue() { return m_refQueue; }
+    protected:
+        /**
+         * @brief Called on the loop task, when the queue has items.
+         */
+        virtual void on_ready(queue_type& queue) = 0;
+
+        void on_dispatch() override { on_ready(m_refQueue); }
+        bool is_ready() override    { return !m_refQueue.is_empty(); }
+
+        void on_attach() override {
+            m_refQueue.set_listener(&base_type::signal_thunk, this);
+            if(!m_refQueue.is_empty()) signal();
+        }
+        void on_detach() override {
+            m_refQueue.set_listener(nullptr, nullptr);
+        }
+    private:
+        queue_type& m_refQueue;
+    };
+
+    /**
+     * @brief Watch bits of a eventgroup.
+     *
+     * on_bits is called, when one of the watched bits is set.
+     *
+     * @note The eventgroup listener is used by this watch.
+     */
+    class eventgroup_watch : public event_source {
+    public:
+        using event_bit_type = eventgroup::event_bit_type;
+        using base_type = event_source;
+
+        /**
+         * @param group The event group to watch.
+         * @param uxBits The bits to watch.
+         * @param bClearOnDispatch When true, then clear the set watched bits before on_bits.
+         */
+        eventgroup_watch(eventgroup& group, event_bit_type uxBits, bool bClearOnDispatch = true)
+            : m_refGroup(group), m_uxBits(uxBits), m_bClear(bClearOnDispatch) { }
+
+        eventgroup& get_group() { return m_refGroup; }
+    protected:
+        /**
+         * @brief Called on the loop task with the set watched bits.
+         */
+        virtual void on_bits(event_bit_type uxBits) = 0;
+
+        void on_dispatch() override {
+            event_bit_type _bits = m_refGroup.get() & m_uxBits;
+            if(_bits == 0) return;
+
+            if(m_bClear) m_refGroup.clear(_bits);
+            on_bits(_bits);
+        }
+        void on_attach() override {
+            m_refGroup.set_listener(&base_type::signal_thunk, this);
+            if((m_refGroup.get() & m_uxBits) != 0) signal();
+        }
+        void on_detach() override {
+            m_refGroup.set_listener(nullptr, nullptr);
+        }
+    private:
+        eventgroup& m_refGroup;
+        event_bit_type m_uxBits;
+        bool m_bClear;
+    };
+
+    /**
+     * @brief A intrusive one shot or periodic timer of a event_loop.
+     */
+    class event_timer {
+        friend class event_loop;
+    public:
+        event_timer()
+            : m_pLoop(nullptr), m_pNext(nullptr), m_pPrev(nullptr),
+              m_uiExpire(0), m_uiPeriod(0) { }
+        virtual ~event_timer() { }
+
+        event_timer(const event_timer&) = delete;
+        event_timer& operator = (const event_timer&) = delete;
+
+        /**
+         * @brief Is the timer started?
+         */
+        bool is_armed() const { return m_pLoop != nullptr; }
+    protected:
+        /**
+         * @brief Called on the loop task, when the timer expired.
+         */
+        virtual void on_timer() = 0;
+    private:
+        event_loop* m_pLoop;
+        event_timer* m_pNext;
+        event_timer* m_pPrev;
+        unsigned int m_uiExpire;
+        unsigned int m_uiPeriod;
+    };
+
+    /**
+     * @brief A reactor task, that multiplexes timers, queue readiness and
+     * event group bits in one blocking wait.
+     *
+     * All callbacks run inline on the loop task, so many small handlers share
+     * one task and one stack. The loop waits with a task notification and the
+     * time to the next timer as timeout.
+     *
+     * @code
+     * class rx_handler : public basic_queue_watch<basic_queue<int>> {
+     * public:
+     *     rx_handler(basic_queue<int>& q) : basic_queue_watch(q) { }
+     * protected:
+     *     void on_ready(basic_queue<int>& q) override {
+     *         int item;
+     *         if(q.pop(&item, 0)) handle(item);
+     *     }
+     * };
+     *
+     * event_loop loop;
+     * loop.attach(handler);
+     * loop.start_timer(blink, timespan_t(500000), true);
+     * loop.start(SQUADS_CONFIG_DEFAULT_CORE);
+     * @endcode
+     *
+     * @note attach and detach should only be called before start or from the loop task.
+     * A detached source must stay valid until the current dispatch pass ends.
+     *
+     * @ingroup task
+     */
+    class event_loop : public task {
+    public:
+        using base_type = task;
+        using self_type = event_loop;
+
+        explicit event_loop(const char* strName = "evloop",
+            priority uiPriority = priority::Normal,
+            unsigned short usStackDepth = SQUADS_CONFIG_STACK_DEPTH) noexcept;
+
+        /**
+         * @brief Attach a readiness source.
+         * @return 0 on success and 1 when the source is already attached.
+         */
+        int attach(event_source& source);
+
+        /**
+         * @brief Detach a readiness source.
+         * @return 0 on success and 1 when the source is not attached to this loop.
+         */
+        int detach(event_source& source);
+
+        /**
+         * @brief Start a timer.
+         * @param timer The timer.
+         * @param xTicks The ticks to the first expire.
+         * @param bPeriodic When true, then restart the timer on each expire.
+         * @return 0 on success and 1 when the timer is already started.
+         */
+        int start_timer(event_timer& timer, unsigned int xTicks, bool bPeriodic = false);
+
+        /**
+         * @brief Start a timer.
+         * @param timer The timer.
+         * @param span The time to the first expire.
+         * @param bPeriodic When true, then restart the timer on each expire.
+         * @return 0 on success and 1 when the timer is already started.
+         */
+        int start_timer(event_timer& timer, const timespan_t& span, bool bPeriodic = false) {
+            return start_timer(timer, (unsigned int)span.to_ticks(), bPeriodic);
+        }
+
+        /**
+         * @brief Stop a started timer.
+         * @return 0 on success and 1 when the timer is not started on this loop.
+         */
+        int stop_timer(event_timer& timer);
+
+        /**
+         * @brief Stop the loop after the current pass.
+         */
+        void quit();
+
+        /**
+         * @brief Wake up the loop.
+         * @note Can call from a ISR.
+         */
+        void wakeup();
+    protected:
+        virtual int on_task() override;
+    private:
+        friend class event_source;
+
+        void push_ready(event_source* source);
+        void dispatch_ready();
+        unsigned int run_timers();
+
+        void insert_timer(event_timer* timer);
+        void remove_timer(event_timer* timer);
+    private:
+        mutex m_timerLock;
+        event_timer* m_pTimers;
+        atomic::basic_atomic_gcc<event_source*> m_pReady;
+        void* volatile m_pNative;
+        volatile bool m_bQuit;
+    };
+}
+
+#endif
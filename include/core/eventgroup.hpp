@@ -24,6 +24,8 @@
 #include "algorithm.hpp"
 #include "defines.hpp"
 #include "uint128.hpp"
+#include "deadline.hpp"
+#include "cancellation_token.hpp"
 
 
 #include <stdint.h>
@@ -38,6 +40,10 @@ namespace squads {
         using this_type = eventgroup;
         using native_handle_type = void*;
         using event_bit_type = SQUADS_THREAD_CONFIG_TICK_TYPE;
+        /**
+         * @brief Function called after bits was set, with the listener context.
+         */
+        using listener_type = void (*)(void* ctx);
         /**
          * @brief Consruct a new event group.
          *
@@ -171,6 +177,35 @@ namespace squads {
         event_bit_type wait( const event_bit_type uxBitsToWaitFor,
                     bool xClearOnExit, bool xWaitForAllBits, uint32_t timeout = SQUADS_PORTMAX_DELAY);
 
+        /**
+         * @brief Block to wait for one or more bits until the deadline.
+         *
+         * Like the tick version, the remaining ticks of the deadline are computed once.
+         * When the token is cancelled, the wait returns immediately with the current
+         * value of the group.
+         *
+         * @param status The optional status of the wait: 0 when the bits was set,
+         * 1 on timeout and SQUADS_RESULT_CANCELLED when cancelled.
+         */
+        event_bit_type wait( const event_bit_type uxBitsToWaitFor,
+                    bool xClearOnExit, bool xWaitForAllBits,
+                    const basic_deadline& dl, cancellation_token* token = nullptr,
+                    int* status = nullptr) {
+            cancellation_scope _scope(token);
+            if(_scope.is_cancelled()) {
+                if(status != nullptr) *status = SQUADS_RESULT_CANCELLED;
+                return get();
+            }
+            event_bit_type _bits = wait(uxBitsToWaitFor, xClearOnExit, xWaitForAllBits, dl.remaining_ticks());
+
+            if(status != nullptr) {
+                event_bit_type _set = _bits & uxBitsToWaitFor;
+                bool _met = xWaitForAllBits ? (_set == uxBitsToWaitFor) : (_set != 0);
+                *status = _met ? 0 : _scope.failed_result();
+            }
+            return _bits;
+        }
+
         /**
          * @brief  Clear bits (flags) within an event group.
          *
@@ -225,11 +260,32 @@ namespace squads {
          * @param strName The name of this class.
          */
         void set_name(const char* strName);
+
+        /**
+         * @brief Set the listener, that is called after bits was set.
+         * Use for readiness notification, like the event_loop.
+         *
+         * @param listener The listener or nullptr to remove it.
+         * @param ctx The context for the listener.
+         * @note A set from a ISR is deferred to the timer task, the listener is
+         * called on the timer task after the deferred set, and only when the set
+         * was queued. When the timer command queue is full between the set and
+         * the listener call, the notification is lost.
+         */
+        void set_listener(listener_type listener, void* ctx) {
+            m_pListenerCtx = ctx;
+            m_pListener = listener;
+        }
 	private:
 		/**
 		 * @brief Initialisert the eventgroup
 		 */
 		void init_internal();
+
+        /**
+         * @brief Call the listener, direct or as pended function of the timer task.
+         */
+        static void call_listener(void* pvGroup, uint32_t ulUnused);
     private:
         /**
          *  FreeRTOS Event Group handle.
@@ -239,6 +295,11 @@ namespace squads {
 		 * The name of this event group, for debuging.
 		 */
         char m_strName[16];
+        /**
+         * The readiness listener and his context.
+         */
+        listener_type m_pListener;
+        void* m_pListenerCtx;
     };
 }
 #endif
\ No newline at end of file
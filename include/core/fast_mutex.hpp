@@ -0,0 +1,155 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_FAST_MUTEX_H__
+#define __SQUADS_FAST_MUTEX_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "deadline.hpp"
+#include "cancellation_token.hpp"
+#include "wait_queue.hpp"
+#include "arch/arch_utils.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    /**
+     * @brief A non virtual mutex with a uncontended fast path without kernel call.
+     *
+     * The state is one atomic word: 0 unlocked, 1 locked and 2 locked with waiters.
+     * Lock and unlock are one atomic operation, when the mutex is free. On contention
+     * the task spins a adaptive number of rounds (only on multi core systems), then
+     * parks in a wait_queue until the owner unlocks.
+     *
+     * @note Not recursive, no priority inheritance - use squads::mutex for this.
+     * @note Can used with basic_autolock.
+     *
+     * @ingroup lock
+     */
+    class fast_mutex {
+    public:
+        using self_type = fast_mutex;
+
+        enum {
+            unlocked = 0,
+            locked = 1,
+            contended = 2
+        };
+
+        fast_mutex() : m_uiState(unlocked), m_iSpin(SQUADS_CONFIG_FAST_MUTEX_SPIN_MAX / 2), m_queue() { }
+
+        fast_mutex(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Lock the mutex.
+         * @param timeout How long to wait in ticks.
+         * @return 0 on success and 1 on timeout.
+         */
+        int lock(unsigned int timeout = SQUADS_PORTMAX_DELAY) {
+            uint32_t _expected = unlocked;
+            if(m_uiState.compare_exchange_strong(_expected, locked, atomic::memory_order::Acquire))
+                return 0;
+
+            return lock_slow(timeout);
+        }
+
+        /**
+         * @brief Lock the mutex until the deadline.
+         * @return 0 on success, 1 on timeout and SQUADS_RESULT_CANCELLED when cancelled.
+         */
+        int lock(const basic_deadline& dl, cancellation_token* token = nullptr) {
+            cancellation_scope _scope(token);
+            if(_scope.is_cancelled()) return SQUADS_RESULT_CANCELLED;
+
+            return (lock(dl.remaining_ticks()) == 0) ? 0 : _scope.failed_result();
+        }
+
+        /**
+         * @brief Try to lock the mutex, without waiting.
+         * @return true if the lock was acquired.
+         */
+        bool try_lock() {
+            uint32_t _expected = unlocked;
+            return m_uiState.compare_exchange_strong(_expected, locked, atomic::memory_order::Acquire);
+        }
+
+        /**
+         * @brief Unlock the mutex and wake up one waiter.
+         * @return 0
+         */
+        int unlock() {
+            if(m_uiState.exchange(unlocked, atomic::memory_order::Release) == contended) {
+                m_queue.lock();
+                void* _task = m_queue.pop_front();
+                m_queue.unlock();
+
+                wait_queue::unpark(_task);
+            }
+            return 0;
+        }
+
+        bool is_locked() const {
+            return m_uiState.load(atomic::memory_order::Relaxed) != unlocked;
+        }
+    private:
+        int lock_slow(unsigned int timeout) {
+            if(timeout == 0) return 1;
+
+            // adaptive spinning, only when a other core can release the lock
+            int _limit = m_iSpin * 2 + 1;
+            if(_limit > SQUADS_CONFIG_FAST_MUTEX_SPIN_MAX) _limit = SQUADS_CONFIG_FAST_MUTEX_SPIN_MAX;
+
+            for(int i = 0; i < _limit; i++) {
+                arch::arch_cpu_relax();
+
+                if(m_uiState.load(atomic::memory_order::Relaxed) == unlocked && try_lock()) {
+                    m_iSpin = m_iSpin + (i - m_iSpin) / 8;
+                    return 0;
+                }
+            }
+            m_iSpin = m_iSpin + (_limit - m_iSpin) / 8;
+
+            basic_deadline _dl = basic_deadline::from_ticks(timeout);
+            wait_node _node;
+
+            while(m_uiState.exchange(contended, atomic::memory_order::Acquire) != unlocked) {
+                m_queue.lock();
+
+                if(m_uiState.load(atomic::memory_order::Relaxed) != contended) {
+                    // unlocked between, try again
+                    m_queue.unlock();
+                    continue;
+                }
+                if(_dl.is_expired()) {
+                    m_queue.unlock();
+                    return 1;
+                }
+                m_queue.push_back(&_node);
+
+                if(!m_queue.wait(_node, _dl.remaining_ticks())) return 1;
+            }
+            return 0;
+        }
+    private:
+        atomic::basic_atomic_gcc<uint32_t> m_uiState;
+        volatile int m_iSpin;
+        wait_queue m_queue;
+    };
+}
+
+#endif
@@ -0,0 +1,271 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_INTRUSIVE_PTR_H__
+#define __SQUADS_INTRUSIVE_PTR_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "functional.hpp"
+#include "algorithm.hpp"
+#include "arch/arch_utils.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    /**
+     * @brief The base of objects with a intrusive reference count, with biased counting.
+     *
+     * The task, that creates the object, is the owner: his retains and releases are
+     * plain (not atomic) adds on the biased count. Other tasks use the atomic shared
+     * count. When the biased count of the owner drops to zero, the owner merges the
+     * biased count in the shared count and gives up the bias: after the merge all
+     * tasks use the shared count, and the object is destroyed when it is zero.
+     *
+     * When a other task drops the shared count to zero or below, before the merge, the
+     * object is queued for the owner. The owner merges the queued objects on his
+     * next release or with merge_queued (deferred counting).
+     *
+     * @code
+     * class message : public ref_counted { ... };
+     *
+     * intrusive_ptr<message> msg(new message());
+     * mailbox.post(msg);                  // other task, atomic count
+     * @endcode
+     *
+     * @note A owner task, that gives objects to other tasks and not release objects self,
+     * should call merge_queued periodically. Don't use the count in a ISR.
+     *
+     * @ingroup base
+     */
+    class ref_counted {
+    public:
+        /**
+         * @brief A entry in the merge queue of the owner.
+         */
+        struct merge_node {
+            merge_node* next;
+            ref_counted* object;
+        };
+
+        ref_counted() noexcept
+            : m_pOwner(arch::arch_get_current_task()), m_iBiased(0), m_iShared(0), m_node{ nullptr, this } { }
+
+        /**
+         * @brief A copy is a new object, with a own count.
+         */
+        ref_counted(const ref_counted&) noexcept
+            : m_pOwner(arch::arch_get_current_task()), m_iBiased(0), m_iShared(0), m_node{ nullptr, this } { }
+
+        ref_counted& operator = (const ref_counted&) noexcept { return *this; }
+
+        virtual ~ref_counted() { }
+
+        /**
+         * @brief Add references.
+         * @param n The count of the references, for containers of pointers.
+         */
+        void retain(uint32_t n = 1) noexcept {
+            if(is_biased()) m_iBiased += int32_t(n);
+            else m_iShared.fetch_add(int32_t(n) << count_shift, atomic::memory_order::Relaxed);
+        }
+
+        /**
+         * @brief Release references, the object is destroyed with the last reference.
+         * @param n The count of the references, for containers of pointers.
+         */
+        void release(uint32_t n = 1) noexcept;
+
+        /**
+         * @brief Give up the bias now, for objects that are given to other tasks.
+         * @note Only the owner, with a reference.
+         */
+        void unbias() noexcept {
+            if(is_biased()) merge();
+        }
+
+        /**
+         * @brief Get the count of the references, only exact in the owner task.
+         */
+        int32_t use_count() const noexcept {
+            int32_t _count = m_iShared.load(atomic::memory_order::Relaxed) >> count_shift;
+            return is_biased() ? _count + m_iBiased : _count;
+        }
+
+        /**
+         * @brief Merge all queued objects of the current task.
+         */
+        static void merge_queued() noexcept;
+    protected:
+        /**
+         * @brief Destroy the object, when the last reference is released.
+         */
+        virtual void destroy() noexcept { delete this; }
+    private:
+        enum {
+            flag_merged = 1,    /*!< the owner has merged the biased count */
+            flag_queued = 2,    /*!< in the merge queue of the owner */
+            count_shift = 2
+        };
+
+        bool is_biased() const noexcept {
+            return m_pOwner == arch::arch_get_current_task() && m_pOwner != nullptr &&
+                   (m_iShared.load(atomic::memory_order::Relaxed) & flag_merged) == 0;
+        }
+
+        /**
+         * @brief Merge the biased count in the shared count.
+         * @return true if the object was destroyed.
+         */
+        bool merge() noexcept;
+
+        void release_shared(uint32_t n) noexcept;
+        void merge_from_queue() noexcept;
+    private:
+        void* const m_pOwner;
+        int32_t m_iBiased;
+        /** (count << count_shift) | flags, the count can be negative before the merge */
+        atomic::basic_atomic_gcc<int32_t> m_iShared;
+        merge_node m_node;
+    };
+
+    /**
+     * @brief A smart pointer to a object with a intrusive reference count (ref_counted).
+     *
+     * @tparam T The type of the object, derived from ref_counted.
+     */
+    template <typename T>
+    class intrusive_ptr {
+    public:
+        using value_type = T;
+        using element_type = T;
+        using reference = T&;
+        using pointer = T*;
+        using self_type = intrusive_ptr<T>;
+
+        constexpr intrusive_ptr() noexcept : m_ptr(nullptr) { }
+
+        /**
+         * @param ptr The object.
+         * @param add_ref When false then adopt a reference, like from detach.
+         */
+        intrusive_ptr(pointer ptr, bool add_ref = true) noexcept : m_ptr(ptr) {
+            if(m_ptr != nullptr && add_ref) m_ptr->retain();
+        }
+
+        intrusive_ptr(const self_type& other) noexcept : m_ptr(other.m_ptr) {
+            if(m_ptr != nullptr) m_ptr->retain();
+        }
+
+        template <typename U>
+        intrusive_ptr(const intrusive_ptr<U>& other) noexcept : m_ptr(other.get()) {
+            if(m_ptr != nullptr) m_ptr->retain();
+        }
+
+        intrusive_ptr(self_type&& other) noexcept : m_ptr(other.m_ptr) {
+            other.m_ptr = nullptr;
+        }
+
+        ~intrusive_ptr() {
+            if(m_ptr != nullptr) m_ptr->release();
+        }
+
+        self_type& operator = (const self_type& other) noexcept {
+            self_type(other).swap(*this);
+            return *this;
+        }
+
+        self_type& operator = (self_type&& other) noexcept {
+            self_type(squads::move(other)).swap(*this);
+            return *this;
+        }
+
+        self_type& operator = (pointer ptr) noexcept {
+            self_type(ptr).swap(*this);
+            return *this;
+        }
+
+        void reset(pointer ptr = nullptr) noexcept {
+            self_type(ptr).swap(*this);
+        }
+
+        /**
+         * @brief Give up the reference without release, for containers of raw pointers.
+         */
+        pointer detach() noexcept {
+            pointer _ptr = m_ptr;
+            m_ptr = nullptr;
+            return _ptr;
+        }
+
+        void swap(self_type& other) noexcept {
+            squads::swap<pointer>(m_ptr, other.m_ptr);
+        }
+
+        pointer get() const noexcept            { return m_ptr; }
+
+        reference operator * () const {
+            assert(m_ptr != nullptr);
+            return *m_ptr;
+        }
+        pointer operator -> () const {
+            assert(m_ptr != nullptr);
+            return m_ptr;
+        }
+
+        explicit operator bool() const noexcept { return m_ptr != nullptr; }
+    private:
+        pointer m_ptr;
+    };
+
+    template <typename T, typename U>
+    bool operator == (const intrusive_ptr<T>& a, const intrusive_ptr<U>& b) { return a.get() == b.get(); }
+
+    template <typename T, typename U>
+    bool operator != (const intrusive_ptr<T>& a, const intrusive_ptr<U>& b) { return a.get() != b.get(); }
+
+    /**
+     * @brief Retain all objects of a range of raw pointers, runs of the same object
+     * are retained with one add.
+     */
+    template <typename TIT>
+    void retain_all(TIT first, TIT last) {
+        while(first != last) {
+            auto _ptr = *first;
+            uint32_t _count = 0;
+
+            for(; first != last && *first == _ptr; ++first) _count++;
+            if(_ptr != nullptr) _ptr->retain(_count);
+        }
+    }
+
+    /**
+     * @brief Release all objects of a range of raw pointers, runs of the same object
+     * are released with one sub.
+     */
+    template <typename TIT>
+    void release_all(TIT first, TIT last) {
+        while(first != last) {
+            auto _ptr = *first;
+            uint32_t _count = 0;
+
+            for(; first != last && *first == _ptr; ++first) _count++;
+            if(_ptr != nullptr) _ptr->release(_count);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,509 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_JOB_SCHEDULER_H__
+#define __SQUADS_JOB_SCHEDULER_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "timestamp.hpp"
+#include "timespan.hpp"
+#include "deadline.hpp"
+#include "mutex.hpp"
+#include "autolock.hpp"
+#include "task.hpp"
+
+namespace squads {
+    /**
+     * @brief Interface for a job, that run in the job scheduler.
+     * All of your jobs should be derived from the basic_job class.
+     * Then implement the virtual on_run function.
+     *
+     * @ingroup task
+     */
+    class basic_job {
+    public:
+        virtual ~basic_job() { }
+
+        /**
+         * @brief Implementation of your actual job code.
+         * Called on the worker task, when the job is the earliest deadline.
+         */
+        virtual void on_run() = 0;
+
+        /**
+         * @brief Called when the job was cancelled before it run.
+         * It is optional whether you implement this or not.
+         */
+        virtual void on_cancel() { }
+    };
+
+    /**
+     * @brief A handle of a pending job in a basic_job_scheduler,
+     * use for cancel or reschedule the job.
+     * @note The generation detects a stale handle of an already run job.
+     */
+    struct job_handle {
+        uint32_t slot;
+        uint32_t generation;
+
+        job_handle() : slot(UINT32_MAX), generation(0) { }
+        job_handle(uint32_t _slot, uint32_t _gen) : slot(_slot), generation(_gen) { }
+
+        /**
+         * @brief Is the handle valid (was the job submitted)?
+         */
+        bool is_valid() const { return slot != UINT32_MAX; }
+    };
+
+    /**
+     * @brief Earliest deadline first (EDF) job scheduler.
+     *
+     * The pending jobs are hold in a indexed d-ary min heap, so the earliest deadline
+     * is in O(1) and submit, pop, cancel and reschedule are O(log n). All slots are
+     * preallocated, the scheduler allocates nothing after construction.
+     *
+     * For aging the scheduling key of a job is the minimum of his deadline and the
+     * submit time plus the aging limit. A job with a far deadline can therefore not
+     * wait longer then the aging limit behind newer, more urgent jobs.
+     *
+     * The deadlines and the submit times are kept in ticks, like basic_deadline, so
+     * a change of the wall clock don't reorder the pending jobs. The keys are compared
+     * with the wrap of the tick count, the deadlines must be less then 2^31 ticks away.
+     *
+     * @tparam TMAXJOBS The maximal number of pending jobs.
+     * @tparam TARITY The number of children per heap node.
+     * @tparam TLOCK The lock type for protect the heap.
+     *
+     * @ingroup task
+     */
+    template <size_t TMAXJOBS = SQUADS_CONFIG_JOBSCHEDULER_MAXJOBS,
+              size_t TARITY = SQUADS_CONFIG_JOBSCHEDULER_ARITY,
+              class TLOCK = mutex>
+    class basic_job_scheduler {
+        static_assert(TARITY >= 2, "the heap arity must be at least 2");
+        static_assert(TMAXJOBS > 0 && TMAXJOBS < UINT32_MAX, "invalid job count");
+    public:
+        using self_type = basic_job_scheduler<TMAXJOBS, TARITY, TLOCK>;
+        using lock_type = TLOCK;
+        using tick_type = basic_deadline::tick_type;
+        using size_type = size_t;
+        using handle_type = job_handle;
+
+        static constexpr size_type max_jobs = TMAXJOBS;
+        static constexpr size_type arity = TARITY;
+
+        /**
+         * @brief Construct the scheduler with the default aging limit
+         * SQUADS_CONFIG_JOBSCHEDULER_AGING_LIMIT
+         */
+        basic_job_scheduler()
+            : m_lockObject(), m_uiSize(0), m_uiFree(0), m_uiSequence(0),
+              m_uiAgingLimit(basic_deadline::ticks_from_us(SQUADS_CONFIG_JOBSCHEDULER_AGING_LIMIT)) {
+
+            for(size_type i = 0; i < TMAXJOBS; i++) {
+                m_aSlots[i].job = nullptr;
+                m_aSlots[i].generation = 0;
+                m_aSlots[i].position = i + 1; // next free slot
+            }
+        }
+
+        basic_job_scheduler(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Submit a job with a deadline.
+         * @param job The job to run.
+         * @param deadline The deadline of the job, a infinite deadline runs after the aging limit.
+         * @return The handle of the job, not valid when the scheduler is full.
+         */
+        handle_type submit(basic_job* job, const basic_deadline& deadline) {
+            if(job == nullptr) return handle_type();
+
+            tick_type _now = arch::arch_get_ticks();
+            autolock<lock_type> lock(m_lockObject);
+
+            if(m_uiFree >= TMAXJOBS) return handle_type();
+
+            size_type _slot = m_uiFree;
+            job_slot& _entry = m_aSlots[_slot];
+            m_uiFree = _entry.position;
+
+            _entry.job = job;
+            _entry.deadline = deadline;
+            _entry.submitted = _now;
+            _entry.key = effective_key(_entry.deadline, _entry.submitted);
+            _entry.sequence = m_uiSequence++;
+
+            _entry.position = m_uiSize;
+            m_aHeap[m_uiSize++] = _slot;
+            sift_up(_entry.position);
+
+            return handle_type(_slot, _entry.generation);
+        }
+
+        /**
+         * @brief Submit a job with a absolute deadline.
+         * @note The wall clock time is converted to ticks once, on submit.
+         */
+        handle_type submit(basic_job* job, const basic_timestamp& deadline) {
+            return submit(job, basic_deadline(deadline));
+        }
+
+        /**
+         * @brief Submit a job with a deadline relative to now.
+         * @param job The job to run.
+         * @param relative The deadline relative to the current time.
+         * @return The handle of the job, not valid when the scheduler is full.
+         */
+        handle_type submit(basic_job* job, const basic_timespan& relative) {
+            return submit(job, basic_deadline(relative));
+        }
+
+        /**
+         * @brief Cancel a pending job.
+         * @param handle The handle of the job, from submit.
+         * @return true if the job was removed and false if it was not pending.
+         * @note Calls basic_job::on_cancel of the removed job.
+         */
+        bool cancel(const handle_type& handle) {
+            basic_job* _job = nullptr;
+            {
+                autolock<lock_type> lock(m_lockObject);
+
+                if(!is_pending(handle)) return false;
+
+                _job = m_aSlots[handle.slot].job;
+                remove_at(m_aSlots[handle.slot].position);
+                release_slot(handle.slot);
+            }
+            _job->on_cancel();
+            return true;
+        }
+
+        /**
+         * @brief Change the deadline of a pending job.
+         * @param handle The handle of the job, from submit.
+         * @param deadline The new deadline.
+         * @return true if the job was rescheduled and false if it was not pending.
+         * @note The submit time (and with it the aging) is not changed.
+         */
+        bool reschedule(const handle_type& handle, const basic_deadline& deadline) {
+            autolock<lock_type> lock(m_lockObject);
+
+            if(!is_pending(handle)) return false;
+
+            job_slot& _entry = m_aSlots[handle.slot];
+            tick_type _old = _entry.key;
+
+            _entry.deadline = deadline;
+            _entry.key = effective_key(_entry.deadline, _entry.submitted);
+
+            if(int32_t(_entry.key - _old) < 0) sift_up(_entry.position);
+            else sift_down(_entry.position);
+
+            return true;
+        }
+
+        /**
+         * @brief Change the deadline of a pending job to a absolute time.
+         * @note The wall clock time is converted to ticks once.
+         */
+        bool reschedule(const handle_type& handle, const basic_timestamp& deadline) {
+            return reschedule(handle, basic_deadline(deadline));
+        }
+
+        /**
+         * @brief Remove the job with the earliest (aged) deadline.
+         * @param deadline When not null, get the deadline of the job.
+         * @return The job or nullptr when no job is pending.
+         */
+        basic_job* pop(basic_deadline* deadline = nullptr) {
+            autolock<lock_type> lock(m_lockObject);
+
+            if(m_uiSize == 0) return nullptr;
+
+            size_type _slot = m_aHeap[0];
+            basic_job* _job = m_aSlots[_slot].job;
+
+            if(deadline != nullptr)
+                *deadline = m_aSlots[_slot].deadline;
+
+            remove_at(0);
+            release_slot(_slot);
+
+            return _job;
+        }
+
+        /**
+         * @brief Get the deadline of the next job, without remove it.
+         * @param deadline Get the deadline.
+         * @return true when a job is pending and false if not.
+         */
+        bool peek(basic_deadline& deadline) {
+            autolock<lock_type> lock(m_lockObject);
+
+            if(m_uiSize == 0) return false;
+
+            deadline = m_aSlots[m_aHeap[0]].deadline;
+            return true;
+        }
+
+        /**
+         * @brief Set the aging limit for new submitted jobs.
+         * @param limit The maximal time a job waits for run, independent of his deadline.
+         */
+        void set_aging_limit(const basic_timespan& limit) {
+            autolock<lock_type> lock(m_lockObject);
+            m_uiAgingLimit = basic_deadline::ticks_from_us(limit.get_total_microseconds());
+        }
+
+        /**
+         * @brief Get the number of pending jobs.
+         */
+        size_type size() {
+            autolock<lock_type> lock(m_lockObject);
+            return m_uiSize;
+        }
+
+        bool empty()    { return size() == 0; }
+        bool is_full()  { return size() == TMAXJOBS; }
+    private:
+        struct job_slot {
+            basic_job* job;
+            basic_deadline deadline;
+            tick_type  submitted;
+            tick_type  key;
+            uint32_t   sequence;
+            uint32_t   generation;
+            /**
+             * The position in the heap, or the next free slot when not used.
+             */
+            size_type  position;
+        };
+
+        tick_type effective_key(const basic_deadline& deadline, tick_type submitted) const {
+            tick_type _aged = submitted + m_uiAgingLimit;
+            if(deadline.is_infinite()) return _aged;
+
+            tick_type _expire = deadline.get_expire_tick();
+            return (int32_t(_aged - _expire) < 0) ? _aged : _expire;
+        }
+
+        bool is_pending(const handle_type& handle) const {
+            if(handle.slot >= TMAXJOBS) return false;
+
+            const job_slot& _entry = m_aSlots[handle.slot];
+            return _entry.job != nullptr && _entry.generation == handle.generation;
+        }
+
+        void release_slot(size_type slot) {
+            job_slot& _entry = m_aSlots[slot];
+
+            _entry.job = nullptr;
+            _entry.generation++;
+            _entry.position = m_uiFree;
+            m_uiFree = slot;
+        }
+
+        /**
+         * @brief Compare two heap entries, with the submit order as tie breaker.
+         */
+        bool is_before(size_type a, size_type b) const {
+            const job_slot& _a = m_aSlots[a];
+            const job_slot& _b = m_aSlots[b];
+
+            if(_a.key != _b.key) return int32_t(_a.key - _b.key) < 0;
+            return int32_t(_a.sequence - _b.sequence) < 0;
+        }
+
+        void place(size_type pos, size_type slot) {
+            m_aHeap[pos] = slot;
+            m_aSlots[slot].position = pos;
+        }
+
+        void sift_up(size_type pos) {
+            size_type _slot = m_aHeap[pos];
+
+            while(pos > 0) {
+                size_type _parent = (pos - 1) / TARITY;
+                if(!is_before(_slot, m_aHeap[_parent])) break;
+
+                place(pos, m_aHeap[_parent]);
+                pos = _parent;
+            }
+            place(pos, _slot);
+        }
+
+        void sift_down(size_type pos) {
+            size_type _slot = m_aHeap[pos];
+
+            for(;;) {
+                size_type _first = pos * TARITY + 1;
+                if(_first >= m_uiSize) break;
+
+                size_type _last = _first + TARITY;
+                if(_last > m_uiSize) _last = m_uiSize;
+
+                size_type _min = _first;
+                for(size_type i = _first + 1; i < _last; i++) {
+                    if(is_before(m_aHeap[i], m_aHeap[_min])) _min = i;
+                }
+                if(!is_before(m_aHeap[_min], _slot)) break;
+
+                place(pos, m_aHeap[_min]);
+                pos = _min;
+            }
+            place(pos, _slot);
+        }
+
+        void remove_at(size_type pos) {
+            size_type _last = --m_uiSize;
+            if(pos == _last) return;
+
+            place(pos, m_aHeap[_last]);
+
+            if(pos > 0 && is_before(m_aHeap[pos], m_aHeap[(pos - 1) / TARITY]))
+                sift_up(pos);
+            else
+                sift_down(pos);
+        }
+    private:
+        lock_type m_lockObject;
+        job_slot  m_aSlots[TMAXJOBS];
+        size_type m_aHeap[TMAXJOBS];
+        size_type m_uiSize;
+        size_type m_uiFree;
+        uint32_t  m_uiSequence;
+        tick_type m_uiAgingLimit;
+    };
+
+    /**
+     * @brief A work queue task, that run the jobs of a basic_job_scheduler
+     * in earliest deadline first order.
+     *
+     * @code
+     * class reply_job : public basic_job {
+     * public:
+     *     virtual void on_run() override { send_reply(); }
+     * };
+     *
+     * job_workqueue wq;
+     * reply_job job;
+     *
+     * wq.start(SQUADS_CONFIG_DEFAULT_WORKQUEUE_CORE);
+     * // run the job at least in 5 ms
+     * wq.submit(&job, timespan_t(5000));
+     * @endcode
+     *
+     * @ingroup task
+     */
+    template <size_t TMAXJOBS = SQUADS_CONFIG_JOBSCHEDULER_MAXJOBS,
+              size_t TARITY = SQUADS_CONFIG_JOBSCHEDULER_ARITY>
+    class basic_job_workqueue : public task {
+    public:
+        using base_type = task;
+        using self_type = basic_job_workqueue<TMAXJOBS, TARITY>;
+        using scheduler_type = basic_job_scheduler<TMAXJOBS, TARITY, mutex>;
+        using handle_type = typename scheduler_type::handle_type;
+
+        /**
+         * @brief Construct the work queue task.
+         * @param strName Name of the work queue task. Only useful for debugging.
+         * @param uiPriority The priority of the work queue task
+         * @param usStackDepth Number of "words" allocated for the task stack.
+         */
+        explicit basic_job_workqueue(const char* strName = "job_wq",
+            priority uiPriority = (priority)SQUADS_CONFIG_WORKQUEUE_SINGLE_PRIORITY,
+            unsigned short usStackDepth = SQUADS_CONFIG_WORKQUEUE_SINGLE_STACKSIZE) noexcept
+            : base_type(strName, uiPriority, usStackDepth), m_scheduler(), m_bQuit(false) { }
+
+        /**
+         * @brief Submit a job with a deadline and wake up the worker.
+         */
+        handle_type submit(basic_job* job, const basic_deadline& deadline) {
+            handle_type _handle = m_scheduler.submit(job, deadline);
+            if(_handle.is_valid()) wakeup();
+            return _handle;
+        }
+
+        /**
+         * @brief Submit a job with a absolute deadline and wake up the worker.
+         */
+        handle_type submit(basic_job* job, const basic_timestamp& deadline) {
+            handle_type _handle = m_scheduler.submit(job, deadline);
+            if(_handle.is_valid()) wakeup();
+            return _handle;
+        }
+
+        /**
+         * @brief Submit a job with a deadline relative to now and wake up the worker.
+         */
+        handle_type submit(basic_job* job, const basic_timespan& relative) {
+            handle_type _handle = m_scheduler.submit(job, relative);
+            if(_handle.is_valid()) wakeup();
+            return _handle;
+        }
+
+        bool cancel(const handle_type& handle) {
+            return m_scheduler.cancel(handle);
+        }
+
+        bool reschedule(const handle_type& handle, const basic_deadline& deadline) {
+            return m_scheduler.reschedule(handle, deadline);
+        }
+
+        bool reschedule(const handle_type& handle, const basic_timestamp& deadline) {
+            return m_scheduler.reschedule(handle, deadline);
+        }
+
+        /**
+         * @brief Stop the worker loop, after the current job.
+         */
+        void quit() {
+            m_bQuit = true;
+            wakeup();
+        }
+
+        scheduler_type& get_scheduler() { return m_scheduler; }
+    protected:
+        virtual int on_task() override {
+            while(!m_bQuit) {
+                basic_job* _job = m_scheduler.pop();
+
+                if(_job == nullptr) {
+                    task::notify_take(true, SQUADS_CONFIG_WORKQUEUE_GETNEXTITEM_TIMEOUT);
+                    continue;
+                }
+                _job->on_run();
+            }
+            return 0;
+        }
+    private:
+        void wakeup() {
+            if(is_running()) task::notify_give(this);
+        }
+    private:
+        scheduler_type m_scheduler;
+        volatile bool  m_bQuit;
+    };
+
+    using job_scheduler = basic_job_scheduler<>;
+    using job_workqueue = basic_job_workqueue<>;
+}
+
+#endif
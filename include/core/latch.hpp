@@ -20,13 +20,19 @@
 
 
 #include "algorithm.hpp"
-#include "atomic/atomic.hpp"
+#include "deadline.hpp"
+#include "parking_lot.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
 
 namespace squads {
 
+    /**
+     * @brief A single use count down latch, the waiters park in the parking lot
+     * on the address of the counter.
+     */
     class latch {
     public:
-        static constexpr ptrdiff_t max() { return UINT64_MAX; }
+        static constexpr ptrdiff_t max() { return 0x7FFFFFFF; }
 
         constexpr explicit latch(ptrdiff_t expected) : m_val(expected) { }
 
@@ -34,30 +40,45 @@ namespace squads {
         latch(const latch&) = delete;
         latch& operator=(const latch&) = delete;
 
-        inline void  count_down(ptrdiff_t i = 1, unsigned int timeout) {
+        /**
+         * @brief Count down, the last count down wakes up all waiters.
+         */
+        inline void  count_down(ptrdiff_t i = 1) {
             auto const temp = m_val.fetch_sub(i, atomic::memory_order::Release);
             if (temp == i)
-                m_val.notify_all(timeout);
+                parking_lot::unpark_all(&m_val);
         }
 
         bool try_wait() const {
             return m_val.load(atomic::memory_order::Acquire) == 0;
         }
-        void wait(unsigned int timeout) const noexcept  {
-            auto const pred = [this] { return this->try_wait(); };
-            auto& s = atomic::atomic_long::waitstate_type::for_address((void*)&m_val);
-            
-            s.wait(pred, timeout);
+
+        /**
+         * @brief Wait until the counter is zero.
+         * @param timeout How long to wait in ticks.
+         * @return 0 when the counter is zero and 1 on timeout.
+         */
+        int wait(unsigned int timeout = SQUADS_PORTMAX_DELAY) const noexcept  {
+            basic_deadline _dl = basic_deadline::from_ticks(timeout);
+
+            while(!try_wait()) {
+                auto const pred = [this] { return !this->try_wait(); };
+
+                if(parking_lot::park(&m_val, pred, _dl.remaining_ticks()) == parking_lot::park_timeout)
+                    return try_wait() ? 0 : 1;
+            }
+            return 0;
         }
-        void arrive_and_wait(ptrdiff_t up = 1, unsigned int timeout) {
-            count_down(up, timeout);
-            wait(timeout);
+
+        int arrive_and_wait(ptrdiff_t up = 1, unsigned int timeout = SQUADS_PORTMAX_DELAY) {
+            count_down(up);
+            return wait(timeout);
         }
     private:
-         atomic::atomic_long m_val;
+         atomic::basic_atomic_gcc<ptrdiff_t> m_val;
 
     };
 
 }
 
-#endif
\ No newline at end of file
+#endif
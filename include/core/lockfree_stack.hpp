@@ -0,0 +1,156 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_LOCKFREE_STACK_H__
+#define __SQUADS_LOCKFREE_STACK_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "atomic/tagged_ptr.hpp"
+
+namespace squads {
+    /**
+     * @brief A intrusive lock free stack (Treiber stack) with ABA safe tagged head.
+     *
+     * The nodes are linked with a member next. A pop reads the next of the top
+     * node, before the compare exchange of the head: the node can be popped and
+     * pushed again by a other task between, the version of the head detects this.
+     *
+     * @code
+     * struct job { job* next; int id; };
+     * lockfree_stack<job> g_jobs;
+     *
+     * g_jobs.push(j);
+     * job* n = g_jobs.pop();
+     * @endcode
+     *
+     * @note A popped node can be read by a other pop, so the memory of the nodes
+     * must stay readable (like the blocks of a pool). For nodes, that are given
+     * back to the heap, use a memory::hazard_domain.
+     *
+     * @tparam TNODE The type of the nodes, with a member TNODE* next.
+     *
+     * @ingroup base
+     */
+    template <class TNODE>
+    class basic_lockfree_stack {
+    public:
+        using self_type = basic_lockfree_stack<TNODE>;
+        using node_type = TNODE;
+        using head_type = atomic::basic_atomic_tagged_ptr<node_type>;
+        using tagged_type = typename head_type::value_type;
+
+        basic_lockfree_stack() : m_head(nullptr) { }
+
+        basic_lockfree_stack(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Push a node.
+         */
+        void push(node_type* node) {
+            push_chain(node, node);
+        }
+
+        /**
+         * @brief Push a chain of nodes, linked with next, with one compare exchange.
+         * @param first The first node of the chain, the new top.
+         * @param last The last node of the chain.
+         */
+        void push_chain(node_type* first, node_type* last) {
+            tagged_type _top = m_head.load(atomic::memory_order::Relaxed);
+
+            do {
+                last->next = _top.ptr;
+            } while(!m_head.compare_exchange_weak(_top, first, atomic::memory_order::Release));
+        }
+
+        /**
+         * @brief Pop the top node.
+         * @return The node or nullptr when the stack is empty.
+         */
+        node_type* pop() {
+            tagged_type _top = m_head.load(atomic::memory_order::Acquire);
+
+            for(;;) {
+                if(_top.ptr == nullptr) return nullptr;
+
+                if(m_head.compare_exchange_weak(_top, _top.ptr->next, atomic::memory_order::Acquire))
+                    return _top.ptr;
+            }
+        }
+
+        /**
+         * @brief Pop a chain of max nodes, node by node.
+         *
+         * The nodes below the top can't be walked before the compare exchange: they
+         * can be popped and reused (the next overwritten) by a other task between.
+         * So each node is popped with a own compare exchange. Unlike pop_all and
+         * push back the rest, other tasks never see a empty stack, when nodes left.
+         *
+         * @param max The max count of nodes.
+         * @param count The count of the popped nodes.
+         * @return The first node of the chain, linked with next and nullptr terminated.
+         */
+        node_type* pop_chain(size_t max, size_t& count) {
+            node_type* _first = nullptr;
+            node_type* _last = nullptr;
+
+            for(count = 0; count < max; count++) {
+                node_type* _node = pop();
+                if(_node == nullptr) break;
+
+                if(_last != nullptr) _last->next = _node;
+                else _first = _node;
+                _last = _node;
+            }
+            if(_last != nullptr) _last->next = nullptr;
+
+            return _first;
+        }
+
+        /**
+         * @brief Pop all nodes.
+         * @return The first node of the chain, linked with next.
+         */
+        node_type* pop_all() {
+            return m_head.exchange(nullptr, atomic::memory_order::Acquire).ptr;
+        }
+
+        /**
+         * @brief Is the stack empty?
+         * @note Only a snapshot.
+         */
+        bool empty() const {
+            return m_head.load(atomic::memory_order::Relaxed).ptr == nullptr;
+        }
+
+        /**
+         * @brief Is the stack lock free, false when the tagged head uses the atomic lock table.
+         */
+        bool is_lock_free() const {
+            return m_head.is_lock_free();
+        }
+    private:
+        head_type m_head;
+    };
+
+    template <class TNODE>
+    using lockfree_stack = basic_lockfree_stack<TNODE>;
+}
+
+#endif
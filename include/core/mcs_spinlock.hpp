@@ -0,0 +1,148 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_MCS_SPINLOCK_H__
+#define __SQUADS_MCS_SPINLOCK_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "backoff.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    /**
+     * @brief The queue node of a mcs spinlock, on the stack of the locker.
+     * Each node is on a own cache line, so each waiter spins on his own line.
+     */
+    struct alignas(SQUADS_CONFIG_CACHE_LINE_SIZE) mcs_node {
+        atomic::basic_atomic_gcc<mcs_node*> next;
+        atomic::basic_atomic_gcc<uint32_t> locked;
+
+        mcs_node() : next(nullptr), locked(0) { }
+
+        mcs_node(const mcs_node&) = delete;
+        mcs_node& operator = (const mcs_node&) = delete;
+    };
+
+    /**
+     * @brief A fair (FIFO) MCS queue spinlock.
+     *
+     * The waiters build a queue of mcs_node, each waiter spins only on the flag of
+     * his own node and the owner hands the lock to the next node on unlock. So
+     * no cache line is shared between all waiters.
+     *
+     * @code
+     * mcs_spinlock lock;
+     *
+     * {
+     *     mcs_spinlock::guard g(lock);
+     *     // locked
+     * }
+     * @endcode
+     *
+     * @tparam TBACKOFF The backoff policy of the spin loop.
+     *
+     * @ingroup lock
+     */
+    template <class TBACKOFF = pause_backoff>
+    class basic_mcs_spinlock {
+    public:
+        using self_type = basic_mcs_spinlock<TBACKOFF>;
+        using backoff_type = TBACKOFF;
+        using node_type = mcs_node;
+
+        /**
+         * @brief RAII lock with a node on the stack.
+         */
+        class guard {
+        public:
+            explicit guard(self_type& lock) : m_refLock(lock), m_node() { m_refLock.lock(m_node); }
+            ~guard() { m_refLock.unlock(m_node); }
+
+            guard(const guard&) = delete;
+            guard& operator = (const guard&) = delete;
+        private:
+            self_type& m_refLock;
+            node_type m_node;
+        };
+
+        basic_mcs_spinlock() : m_pTail(nullptr) { }
+
+        basic_mcs_spinlock(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Lock the spinlock.
+         * @param node The node of this lock, must live until unlock.
+         */
+        void lock(node_type& node) {
+            node.next.store(nullptr, atomic::memory_order::Relaxed);
+            node.locked.store(1, atomic::memory_order::Relaxed);
+
+            node_type* _prev = m_pTail.exchange(&node, atomic::memory_order::AcqRel);
+            if(_prev == nullptr) return;
+
+            _prev->next.store(&node, atomic::memory_order::Release);
+
+            backoff_type _backoff;
+            while(node.locked.load(atomic::memory_order::Acquire) != 0)
+                _backoff.pause();
+        }
+
+        /**
+         * @brief Try to lock the spinlock, without waiting.
+         * @param node The node of this lock, must live until unlock.
+         * @return true if the lock was acquired.
+         */
+        bool try_lock(node_type& node) {
+            node.next.store(nullptr, atomic::memory_order::Relaxed);
+            node.locked.store(0, atomic::memory_order::Relaxed);
+
+            node_type* _expected = nullptr;
+            return m_pTail.compare_exchange_strong(_expected, &node, atomic::memory_order::AcqRel);
+        }
+
+        /**
+         * @brief Unlock the spinlock and hand it to the next waiter.
+         * @param node The node of the lock call.
+         */
+        void unlock(node_type& node) {
+            node_type* _next = node.next.load(atomic::memory_order::Acquire);
+
+            if(_next == nullptr) {
+                node_type* _expected = &node;
+                if(m_pTail.compare_exchange_strong(_expected, nullptr, atomic::memory_order::Release))
+                    return;
+
+                // a new waiter is between the exchange and the link
+                while((_next = node.next.load(atomic::memory_order::Acquire)) == nullptr)
+                    arch::arch_cpu_relax();
+            }
+            _next->locked.store(0, atomic::memory_order::Release);
+        }
+
+        bool is_locked() const {
+            return m_pTail.load(atomic::memory_order::Relaxed) != nullptr;
+        }
+    private:
+        atomic::basic_atomic_gcc<node_type*> m_pTail;
+    };
+
+    using mcs_spinlock = basic_mcs_spinlock<>;
+}
+
+#endif
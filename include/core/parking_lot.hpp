@@ -0,0 +1,109 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_PARKING_LOT_H__
+#define __SQUADS_PARKING_LOT_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "wait_queue.hpp"
+
+namespace squads {
+    /**
+     * @brief A global parking lot: park tasks on any address, like a futex.
+     *
+     * The addresses are hashed into a table of buckets, each bucket is a wait_queue
+     * of intrusive nodes with the address as key. So a task waits on a address
+     * without any wait object in the data, and a unpark wakes only the waiters of
+     * the address.
+     *
+     * @code
+     * // waiter
+     * while(flag.load() == 0)
+     *     parking_lot::park(&flag, [&]() { return flag.load() == 0; });
+     *
+     * // waker
+     * flag.store(1);
+     * parking_lot::unpark_all(&flag);
+     * @endcode
+     *
+     * @note There is no native futex path, on all targets the tasks park with
+     * arch_park/arch_unpark. The host test build (test/host) uses the same code
+     * over its arch layer.
+     */
+    class parking_lot {
+    public:
+        enum {
+            park_woken = 0,     /*!< woken by a unpark */
+            park_timeout = 1,   /*!< the timeout is expired */
+            park_invalid = 2    /*!< the validate function returns false, not parked */
+        };
+
+        /**
+         * @brief Set the count of buckets, call before the first park.
+         * @param buckets The count of buckets, rounded up to a power of two.
+         * @return false when the table was already set or no memory.
+         */
+        static bool init(unsigned int buckets);
+
+        /**
+         * @brief Park the current task on a address.
+         *
+         * @param address The address to wait on.
+         * @param validate Called under the bucket lock before park, the task parks only
+         * when it returns true. Must be short and must not block (like a atomic load).
+         * @param timeout How long to wait in ticks.
+         * @return park_woken, park_timeout or park_invalid.
+         */
+        template <class TVALIDATE>
+        static int park(const volatile void* address, TVALIDATE validate, unsigned int timeout = SQUADS_PORTMAX_DELAY) {
+            wait_queue& _queue = get_queue(address);
+            wait_node _node;
+            _node.key = reinterpret_cast<uintptr_t>(address);
+
+            _queue.lock();
+            if(!validate()) {
+                _queue.unlock();
+                return park_invalid;
+            }
+            _queue.push_back(&_node);
+
+            return _queue.wait(_node, timeout) ? park_woken : park_timeout;
+        }
+
+        /**
+         * @brief Wake up the first task, that is parked on the address.
+         * @return true if a task was woken.
+         */
+        static bool unpark_one(const volatile void* address);
+
+        /**
+         * @brief Wake up all tasks, that are parked on the address.
+         * @return The count of the woken tasks.
+         */
+        static unsigned int unpark_all(const volatile void* address);
+
+        /**
+         * @brief Get the count of buckets.
+         */
+        static unsigned int get_bucket_count();
+    private:
+        static wait_queue& get_queue(const volatile void* address);
+    };
+}
+
+#endif
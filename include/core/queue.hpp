@@ -26,6 +26,8 @@
 #include "type_traits.hpp"
 #include "iterator.hpp"
 
+#include "deadline.hpp"
+#include "cancellation_token.hpp"
 #include "arch/arch_queue_impl.hpp"
 
 namespace squads {
@@ -184,6 +186,34 @@ namespace squads {
            return m_aimplQueue.dequeue(value, timeout) == 0;
 
         }
+
+        /**
+         * @brief Add an item to the back of the queue, wait until the deadline.
+         * @param value The item.
+         * @param dl The deadline, the remaining ticks are computed once.
+         * @param token The optional cancellation token.
+         * @return true if the item was added, false on timeout or when cancelled.
+         */
+        bool            push(const value_type& value, const basic_deadline& dl, cancellation_token* token = nullptr) {
+            cancellation_scope _scope(token);
+            if(_scope.is_cancelled()) return false;
+
+            return m_aimplQueue.enqueue_back(&value, dl.remaining_ticks()) == 0;
+        }
+
+        /**
+         * @brief Remove an item from the front of the queue, wait until the deadline.
+         * @param value Where the item will be returned to.
+         * @param dl The deadline, the remaining ticks are computed once.
+         * @param token The optional cancellation token.
+         * @return true if a item was removed, false on timeout or when cancelled.
+         */
+        bool            pop(value_type* value, const basic_deadline& dl, cancellation_token* token = nullptr) {
+            cancellation_scope _scope(token);
+            if(_scope.is_cancelled()) return false;
+
+            return m_aimplQueue.dequeue(value, dl.remaining_ticks()) == 0;
+        }
         /**
          * @brief Clear the queue
          */
@@ -206,6 +236,15 @@ namespace squads {
             return m_aimplQueue.is_full();
         }
 
+        /**
+         * @brief Set the listener, that is called after each added item.
+         * @param listener The listener or nullptr to remove it.
+         * @param ctx The context for the listener.
+         */
+        void set_listener(typename cointainer_type::listener_type listener, void* ctx) {
+            m_aimplQueue.set_listener(listener, ctx);
+        }
+
 		void            swap(self_type& x) {
             m_aimplQueue.swap(x.m_aimplQueue);
         }
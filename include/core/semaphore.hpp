@@ -24,7 +24,12 @@
 #include "algorithm.hpp"
 
 #include "autolock.hpp"
+#include "deadline.hpp"
+#include "cancellation_token.hpp"
+#include "wait_queue.hpp"
+#include "parking_lot.hpp"
 #include "atomic/atomic.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
 
 namespace squads {
 
@@ -33,78 +38,226 @@ namespace squads {
         using self_type = basic_binary_semaphore;
         using base_type = basic_lock;
 
+        using base_type::lock;
+
         basic_binary_semaphore();
         basic_binary_semaphore (const self_type&) = delete;
         basic_binary_semaphore (const self_type&&) = delete;
 
-        int lock(unsigned int timeout = 0) noexcept override;
+        /**
+         * @brief Lock the semaphore, parks in the parking lot on contention.
+         * @param timeout How long to wait in ticks.
+         * @return 0 on success and 1 on timeout.
+         */
+        int lock(unsigned int timeout = SQUADS_PORTMAX_DELAY) noexcept override;
         bool try_lock() noexcept override;
 
-        int time_lock(const struct timespec *timeout) noexcept { return 1; }
         int unlock() noexcept override;
 
         bool is_initialized() const override { return true; }
-        bool is_locked() const override { return m_bLock.load(); }
+        bool is_locked() const override { return m_uiState.load(atomic::memory_order::Relaxed) != unlocked; }
 
         void operator = (const self_type&) = delete;
         void operator = (const self_type&&) = delete;
 
     private:
-        atomic::atomic_bool m_bLock;
+        enum : uint32_t {
+            unlocked = 0,
+            locked = 1,
+            contended = 2   /*!< locked, tasks are parked on the state */
+        };
+        atomic::basic_atomic_gcc<uint32_t> m_uiState;
     };    
 
+    /**
+     * @brief A counting semaphore with TMAXCOUNT permits, for resource limits.
+     *
+     * The free permits are a atomic counter, acquire and release without waiters are one
+     * atomic operation. When not enough permits are free, the task parks in a FIFO queue.
+     * A release hands the permits direct to the waiters in order, so a waiter for many
+     * permits is not starved by waiters for few.
+     *
+     * @code
+     * counting_semaphore<8> dma_buffers;
+     *
+     * if(dma_buffers.acquire(2, 100) == 0) {
+     *     ...
+     *     dma_buffers.release(2);
+     * }
+     * @endcode
+     *
+     * @tparam TMAXCOUNT The count of permits.
+     * @tparam TLOCK Not used, for compatibility.
+     */
     template <size_t TMAXCOUNT, typename TLOCK = basic_binary_semaphore>
     class basic_counting_semaphore : public basic_lock {
     public:
         using self_type = basic_counting_semaphore<TMAXCOUNT, TLOCK>;
         using base_type = basic_lock;
 
+        using base_type::lock;
+
         constexpr size_t max_count() { return TMAXCOUNT; }
 
-        basic_counting_semaphore()  :  m_iCount(0) { }
+        /**
+         * @brief Create the semaphore.
+         * @param initial The count of free permits at start.
+         */
+        explicit basic_counting_semaphore(size_t initial = TMAXCOUNT)
+            : m_iFree((initial > TMAXCOUNT) ? TMAXCOUNT : initial), m_uiWaiters(0), m_queue() { }
         basic_counting_semaphore (const self_type&) = delete;
         basic_counting_semaphore (const self_type&&) = delete;
 
-        int lock(unsigned int timeout = 0) noexcept override {
-             if(m_iCount >= TMAXCOUNT) return 1;
+        /**
+         * @brief Acquire one permit.
+         * @param timeout How long to wait in ticks.
+         * @return 0 on success and 1 on timeout.
+         */
+        int lock(unsigned int timeout = SQUADS_PORTMAX_DELAY) noexcept override {
+            return acquire(1, timeout);
+        }
+        bool try_lock() noexcept override {
+            return try_acquire(1);
+        }
+        /**
+         * @brief Release one permit.
+         * @return 0 on success and 1 when all permits are free.
+         */
+        int unlock() noexcept override {
+            return release(1);
+        }
+
+        /**
+         * @brief Acquire n permits, all or none.
+         * @param n The count of permits.
+         * @param timeout How long to wait in ticks.
+         * @return 0 on success and 1 on timeout or when n greater than TMAXCOUNT.
+         */
+        int acquire(size_t n, unsigned int timeout = SQUADS_PORTMAX_DELAY) noexcept {
+            if(n > TMAXCOUNT) return 1;
+            if(try_acquire(n)) return 0;
+            if(timeout == 0) return 1;
 
-            if(m_iCount > 0) {
-                m_iCount++; 
-            } else if(m_refLockRefObject.lock(timeout) == 0) {
-                m_iCount++;  }
+            wait_node _node;
+            _node.data = n;
 
-            return 0;
+            m_queue.lock();
+            m_uiWaiters.fetch_add(1, atomic::memory_order::SeqCst);
 
+            if(m_queue.empty() && take(n)) {
+                m_uiWaiters.fetch_sub(1, atomic::memory_order::Relaxed);
+                m_queue.unlock();
+                return 0;
+            }
+            m_queue.push_back(&_node);
+
+            // the permits are handed over on wake up
+            if(m_queue.wait(_node, timeout)) return 0;
+
+            // timeout, waiters behind can be served now
+            m_queue.lock();
+            m_uiWaiters.fetch_sub(1, atomic::memory_order::Relaxed);
+            wait_node* _woken = dispatch();
+            m_queue.unlock();
+
+            unpark_all(_woken);
+            return 1;
         }
-        bool try_lock() noexcept override { 
-            if(m_refLockRefObject.try_lock() ) { m_iCount++; return true; } 
-            else return false; 
+
+        /**
+         * @brief Acquire n permits until the deadline.
+         * @return 0 on success, 1 on timeout and SQUADS_RESULT_CANCELLED when cancelled.
+         */
+        int acquire(size_t n, const basic_deadline& dl, cancellation_token* token = nullptr) noexcept {
+            cancellation_scope _scope(token);
+            if(_scope.is_cancelled()) return SQUADS_RESULT_CANCELLED;
+
+            return (acquire(n, dl.remaining_ticks()) == 0) ? 0 : _scope.failed_result();
         }
 
-        int time_lock(const struct timespec *timeout) noexcept { return 1; }
-        int unlock() noexcept override {
-            int lock_ret = 0;
+        /**
+         * @brief Try to acquire n permits without waiting, fails when tasks wait.
+         * @return true if the permits was acquired.
+         */
+        bool try_acquire(size_t n) noexcept {
+            if(m_uiWaiters.load(atomic::memory_order::SeqCst) != 0) return false;
+            return take(n);
+        }
 
-            if(m_iCount > 0) {
-                m_iCount--;
-                if(m_iCount == 0) {
-                    lock_ret = m_refLockRefObject.unlock();
-                }
+        /**
+         * @brief Release n permits and wake up the waiters, that can be served.
+         * @return 0 on success and 1 when more then TMAXCOUNT permits would be free.
+         */
+        int release(size_t n = 1) noexcept {
+            int32_t _free = m_iFree.load(atomic::memory_order::Relaxed);
+            do {
+                if(size_t(_free) + n > TMAXCOUNT) return 1;
+            } while(!m_iFree.compare_exchange_weak(_free, _free + int32_t(n), atomic::memory_order::SeqCst));
+
+            if(m_uiWaiters.load(atomic::memory_order::SeqCst) != 0) {
+                m_queue.lock();
+                wait_node* _woken = dispatch();
+                m_queue.unlock();
+
+                unpark_all(_woken);
             }
-            return lock_ret;
+            return 0;
         }
 
         bool is_initialized() const override { return true; }
-        bool is_locked() const override { return m_iCount > 0;  }
+        bool is_locked() const override { return get_left() < TMAXCOUNT;  }
 
-        size_t get_count () { return m_iCount; }
-        size_t get_left() { return TMAXCOUNT - m_iCount; }
+        /**
+         * @brief Get the count of acquired permits.
+         */
+        size_t get_count () const { return TMAXCOUNT - get_left(); }
+        /**
+         * @brief Get the count of free permits.
+         */
+        size_t get_left() const { return size_t(m_iFree.load(atomic::memory_order::Relaxed)); }
 
         void operator = (const self_type&) = delete;
         void operator = (const self_type&&) = delete;
     private:
-        basic_binary_semaphore m_refLockRefObject;
-        atomic::atomic_size_t m_iCount;
+        bool take(size_t n) noexcept {
+            int32_t _free = m_iFree.load(atomic::memory_order::Relaxed);
+
+            while(_free >= int32_t(n)) {
+                if(m_iFree.compare_exchange_weak(_free, _free - int32_t(n), atomic::memory_order::Acquire))
+                    return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Hand the free permits to the waiters in FIFO order.
+         * @note Hold the queue lock.
+         * @return The chain of served waiters, for unpark_all.
+         */
+        wait_node* dispatch() noexcept {
+            wait_node* _head = nullptr;
+            wait_node* _tail = nullptr;
+
+            for(wait_node* _node = m_queue.front(); _node != nullptr; _node = m_queue.front()) {
+                if(!take(_node->data)) break;
+
+                m_queue.pop(_node);
+                m_uiWaiters.fetch_sub(1, atomic::memory_order::Relaxed);
+
+                if(_tail != nullptr) _tail->next = _node;
+                else _head = _node;
+                _tail = _node;
+            }
+            return _head;
+        }
+
+        static void unpark_all(wait_node* chain) noexcept {
+            wait_queue::wake_chain(chain);
+        }
+    private:
+        atomic::basic_atomic_gcc<int32_t> m_iFree;
+        atomic::basic_atomic_gcc<uint32_t> m_uiWaiters;
+        wait_queue m_queue;
     };
 
     using binary_semaphore = basic_binary_semaphore;
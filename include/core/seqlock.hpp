@@ -0,0 +1,203 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_SEQLOCK_H__
+#define __SQUADS_SEQLOCK_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "arch/arch_utils.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    namespace internal {
+        /**
+         * @brief Wait for the writer of a seqlock: spin a bounded count of rounds,
+         * then sleep one tick. A yield alone never lets a writer of lower priority run.
+         * @param spins The spin rounds of the caller, start with 0.
+         */
+        inline void seqlock_backoff(unsigned int& spins) {
+            if(spins < SQUADS_CONFIG_SEQLOCK_SPIN_MAX) {
+                spins++;
+                arch::arch_cpu_relax();
+                return;
+            }
+            spins = 0;
+            arch::arch_delay(1);
+        }
+    }
+
+    /**
+     * @brief The writer policy of a seqlock with only one writer (task or ISR).
+     */
+    struct seqlock_single_writer {
+        using sequence_type = atomic::basic_atomic_gcc<uint32_t>;
+
+        /**
+         * @brief Begin a write: make the sequence odd.
+         * @return The odd sequence.
+         */
+        static uint32_t begin(sequence_type& seq) {
+            uint32_t _seq = seq.load(atomic::memory_order::Relaxed) + 1;
+            seq.store(_seq, atomic::memory_order::Relaxed);
+
+            return _seq;
+        }
+    };
+
+    /**
+     * @brief The writer policy of a seqlock with more writers: a writer makes the
+     * sequence odd with a compare exchange, so the writers are serialized.
+     * @note A writer, that is preempted in the write, blocks the other writers and
+     * the readers; keep the writes short.
+     */
+    struct seqlock_multi_writer {
+        using sequence_type = atomic::basic_atomic_gcc<uint32_t>;
+
+        static uint32_t begin(sequence_type& seq) {
+            uint32_t _seq = seq.load(atomic::memory_order::Relaxed);
+            unsigned int _spins = 0;
+
+            for(;;) {
+                if((_seq & 1) == 0 &&
+                   seq.compare_exchange_weak(_seq, _seq + 1, atomic::memory_order::Acquire))
+                    return _seq + 1;
+
+                internal::seqlock_backoff(_spins);
+                _seq = seq.load(atomic::memory_order::Relaxed);
+            }
+        }
+    };
+
+    /**
+     * @brief A sequence lock for a small trivially copyable value, like a pose or a
+     * set of timestamps.
+     *
+     * A writer makes the sequence odd, writes the value and makes the sequence even.
+     * A reader copies the value optimistic and retries, when the sequence was odd or
+     * changed between. The readers don't write shared memory, so many readers don't
+     * slow down each other or the writer, and the writer never waits for readers.
+     *
+     * @code
+     * struct pose { float x, y, z; uint32_t stamp; };
+     * seqlock<pose> g_pose;
+     *
+     * // producer (ISR)
+     * g_pose.store(p);
+     *
+     * // readers
+     * pose p = g_pose.load();
+     * @endcode
+     *
+     * @note The value is copied in 32 bit words with relaxed atomics, between the
+     * fences of the sequence.
+     * @note A blocked reader or writer sleeps a tick after SQUADS_CONFIG_SEQLOCK_SPIN_MAX
+     * spin rounds, so a ISR may only write (single writer) or use try_load.
+     *
+     * @tparam T The type of the value, must be trivially copyable.
+     * @tparam TWRITER The writer policy: seqlock_single_writer or seqlock_multi_writer.
+     *
+     * @ingroup lock
+     */
+    template <typename T, class TWRITER = seqlock_single_writer>
+    class basic_seqlock {
+        static_assert(__is_trivially_copyable(T), "squads::seqlock requires a trivially copyable type");
+    public:
+        using value_type = T;
+        using writer_type = TWRITER;
+        using self_type = basic_seqlock<value_type, writer_type>;
+
+        basic_seqlock() : m_uiSeq(0), m_aWords{ } { }
+
+        explicit basic_seqlock(const value_type& value) : m_uiSeq(0), m_aWords{ } {
+            __builtin_memcpy(m_aWords, &value, sizeof(value_type));
+        }
+
+        basic_seqlock(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Write a new value.
+         */
+        void store(const value_type& value) {
+            uint32_t _words[words];
+            __builtin_memcpy(_words, &value, sizeof(value_type));
+
+            uint32_t _seq = writer_type::begin(m_uiSeq);
+            // the odd sequence before the data
+            atomic::thread_fence(atomic::memory_order::Release);
+
+            for(size_t i = 0; i < words; i++)
+                __atomic_store_n(&m_aWords[i], _words[i], __ATOMIC_RELAXED);
+
+            m_uiSeq.store(_seq + 1, atomic::memory_order::Release);
+        }
+
+        /**
+         * @brief Read the value, retry until a consistent copy is read.
+         * @note Not from a ISR, a retry can sleep.
+         */
+        value_type load() const {
+            value_type _value;
+            unsigned int _spins = 0;
+
+            while(!try_load(_value))
+                internal::seqlock_backoff(_spins);
+
+            return _value;
+        }
+
+        /**
+         * @brief Read the value one time, without retry.
+         * @param value The value, only valid when true returns.
+         * @return true if the copy is consistent and false when a write was in progress.
+         */
+        bool try_load(value_type& value) const {
+            uint32_t _words[words];
+
+            uint32_t _seq = m_uiSeq.load(atomic::memory_order::Acquire);
+            if((_seq & 1) != 0) return false;
+
+            for(size_t i = 0; i < words; i++)
+                _words[i] = __atomic_load_n(&m_aWords[i], __ATOMIC_RELAXED);
+
+            // the data before the second read of the sequence
+            atomic::thread_fence(atomic::memory_order::Acquire);
+            if(m_uiSeq.load(atomic::memory_order::Relaxed) != _seq) return false;
+
+            __builtin_memcpy(&value, _words, sizeof(value_type));
+            return true;
+        }
+
+        /**
+         * @brief Get the current sequence, it is incremented by two with each write.
+         */
+        uint32_t get_sequence() const {
+            return m_uiSeq.load(atomic::memory_order::Acquire);
+        }
+    private:
+        static constexpr size_t words = (sizeof(value_type) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+        atomic::basic_atomic_gcc<uint32_t> m_uiSeq;
+        uint32_t m_aWords[words];
+    };
+
+    template <typename T, class TWRITER = seqlock_single_writer>
+    using seqlock = basic_seqlock<T, TWRITER>;
+}
+
+#endif
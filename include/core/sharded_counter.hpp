@@ -0,0 +1,157 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_SHARDED_COUNTER_H__
+#define __SQUADS_SHARDED_COUNTER_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "arch/arch_utils.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    /**
+     * @brief A counter with one slot per core, for hot statistic counters.
+     *
+     * Each slot lives on a own cache line. A increment is a relaxed atomic add on
+     * the slot of the current core, so the cores don't share a cache line. The
+     * value is the sum of all slots.
+     *
+     * For a cheap read of a often read counter, fold sums the slots in a cached
+     * value (call it periodic, like from a timer) and approx returns the cached
+     * value without touching the slots.
+     *
+     * @code
+     * sharded_counter<uint32_t> g_rx_packets;
+     *
+     * // hot path, on both cores
+     * ++g_rx_packets;
+     *
+     * // statistic task
+     * printf("rx %u\n", g_rx_packets.value());
+     * @endcode
+     *
+     * @note The task can be moved to a other core between the core id and the add,
+     * the add is atomic, so the sum keeps right.
+     * @note Use a 32 bit type, wider atomics are not lock free on 32 bit targets.
+     *
+     * @tparam T The type of the counter.
+     * @tparam TCORES The count of slots, one per core.
+     *
+     * @ingroup base
+     */
+    template <typename T, int TCORES = SQUADS_CONFIG_NUM_CORES>
+    class basic_sharded_counter {
+    public:
+        using value_type = T;
+        using self_type = basic_sharded_counter<value_type, TCORES>;
+
+        /**
+         * @brief Construct a new counter and initializes it to zero.
+         */
+        basic_sharded_counter() : m_tCached(0) {
+            for(int i = 0; i < TCORES; i++)
+                m_slots[i].value.store(0, atomic::memory_order::Relaxed);
+        }
+
+        basic_sharded_counter(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Add a value to the slot of the current core.
+         */
+        void add(value_type v) {
+            get_slot().value.fetch_add(v, atomic::memory_order::Relaxed);
+        }
+
+        /**
+         * @brief Subtract a value from the slot of the current core.
+         */
+        void sub(value_type v) {
+            get_slot().value.fetch_sub(v, atomic::memory_order::Relaxed);
+        }
+
+        inline void operator ++ ()                  { add(1); }
+        inline void operator -- ()                  { sub(1); }
+        inline void operator ++ (int)               { add(1); }
+        inline void operator -- (int)               { sub(1); }
+        inline void operator += (value_type v)      { add(v); }
+        inline void operator -= (value_type v)      { sub(v); }
+
+        /**
+         * @brief Get the exact value, the sum of all slots.
+         * @note Not a snapshot, adds while the sum are counted or not.
+         */
+        value_type value() const {
+            value_type _sum = 0;
+
+            for(int i = 0; i < TCORES; i++)
+                _sum += m_slots[i].value.load(atomic::memory_order::Relaxed);
+            return _sum;
+        }
+
+        inline operator value_type () const         { return value(); }
+
+        /**
+         * @brief Fold the slots in the cached value, for approx.
+         * @return The new cached value.
+         */
+        value_type fold() {
+            value_type _sum = value();
+
+            m_tCached.store(_sum, atomic::memory_order::Relaxed);
+            return _sum;
+        }
+
+        /**
+         * @brief Get the value of the last fold, without reading the slots.
+         */
+        value_type approx() const {
+            return m_tCached.load(atomic::memory_order::Relaxed);
+        }
+
+        /**
+         * @brief Set all slots to zero.
+         * @return The value before the reset.
+         */
+        value_type reset() {
+            value_type _sum = 0;
+
+            for(int i = 0; i < TCORES; i++)
+                _sum += m_slots[i].value.exchange(0, atomic::memory_order::Relaxed);
+            m_tCached.store(0, atomic::memory_order::Relaxed);
+
+            return _sum;
+        }
+    private:
+        struct alignas(SQUADS_CONFIG_CACHE_LINE_SIZE) slot {
+            atomic::basic_atomic_gcc<value_type> value;
+        };
+
+        slot& get_slot() {
+            return m_slots[arch::arch_get_core_id() % TCORES];
+        }
+    private:
+        slot m_slots[TCORES];
+        atomic::basic_atomic_gcc<value_type> m_tCached;
+    };
+
+    template <typename T>
+    using sharded_counter = basic_sharded_counter<T>;
+}
+
+#endif
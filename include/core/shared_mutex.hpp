@@ -0,0 +1,574 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_SHARED_MUTEX_H__
+#define __SQUADS_SHARED_MUTEX_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "deadline.hpp"
+#include "cancellation_token.hpp"
+#include "wait_queue.hpp"
+#include "fast_mutex.hpp"
+#include "arch/arch_utils.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    /**
+     * @brief A reader-writer lock for read mostly data, with writer preference.
+     *
+     * The state is one atomic word with the reader count and the writer bits.
+     * Readers enter and leave with one atomic operation, when no writer holds
+     * or waits for the lock. A waiting writer blocks new readers, so writers
+     * don't starve. Blocked tasks park in a wait_queue.
+     *
+     * @code
+     * shared_mutex lock;
+     *
+     * // reader
+     * shared_autolock<shared_mutex> l(lock);
+     *
+     * // writer
+     * autolock<shared_mutex> l(lock);
+     * @endcode
+     *
+     * @note Not recursive: a reader that locks shared again can deadlock, when a
+     * writer waits between.
+     *
+     * @ingroup lock
+     */
+    class shared_mutex {
+    public:
+        using self_type = shared_mutex;
+
+        enum : uint32_t {
+            writer = 0x80000000u,       /*!< a writer holds the lock */
+            writer_waiting = 0x40000000u,  /*!< writers wait, new readers block */
+            reader_parked = 0x20000000u,   /*!< readers wait in the queue */
+            reader_mask = 0x1FFFFFFFu      /*!< the count of the readers */
+        };
+
+        enum : uintptr_t {
+            node_reader = 0,
+            node_writer = 1
+        };
+
+        shared_mutex() : m_uiState(0), m_iWriters(0), m_queue() { }
+
+        shared_mutex(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Lock the mutex exclusive, for a writer.
+         * @param timeout How long to wait in ticks.
+         * @return 0 on success and 1 on timeout.
+         */
+        int lock(unsigned int timeout = SQUADS_PORTMAX_DELAY) {
+            uint32_t _expected = 0;
+            if(m_uiState.compare_exchange_strong(_expected, writer, atomic::memory_order::Acquire))
+                return 0;
+
+            return lock_slow(timeout);
+        }
+
+        /**
+         * @brief Lock the mutex exclusive until the deadline.
+         * @return 0 on success, 1 on timeout and SQUADS_RESULT_CANCELLED when cancelled.
+         */
+        int lock(const basic_deadline& dl, cancellation_token* token = nullptr) {
+            cancellation_scope _scope(token);
+            if(_scope.is_cancelled()) return SQUADS_RESULT_CANCELLED;
+
+            return (lock(dl.remaining_ticks()) == 0) ? 0 : _scope.failed_result();
+        }
+
+        /**
+         * @brief Try to lock the mutex exclusive, without waiting.
+         * @return true if the lock was acquired.
+         */
+        bool try_lock() {
+            uint32_t _expected = 0;
+            return m_uiState.compare_exchange_strong(_expected, writer, atomic::memory_order::Acquire);
+        }
+
+        /**
+         * @brief Unlock the exclusive lock, wake up the next writer or all readers.
+         * @return 0
+         */
+        int unlock() {
+            uint32_t _expected = writer;
+            if(m_uiState.compare_exchange_strong(_expected, 0, atomic::memory_order::Release))
+                return 0;
+
+            m_queue.lock();
+
+            wait_node* _woken = nullptr;
+            uint32_t _state = m_uiState.load(atomic::memory_order::Relaxed);
+
+            if(m_iWriters > 0) {
+                // writer preference, readers keep blocked
+                m_uiState.store((_state & reader_parked) | writer_waiting, atomic::memory_order::Release);
+                _woken = pop_writer();
+            } else {
+                m_uiState.store(0, atomic::memory_order::Release);
+                _woken = pop_readers();
+            }
+            m_queue.unlock();
+
+            unpark_all(_woken);
+            return 0;
+        }
+
+        /**
+         * @brief Lock the mutex shared, for a reader.
+         * @param timeout How long to wait in ticks.
+         * @return 0 on success and 1 on timeout.
+         */
+        int lock_shared(unsigned int timeout = SQUADS_PORTMAX_DELAY) {
+            if(try_lock_shared()) return 0;
+
+            return lock_shared_slow(timeout);
+        }
+
+        /**
+         * @brief Lock the mutex shared until the deadline.
+         * @return 0 on success, 1 on timeout and SQUADS_RESULT_CANCELLED when cancelled.
+         */
+        int lock_shared(const basic_deadline& dl, cancellation_token* token = nullptr) {
+            cancellation_scope _scope(token);
+            if(_scope.is_cancelled()) return SQUADS_RESULT_CANCELLED;
+
+            return (lock_shared(dl.remaining_ticks()) == 0) ? 0 : _scope.failed_result();
+        }
+
+        /**
+         * @brief Try to lock the mutex shared, without waiting.
+         * @return true if the lock was acquired.
+         */
+        bool try_lock_shared() {
+            uint32_t _state = m_uiState.load(atomic::memory_order::Relaxed);
+
+            while((_state & (writer | writer_waiting)) == 0) {
+                if(m_uiState.compare_exchange_weak(_state, _state + 1, atomic::memory_order::Acquire))
+                    return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief Unlock the shared lock, the last reader wakes up a waiting writer.
+         * @return 0
+         */
+        int unlock_shared() {
+            uint32_t _state = m_uiState.fetch_sub(1, atomic::memory_order::Release) - 1;
+
+            if((_state & reader_mask) == 0 && (_state & writer_waiting) != 0) {
+                m_queue.lock();
+                wait_node* _woken = pop_writer();
+                m_queue.unlock();
+
+                unpark_all(_woken);
+            }
+            return 0;
+        }
+
+        /**
+         * @brief Downgrade the exclusive lock to a shared lock, without a gap.
+         *
+         * The parked readers are woken, when no writer waits. With waiting writers
+         * the readers keep blocked, the last reader wakes up the next writer.
+         * @return 0
+         */
+        int unlock_and_lock_shared() {
+            uint32_t _expected = writer;
+            if(m_uiState.compare_exchange_strong(_expected, 1, atomic::memory_order::Release))
+                return 0;
+
+            m_queue.lock();
+
+            wait_node* _woken = nullptr;
+            uint32_t _state = m_uiState.load(atomic::memory_order::Relaxed);
+
+            if(m_iWriters > 0) {
+                m_uiState.store((_state & reader_parked) | writer_waiting | 1, atomic::memory_order::Release);
+            } else {
+                m_uiState.store(1, atomic::memory_order::Release);
+                _woken = pop_readers();
+            }
+            m_queue.unlock();
+
+            unpark_all(_woken);
+            return 0;
+        }
+
+        /**
+         * @brief Try to upgrade the shared lock to a exclusive lock, without waiting.
+         *
+         * Works only for the only reader, when no writer waits.
+         * @return true if upgraded, false if the task holds still the shared lock.
+         */
+        bool try_unlock_shared_and_lock() {
+            uint32_t _expected = 1;
+            return m_uiState.compare_exchange_strong(_expected, writer, atomic::memory_order::Acquire);
+        }
+
+        /**
+         * @brief Is the mutex locked exclusive?
+         */
+        bool is_locked() const {
+            return (m_uiState.load(atomic::memory_order::Relaxed) & writer) != 0;
+        }
+
+        /**
+         * @brief Get the count of the readers, that hold the lock.
+         */
+        uint32_t get_reader_count() const {
+            return m_uiState.load(atomic::memory_order::Relaxed) & reader_mask;
+        }
+    private:
+        int lock_slow(unsigned int timeout) {
+            if(timeout == 0) return 1;
+
+            basic_deadline _dl = basic_deadline::from_ticks(timeout);
+            wait_node _node;
+            _node.data = node_writer;
+
+            m_queue.lock();
+            m_iWriters++;
+
+            for(;;) {
+                uint32_t _state = m_uiState.load(atomic::memory_order::Relaxed);
+
+                if((_state & (writer | reader_mask)) == 0) {
+                    uint32_t _desired = writer | (_state & reader_parked) |
+                                        ((m_iWriters > 1) ? writer_waiting : 0);
+
+                    if(m_uiState.compare_exchange_strong(_state, _desired, atomic::memory_order::Acquire)) {
+                        m_iWriters--;
+                        m_queue.unlock();
+                        return 0;
+                    }
+                    continue;
+                }
+                if((_state & writer_waiting) == 0) {
+                    // block new readers, before we park
+                    if(!m_uiState.compare_exchange_strong(_state, _state | writer_waiting,
+                        atomic::memory_order::Relaxed)) continue;
+                }
+                if(_dl.is_expired()) {
+                    wait_node* _woken = leave_writer();
+                    m_queue.unlock();
+
+                    unpark_all(_woken);
+                    return 1;
+                }
+                m_queue.push_back(&_node);
+                m_queue.wait(_node, _dl.remaining_ticks());
+
+                m_queue.lock();
+            }
+        }
+
+        int lock_shared_slow(unsigned int timeout) {
+            if(timeout == 0) return 1;
+
+            basic_deadline _dl = basic_deadline::from_ticks(timeout);
+            wait_node _node;
+            _node.data = node_reader;
+
+            m_queue.lock();
+
+            for(;;) {
+                uint32_t _state = m_uiState.load(atomic::memory_order::Relaxed);
+
+                if((_state & (writer | writer_waiting)) == 0) {
+                    if(m_uiState.compare_exchange_strong(_state, _state + 1, atomic::memory_order::Acquire)) {
+                        m_queue.unlock();
+                        return 0;
+                    }
+                    continue;
+                }
+                if((_state & reader_parked) == 0) {
+                    // the unlocking writer must take the slow path
+                    if(!m_uiState.compare_exchange_strong(_state, _state | reader_parked,
+                        atomic::memory_order::Relaxed)) continue;
+                }
+                if(_dl.is_expired()) {
+                    m_queue.unlock();
+                    return 1;
+                }
+                m_queue.push_back(&_node);
+                m_queue.wait(_node, _dl.remaining_ticks());
+
+                m_queue.lock();
+            }
+        }
+
+        /**
+         * @brief A writer gives up waiting, the last one lets the readers in.
+         * @note Hold the queue lock.
+         */
+        wait_node* leave_writer() {
+            if(--m_iWriters > 0) return nullptr;
+
+            uint32_t _state = m_uiState.load(atomic::memory_order::Relaxed);
+            for(;;) {
+                uint32_t _desired = _state & ~writer_waiting;
+                if((_state & writer) == 0) _desired &= ~reader_parked;
+
+                if(m_uiState.compare_exchange_weak(_state, _desired, atomic::memory_order::Release))
+                    break;
+            }
+            return ((_state & writer) == 0) ? pop_readers() : nullptr;
+        }
+
+        /**
+         * @brief Pop the first waiting writer.
+         * @note Hold the queue lock.
+         */
+        wait_node* pop_writer() {
+            for(wait_node* _node = m_queue.front(); _node != nullptr; _node = _node->next) {
+                if(_node->data == node_writer) {
+                    m_queue.pop(_node);
+                    return _node;
+                }
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief Pop all waiting readers, as a chain over the next pointers.
+         * @note Hold the queue lock.
+         */
+        wait_node* pop_readers() {
+            wait_node* _chain = nullptr;
+            wait_node* _node = m_queue.front();
+
+            while(_node != nullptr) {
+                wait_node* _next = _node->next;
+
+                if(_node->data == node_reader) {
+                    m_queue.pop(_node);
+                    _node->next = _chain;
+                    _chain = _node;
+                }
+                _node = _next;
+            }
+            return _chain;
+        }
+
+        /**
+         * @brief Unpark a chain of popped nodes, after the queue is unlocked.
+         */
+        static void unpark_all(wait_node* chain) {
+            wait_queue::wake_chain(chain);
+        }
+    private:
+        atomic::basic_atomic_gcc<uint32_t> m_uiState;
+        int m_iWriters;
+        wait_queue m_queue;
+    };
+
+    /**
+     * @brief A reader-writer lock with per core reader indicators, for very read
+     * heavy data.
+     *
+     * Each reader counts on the cache line of his core, so readers on different
+     * cores share no cache line. A writer closes the gate, then parks until all
+     * reader counts are zero, the last reader wakes it up. Blocked readers park
+     * on the writer mutex.
+     *
+     * @note Writing is expensive, the writer sums the counts of all cores.
+     *
+     * @ingroup lock
+     */
+    class distributed_shared_mutex {
+    public:
+        using self_type = distributed_shared_mutex;
+
+        distributed_shared_mutex() : m_uiGate(0), m_mutex(), m_queue() {
+            for(int i = 0; i < SQUADS_CONFIG_NUM_CORES; i++)
+                m_slots[i].count.store(0, atomic::memory_order::Relaxed);
+        }
+
+        distributed_shared_mutex(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Lock the mutex exclusive, for a writer.
+         * @param timeout How long to wait in ticks.
+         * @return 0 on success and 1 on timeout.
+         */
+        int lock(unsigned int timeout = SQUADS_PORTMAX_DELAY) {
+            basic_deadline _dl = basic_deadline::from_ticks(timeout);
+
+            if(m_mutex.lock(timeout) != 0) return 1;
+            m_uiGate.store(1, atomic::memory_order::SeqCst);
+
+            if(count_readers() == 0) return 0;
+
+            wait_node _node;
+            m_queue.lock();
+
+            // a reader, that leaves after the check, sees the node in the queue
+            while(count_readers() != 0) {
+                if(_dl.is_expired()) {
+                    m_queue.unlock();
+                    unlock();
+                    return 1;
+                }
+                m_queue.push_back(&_node);
+                m_queue.wait(_node, _dl.remaining_ticks());
+
+                m_queue.lock();
+            }
+            m_queue.unlock();
+            return 0;
+        }
+
+        /**
+         * @brief Lock the mutex exclusive until the deadline.
+         * @return 0 on success, 1 on timeout and SQUADS_RESULT_CANCELLED when cancelled.
+         */
+        int lock(const basic_deadline& dl, cancellation_token* token = nullptr) {
+            cancellation_scope _scope(token);
+            if(_scope.is_cancelled()) return SQUADS_RESULT_CANCELLED;
+
+            return (lock(dl.remaining_ticks()) == 0) ? 0 : _scope.failed_result();
+        }
+
+        /**
+         * @brief Unlock the exclusive lock and open the gate for the readers.
+         * @return 0
+         */
+        int unlock() {
+            m_uiGate.store(0, atomic::memory_order::Release);
+            m_mutex.unlock();
+            return 0;
+        }
+
+        /**
+         * @brief Lock the mutex shared, for a reader.
+         * @param timeout How long to wait in ticks.
+         * @return 0 on success and 1 on timeout.
+         */
+        int lock_shared(unsigned int timeout = SQUADS_PORTMAX_DELAY) {
+            basic_deadline _dl = basic_deadline::from_ticks(timeout);
+
+            for(;;) {
+                if(try_lock_shared()) return 0;
+                if(_dl.is_expired()) return 1;
+
+                // park until the writer is done
+                if(m_mutex.lock(_dl.remaining_ticks()) != 0) return 1;
+                m_mutex.unlock();
+            }
+        }
+
+        /**
+         * @brief Lock the mutex shared until the deadline.
+         * @return 0 on success, 1 on timeout and SQUADS_RESULT_CANCELLED when cancelled.
+         */
+        int lock_shared(const basic_deadline& dl, cancellation_token* token = nullptr) {
+            cancellation_scope _scope(token);
+            if(_scope.is_cancelled()) return SQUADS_RESULT_CANCELLED;
+
+            return (lock_shared(dl.remaining_ticks()) == 0) ? 0 : _scope.failed_result();
+        }
+
+        /**
+         * @brief Try to lock the mutex shared, without waiting.
+         * @return true if the lock was acquired.
+         */
+        bool try_lock_shared() {
+            if(m_uiGate.load(atomic::memory_order::Acquire) != 0) return false;
+
+            slot& _slot = m_slots[arch::arch_get_core_id()];
+            _slot.count.fetch_add(1, atomic::memory_order::SeqCst);
+
+            if(m_uiGate.load(atomic::memory_order::SeqCst) == 0) return true;
+
+            // a writer came between, back off on the same slot
+            leave_slot(_slot);
+            return false;
+        }
+
+        /**
+         * @brief Unlock the shared lock.
+         * @note The task can be moved to a other core, the sum of the slots keeps right.
+         * @return 0
+         */
+        int unlock_shared() {
+            leave_slot(m_slots[arch::arch_get_core_id()]);
+            return 0;
+        }
+
+        /**
+         * @brief Is the mutex locked exclusive?
+         */
+        bool is_locked() const {
+            return m_uiGate.load(atomic::memory_order::Relaxed) != 0;
+        }
+
+        /**
+         * @brief Get the count of the readers, that hold the lock.
+         */
+        int32_t get_reader_count() const {
+            int32_t _count = 0;
+
+            for(int i = 0; i < SQUADS_CONFIG_NUM_CORES; i++)
+                _count += m_slots[i].count.load(atomic::memory_order::Acquire);
+            return _count;
+        }
+    private:
+        struct alignas(SQUADS_CONFIG_CACHE_LINE_SIZE) slot {
+            atomic::basic_atomic_gcc<int32_t> count;
+        };
+
+        /**
+         * @brief The reader count, ordered with the gate.
+         */
+        int32_t count_readers() const {
+            int32_t _count = 0;
+
+            for(int i = 0; i < SQUADS_CONFIG_NUM_CORES; i++)
+                _count += m_slots[i].count.load(atomic::memory_order::SeqCst);
+            return _count;
+        }
+
+        /**
+         * @brief Leave the slot, the last reader wakes up the waiting writer.
+         */
+        void leave_slot(slot& s) {
+            s.count.fetch_sub(1, atomic::memory_order::SeqCst);
+            if(m_uiGate.load(atomic::memory_order::SeqCst) == 0) return;
+
+            m_queue.lock();
+            void* _task = (count_readers() == 0) ? m_queue.pop_front() : nullptr;
+            m_queue.unlock();
+
+            wait_queue::unpark(_task);
+        }
+    private:
+        slot m_slots[SQUADS_CONFIG_NUM_CORES];
+        atomic::basic_atomic_gcc<uint32_t> m_uiGate;
+        fast_mutex m_mutex;
+        wait_queue m_queue;
+    };
+}
+
+#endif
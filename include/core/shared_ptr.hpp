@@ -22,109 +22,422 @@
 #include "defines.hpp"
 #include "functional.hpp"
 #include "algorithm.hpp"
+#include "allocator.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
 
 namespace squads {
+    /**
+     * @brief The count policy of shared pointers, that are shared between tasks.
+     */
+    struct shared_count_atomic {
+        using count_type = atomic::basic_atomic_gcc<uint32_t>;
+
+        static void increment(count_type& count) {
+            count.fetch_add(1, atomic::memory_order::Relaxed);
+        }
+        /**
+         * @return The new count.
+         */
+        static uint32_t decrement(count_type& count) {
+            return count.fetch_sub(1, atomic::memory_order::AcqRel) - 1;
+        }
+        /**
+         * @brief Increment the count, when it is not zero.
+         */
+        static bool increment_not_zero(count_type& count) {
+            uint32_t _count = count.load(atomic::memory_order::Relaxed);
+
+            while(_count != 0) {
+                if(count.compare_exchange_weak(_count, _count + 1, atomic::memory_order::Acquire))
+                    return true;
+            }
+            return false;
+        }
+        static uint32_t load(const count_type& count) {
+            return count.load(atomic::memory_order::Relaxed);
+        }
+    };
+
+    /**
+     * @brief The count policy of shared pointers, that are used in only one task.
+     */
+    struct shared_count_single {
+        using count_type = uint32_t;
+
+        static void increment(count_type& count)            { ++count; }
+        static uint32_t decrement(count_type& count)        { return --count; }
+        static bool increment_not_zero(count_type& count)   { return (count != 0) ? (++count, true) : false; }
+        static uint32_t load(const count_type& count)       { return count; }
+    };
+
+    /**
+     * @brief The default deleter of shared pointers, with delete.
+     */
+    template <typename T>
+    struct shared_default_delete {
+        void operator()(T* ptr) const noexcept { delete ptr; }
+    };
+
+    namespace internal {
+        /**
+         * @brief The control block of shared and weak pointers.
+         *
+         * The strong count is the count of the shared pointers. The weak count is the
+         * count of the weak pointers, plus one for all shared pointers. The object is
+         * destroyed when the strong count is zero, the control block when the weak
+         * count is zero.
+         */
+        template <class TPOLICY>
+        class basic_shared_control {
+        public:
+            using policy_type = TPOLICY;
+            using count_type = typename policy_type::count_type;
 
-    template < typename T, typename TRefType >
-    class basic_shared_ptr   {
+            basic_shared_control() : m_strong(1), m_weak(1) { }
+            virtual ~basic_shared_control() { }
+
+            basic_shared_control(const basic_shared_control&) = delete;
+            basic_shared_control& operator = (const basic_shared_control&) = delete;
+
+            void add_ref()                  { policy_type::increment(m_strong); }
+            void add_weak()                 { policy_type::increment(m_weak); }
+            bool add_ref_not_zero()         { return policy_type::increment_not_zero(m_strong); }
+            uint32_t use_count() const      { return policy_type::load(m_strong); }
+
+            void release() {
+                if(policy_type::decrement(m_strong) == 0) {
+                    dispose();
+                    release_weak();
+                }
+            }
+
+            void release_weak() {
+                if(policy_type::decrement(m_weak) == 0) destroy();
+            }
+        protected:
+            /**
+             * @brief Destroy the object.
+             */
+            virtual void dispose() noexcept = 0;
+            /**
+             * @brief Free the control block.
+             */
+            virtual void destroy() noexcept = 0;
+        private:
+            count_type m_strong;
+            count_type m_weak;
+        };
+
+        /**
+         * @brief A control block for a object, that was allocated before.
+         */
+        template <typename T, class TDELETER, class TALLOCATOR, class TPOLICY>
+        class shared_control_ptr : public basic_shared_control<TPOLICY> {
+        public:
+            using self_type = shared_control_ptr<T, TDELETER, TALLOCATOR, TPOLICY>;
+
+            shared_control_ptr(T* ptr, const TDELETER& deleter, const TALLOCATOR& alloc)
+                : m_ptr(ptr), m_deleter(deleter), m_alloc(alloc) { }
+        protected:
+            virtual void dispose() noexcept { m_deleter(m_ptr); }
+
+            virtual void destroy() noexcept {
+                TALLOCATOR _alloc(m_alloc);
+
+                this->~self_type();
+                _alloc.deallocate(this, sizeof(self_type), alignof(self_type));
+            }
+        private:
+            T* m_ptr;
+            TDELETER m_deleter;
+            TALLOCATOR m_alloc;
+        };
+
+        /**
+         * @brief A control block with the object in the same allocation, for allocate_shared.
+         */
+        template <typename T, class TALLOCATOR, class TPOLICY>
+        class shared_control_inplace : public basic_shared_control<TPOLICY> {
+        public:
+            using self_type = shared_control_inplace<T, TALLOCATOR, TPOLICY>;
+
+            template <typename... Args>
+            shared_control_inplace(const TALLOCATOR& alloc, Args&&... args) : m_alloc(alloc) {
+                ::new (static_cast<void*>(m_storage)) T(squads::forward<Args>(args)...);
+            }
+
+            T* get() { return reinterpret_cast<T*>(m_storage); }
+        protected:
+            virtual void dispose() noexcept { squads::destruct<T>(get()); }
+
+            virtual void destroy() noexcept {
+                TALLOCATOR _alloc(m_alloc);
+
+                this->~self_type();
+                _alloc.deallocate(this, sizeof(self_type), alignof(self_type));
+            }
+        private:
+            alignas(T) unsigned char m_storage[sizeof(T)];
+            TALLOCATOR m_alloc;
+        };
+    }
+
+    template <typename T, class TPOLICY>
+    class basic_weak_ptr;
+
+    /**
+     * @brief A shared pointer with a shared control block.
+     *
+     * All copies share the control block with the strong and the weak count. The object
+     * is destroyed with the last shared pointer, the control block with the last shared
+     * or weak pointer. allocate_shared and make_shared allocate the object and the control
+     * block in one allocation.
+     *
+     * @code
+     * shared_ptr<session> s = make_shared<session>(42);
+     * weak_ptr<session> w(s);
+     *
+     * if(shared_ptr<session> l = w.lock()) l->send();
+     * @endcode
+     *
+     * @tparam T The type of the object.
+     * @tparam TPOLICY The count policy: shared_count_atomic or shared_count_single.
+     */
+    template <typename T, class TPOLICY = shared_count_atomic>
+    class basic_shared_ptr {
+        template <typename U, class UPOLICY> friend class basic_shared_ptr;
+        template <typename U, class UPOLICY> friend class basic_weak_ptr;
     public:
         using value_type = T;
         using element_type = T;
         using reference = T&;
-        using const_value_type = const value_type;
         using pointer = value_type*;
-        using ref_type = TRefType;
+        using policy_type = TPOLICY;
+        using control_type = internal::basic_shared_control<policy_type>;
+
+        using self_type = basic_shared_ptr<value_type, policy_type>;
 
-        using self_type = basic_shared_ptr<value_type, ref_type>;
+        constexpr basic_shared_ptr() noexcept : m_ptr(nullptr), m_pControl(nullptr) { }
+        constexpr basic_shared_ptr(nullptr_t) noexcept : m_ptr(nullptr), m_pControl(nullptr) { }
 
+        /**
+         * @brief Take the ownership of a object, that was allocated with new.
+         */
+        template <typename U>
+        explicit basic_shared_ptr(U* ptr)
+            : basic_shared_ptr(ptr, shared_default_delete<U>(), default_allocator<>()) { }
 
-        explicit basic_shared_ptr(pointer ptr )
-            : m_ref(1), m_ptr(ptr)  { }
+        /**
+         * @brief Take the ownership of a object, with a own deleter.
+         */
+        template <typename U, class TDELETER>
+        basic_shared_ptr(U* ptr, TDELETER deleter)
+            : basic_shared_ptr(ptr, deleter, default_allocator<>()) { }
 
-        basic_shared_ptr(const self_type& sp) {
-            assert( (++m_ref != 0) );
-            m_ptr = sp.m_ptr;
+        /**
+         * @brief Take the ownership of a object, with a own deleter and the allocator
+         * of the control block.
+         * @note When the control block can't allocated, the object is deleted.
+         */
+        template <typename U, class TDELETER, class TALLOCATOR>
+        basic_shared_ptr(U* ptr, TDELETER deleter, TALLOCATOR alloc) : m_ptr(ptr), m_pControl(nullptr) {
+            using block_type = internal::shared_control_ptr<U, TDELETER, TALLOCATOR, policy_type>;
+
+            if(ptr == nullptr) return;
+
+            void* _mem = alloc.allocate(sizeof(block_type), alignof(block_type));
+            if(_mem == nullptr) {
+                deleter(ptr);
+                m_ptr = nullptr;
+                return;
+            }
+            m_pControl = ::new (_mem) block_type(ptr, deleter, alloc);
+        }
+
+        /**
+         * @brief The aliasing constructor: share the ownership of other, but point to ptr.
+         */
+        template <typename U>
+        basic_shared_ptr(const basic_shared_ptr<U, policy_type>& other, pointer ptr) noexcept
+            : m_ptr(ptr), m_pControl(other.m_pControl) {
+            if(m_pControl != nullptr) m_pControl->add_ref();
+        }
+
+        basic_shared_ptr(const self_type& other) noexcept
+            : m_ptr(other.m_ptr), m_pControl(other.m_pControl) {
+            if(m_pControl != nullptr) m_pControl->add_ref();
+        }
+
+        template <typename U>
+        basic_shared_ptr(const basic_shared_ptr<U, policy_type>& other) noexcept
+            : m_ptr(other.m_ptr), m_pControl(other.m_pControl) {
+            if(m_pControl != nullptr) m_pControl->add_ref();
+        }
+
+        basic_shared_ptr(self_type&& other) noexcept
+            : m_ptr(other.m_ptr), m_pControl(other.m_pControl) {
+            other.m_ptr = nullptr;
+            other.m_pControl = nullptr;
+        }
+
+        template <typename U>
+        basic_shared_ptr(basic_shared_ptr<U, policy_type>&& other) noexcept
+            : m_ptr(other.m_ptr), m_pControl(other.m_pControl) {
+            other.m_ptr = nullptr;
+            other.m_pControl = nullptr;
         }
 
         ~basic_shared_ptr() {
-            if (--m_ref == 0) delete m_ptr;
+            if(m_pControl != nullptr) m_pControl->release();
+        }
+
+        self_type& operator = (const self_type& other) noexcept {
+            self_type(other).swap(*this);
+            return *this;
+        }
+
+        self_type& operator = (self_type&& other) noexcept {
+            self_type(squads::move(other)).swap(*this);
+            return *this;
+        }
+
+        template <typename U>
+        self_type& operator = (const basic_shared_ptr<U, policy_type>& other) noexcept {
+            self_type(other).swap(*this);
+            return *this;
         }
 
-        pointer release() {
-            pointer __px = this->get();
-            if (--m_ref == 0) delete m_ptr;
+        /**
+         * @brief Release the ownership, the pointer is empty after.
+         */
+        void reset() noexcept {
+            self_type().swap(*this);
+        }
 
-            return __px;
+        /**
+         * @brief Release the ownership and take the ownership of a new object.
+         */
+        template <typename U>
+        void reset(U* ptr) {
+            self_type(ptr).swap(*this);
         }
-        void reset( pointer pValue = 0)
-            { self_type(pValue).swap(*this); }
 
-        ref_type ref() {
-            return m_ref;
+        template <typename U, class TDELETER>
+        void reset(U* ptr, TDELETER deleter) {
+            self_type(ptr, deleter).swap(*this);
         }
-        void swap(self_type& b) {
-            squads::swap<pointer>(m_ptr, b.m_ptr);
-            squads::swap<ref_type >(m_ref, b.m_ref);
+
+        void swap(self_type& other) noexcept {
+            squads::swap<pointer>(m_ptr, other.m_ptr);
+            squads::swap<control_type*>(m_pControl, other.m_pControl);
         }
 
-        pointer get() const {
-            return static_cast<T*>(m_ptr);
+        pointer get() const noexcept            { return m_ptr; }
+
+        reference operator * () const {
+            assert(m_ptr != nullptr);
+            return *m_ptr;
         }
+        pointer operator -> () const {
+            assert(m_ptr != nullptr);
+            return m_ptr;
+        }
+
+        explicit operator bool() const noexcept { return m_ptr != nullptr; }
 
-        pointer operator->() const {
-            assert(get() != 0);
-            return this->get();
+        /**
+         * @brief Get the count of the shared pointers of the object.
+         */
+        uint32_t use_count() const noexcept {
+            return (m_pControl != nullptr) ? m_pControl->use_count() : 0;
         }
-        const_value_type& operator*() {
-            assert(get() != 0);
-            return *this->get();
+
+        bool unique() const noexcept            { return use_count() == 1; }
+
+        /**
+         * @brief Order by the control block, not by the pointer.
+         */
+        template <typename U, class UPOLICY>
+        bool owner_before(const basic_shared_ptr<U, UPOLICY>& other) const noexcept {
+            return m_pControl < other.m_pControl;
         }
-        operator bool() {
-            return m_ptr != 0;
+        template <typename U, class UPOLICY>
+        bool owner_before(const basic_weak_ptr<U, UPOLICY>& other) const noexcept {
+            return m_pControl < other.m_pControl;
         }
 
-        self_type& operator = (self_type& sp) {
-            release();
-            m_ptr = sp.m_ptr;
-            m_ref = sp.m_ref;
-            return *this;
+        /**
+         * @brief Make a shared pointer with the object in the control block.
+         * @return A empty pointer, when the allocation failed.
+         */
+        template <class TALLOCATOR, typename... Args>
+        static self_type allocate(const TALLOCATOR& alloc, Args&&... args) {
+            using block_type = internal::shared_control_inplace<value_type, TALLOCATOR, policy_type>;
+
+            TALLOCATOR _alloc(alloc);
+            void* _mem = _alloc.allocate(sizeof(block_type), alignof(block_type));
+            if(_mem == nullptr) return self_type();
+
+            block_type* _block = ::new (_mem) block_type(alloc, squads::forward<Args>(args)...);
+            return adopt(_block->get(), _block);
+        }
+    private:
+        /**
+         * @brief Make a shared pointer, that adopts a reference of the control block.
+         */
+        static self_type adopt(pointer ptr, control_type* control) noexcept {
+            self_type _shared;
+
+            _shared.m_ptr = ptr;
+            _shared.m_pControl = control;
+            return _shared;
         }
     private:
-        ref_type m_ref;
         pointer m_ptr;
+        control_type* m_pControl;
     };
 
-    template < typename T, typename TRefType >
-    void swap(basic_shared_ptr<T, TRefType>& a, basic_shared_ptr<T, TRefType>& b) {
+    template <typename T, class TPOLICY>
+    void swap(basic_shared_ptr<T, TPOLICY>& a, basic_shared_ptr<T, TPOLICY>& b) {
         a.swap(b);
     }
 
-    template < typename T >
-    using shared_ptr = basic_shared_ptr<T, size_t>;
+    template <typename T, typename U, class TPOLICY>
+    bool operator == (const basic_shared_ptr<T, TPOLICY>& a, const basic_shared_ptr<U, TPOLICY>& b) {
+        return a.get() == b.get();
+    }
+
+    template <typename T, typename U, class TPOLICY>
+    bool operator != (const basic_shared_ptr<T, TPOLICY>& a, const basic_shared_ptr<U, TPOLICY>& b) {
+        return a.get() != b.get();
+    }
 
-    template < typename T >
-    using shared_atomic_ptr = basic_shared_ptr<T, atomic_size_t>;
+    template <typename T, class TPOLICY = shared_count_atomic>
+    using shared_ptr = basic_shared_ptr<T, TPOLICY>;
 
     /**
-     * @brief Make a shared pointer
+     * @brief Make a shared pointer, the object and the control block are in one
+     * allocation of the given allocator.
      * @tparam T Value type of the pointer.
-     * @tparam Args Argument for the object.
+     * @tparam TPOLICY The count policy.
+     * @param alloc The allocator, like squads::memory::malloc_allocator<>.
+     * @param args Argument for the object.
      */
-    template<typename T, typename... Args >
-    inline shared_ptr<T> make_shared(Args&&... args) {
-        return shared_ptr<T>(new T (squads::forward<Args>(args)...) );
+    template <typename T, class TPOLICY = shared_count_atomic, class TALLOCATOR, typename... Args>
+    inline basic_shared_ptr<T, TPOLICY> allocate_shared(const TALLOCATOR& alloc, Args&&... args) {
+        return basic_shared_ptr<T, TPOLICY>::allocate(alloc, squads::forward<Args>(args)...);
     }
 
     /**
-     * @brief Make a shared atomic pointer
+     * @brief Make a shared pointer, in one allocation of the default allocator.
      * @tparam T Value type of the pointer.
-     * @tparam Args Argument for the object.
+     * @tparam TPOLICY The count policy.
+     * @param args Argument for the object.
      */
-    template<typename T, typename... Args >
-    inline shared_atomic_ptr<T> make_atomic_shared(Args&&... args) {
-        return shared_atomic_ptr<T>(new T (squads::forward<Args>(args)...) );
+    template <typename T, class TPOLICY = shared_count_atomic, typename... Args>
+    inline basic_shared_ptr<T, TPOLICY> make_shared(Args&&... args) {
+        return basic_shared_ptr<T, TPOLICY>::allocate(default_allocator<>(), squads::forward<Args>(args)...);
     }
 }
 
-
 #endif
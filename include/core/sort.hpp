@@ -74,13 +74,14 @@ namespace squads {
 
 		SQUADS_TEMPLATE_FULL_DECL_TWO(typename, T, class, TPredicate)
 		void shell_sort(T* data, size_t n, TPredicate pred) {
-			size_t temp, j;
+			size_t j;
+			T temp;
 
 			for (size_t gap = n/2; gap > 0; gap /= 2) {
 				for (size_t i = gap; i < n; i += 1) {
 					temp = data[i];
 
-					for (j = i; j >= gap && pred(arr[j - gap], temp); j -= gap) {
+					for (j = i; j >= gap && pred(data[j - gap], temp); j -= gap) {
 						data[j] = data[j - gap];
 					}
 					data[j] = temp;
@@ -18,11 +18,12 @@
 #ifndef __SQUADS_BASIC_SPINLOCK_H__
 #define __SQUADS_BASIC_SPINLOCK_H__
 
-#include "config.h"
+#include "config.hpp"
 #include "atomic/atomic.hpp"
 #include "copyable.hpp"
 #include "basic_lock.hpp"
 #include "autolock.hpp"
+#include "arch/arch_utils.hpp"
 
 namespace squads {
     /**
@@ -53,18 +54,21 @@ namespace squads {
          *  lock (take) a basic_spinlock 
          *  @param timeout Not use
          */
-        virtual int lock(unsigned int not_use = 0) {
-            while(! m_locked.compare_exchange_t(false, true, atomic::memory_order::Acquire) ) { }
+        virtual int lock(unsigned int not_use = 0) noexcept override {
+            while(! try_lock() ) {
+                // spin local on the cache, until the lock looks free
+                while( m_locked.load(atomic::memory_order::Relaxed) ) { arch::arch_cpu_relax(); }
+            }
             return 0;
         }
 
-        virtual int time_lock(const struct timespec *timeout) {
+        virtual int time_lock(const struct timespec *timeout) noexcept override {
             return lock();
         }
         /**
          *  unlock (give) a basic_spinlock .
          */
-        virtual int unlock() {
+        virtual int unlock() noexcept override {
             m_locked.store(false, atomic::memory_order::Release);
             return 0;
         }
@@ -76,22 +80,27 @@ namespace squads {
          *
          * @return true if the Lock was acquired, false when not
          */
-        virtual bool try_lock() {
-            if( m_locked.compare_exchange_t(false, true, atomic::memory_order::Acquire) )
-                return false;
-            else
-                lock();
-            return true;
+        virtual bool try_lock() noexcept override {
+            bool _expected = false;
+            return m_locked.compare_exchange_strong(_expected, true, atomic::memory_order::Acquire);
         }
         /**
          * Is the basic_spinlock  created (initialized) ?
          *
          * @return true if the basic_spinlock  created (initialized)
          */
-        virtual bool is_initialized() const {
+        virtual bool is_initialized() const override {
             return true;
         }
 
+        /**
+         * @brief Is locked?
+         * @return True if locked and false when not.
+         */
+        virtual bool is_locked() const override {
+            return m_locked.load(atomic::memory_order::Relaxed);
+        }
+
         /**
 		 * @brief Converts the basic_spinlock  to value_type.
 		 * @return The convertet value
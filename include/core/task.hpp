@@ -18,7 +18,7 @@
 #ifndef __SQUADS_TASK_H__
 #define __SQUADS_TASK_H__
 
-#include "config.h"
+#include "config.hpp"
 #include "defines.hpp"
 #include "timespan.hpp"
 #include "queue.hpp"
@@ -243,6 +243,14 @@ namespace squads {
         */
         int				  	join(timespan_t time);
 
+        /**
+         * @brief join the task, Wait in other task to end this task, until the deadline.
+         * @param dl The deadline, the remaining ticks are computed once.
+         * @param token The optional cancellation token.
+         * @return 0 on success, 1 on timeout or error and SQUADS_RESULT_CANCELLED when cancelled
+         */
+        int                 join(const basic_deadline& dl, cancellation_token* token = nullptr);
+
         /**
          * @brief Wait for start the task.
          * @param xTickTimeout The maximum amount of ticks to wait.
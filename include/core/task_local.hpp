@@ -0,0 +1,209 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_TASK_LOCAL_H__
+#define __SQUADS_TASK_LOCAL_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+
+static_assert(SQUADS_CONFIG_TASK_LOCAL_TLS_INDEX >= SQUADS_ARCH_TLS_RESERVED &&
+              SQUADS_CONFIG_TASK_LOCAL_TLS_INDEX < SQUADS_ARCH_TLS_POINTERS,
+              "squads::task_local needs a own native TLS index, above the platform indices: "
+              "raise configNUM_THREAD_LOCAL_STORAGE_POINTERS (CONFIG_FREERTOS_THREAD_LOCAL_STORAGE_POINTERS)");
+
+namespace squads {
+    class task;
+
+    namespace internal {
+        /**
+         * @brief The destroy function of a task_local value.
+         */
+        using task_local_destroy_t = void (*)(void*);
+
+        /**
+         * @brief The per task block of all task_local values.
+         * Stored in the native storage pointer SQUADS_CONFIG_TASK_LOCAL_TLS_INDEX, all
+         * blocks are linked, so a released slot is cleared in all tasks.
+         */
+        struct task_local_block {
+            void* values[SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS];
+            task_local_block* next;
+            task_local_block* prev;
+        };
+
+        /**
+         * @brief Allocate a free task_local slot.
+         * @param destroy The function to destroy a value of the slot.
+         * @return The slot index or -1 when all slots in use.
+         */
+        int task_local_register(task_local_destroy_t destroy);
+
+        /**
+         * @brief Release a slot, the values of all tasks in the slot are destroyed.
+         * @note No task may use the slot at the same time.
+         */
+        void task_local_unregister(int slot);
+
+        /**
+         * @brief Get the task_local block of the current task, the inline fast path.
+         * @return The block or nullptr, when the task has no block yet.
+         */
+        inline task_local_block* task_local_current_block() {
+            return static_cast<task_local_block*>(SQUADS_ARCH_TLS_GET(SQUADS_CONFIG_TASK_LOCAL_TLS_INDEX));
+        }
+
+        /**
+         * @brief Create the task_local block of the current task.
+         * @return The block or nullptr when no memory.
+         */
+        task_local_block* task_local_create_block();
+
+        /**
+         * @brief Destroy all task_local values of a task.
+         * @param t The task or nullptr for the current task.
+         * @note Called from the task stub after on_cleanup and from task::kill.
+         */
+        void task_local_cleanup(task* t);
+    }
+
+    /**
+     * @brief A typed task local value.
+     *
+     * The slot of the object is allocated at static init time, the value of a
+     * task is construct on the first access of the task and destroyed when the task ends.
+     * All values of a task are in one block, the access is one native storage pointer
+     * load and one slot load, inline. The slot is released with the object, the
+     * values of all tasks in the slot are destroyed then.
+     *
+     * @code
+     * static task_local<int> g_errno;
+     *
+     * int my_task::on_task() {
+     *     *g_errno = 0;
+     *     ...
+     * }
+     * @endcode
+     *
+     * @note Values of tasks not created with squads::task are not destroyed.
+     *
+     * @tparam T The type of the value, must be default constructible.
+     *
+     * @ingroup task
+     */
+    template <typename T>
+    class task_local {
+    public:
+        using value_type = T;
+        using self_type = task_local<T>;
+        using pointer = T*;
+        using reference = T&;
+
+        /**
+         * @brief Create the task local object, values are default constructed.
+         */
+        task_local()
+            : m_iSlot(internal::task_local_register(&self_type::destroy)),
+              m_bHasInitial(false), m_tInitial() { }
+
+        /**
+         * @brief Create the task local object, values are copies of the initial value.
+         */
+        explicit task_local(const value_type& initial)
+            : m_iSlot(internal::task_local_register(&self_type::destroy)),
+              m_bHasInitial(true), m_tInitial(initial) { }
+
+        /**
+         * @brief Release the slot and destroy the values of all tasks.
+         * @note No task may use the object at the same time.
+         */
+        ~task_local() {
+            if(m_iSlot >= 0) internal::task_local_unregister(m_iSlot);
+        }
+
+        task_local(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Get the value of the current task, construct it on the first access.
+         * @return The pointer to the value or nullptr if no slot was free.
+         */
+        pointer get() {
+            if(m_iSlot < 0) return nullptr;
+
+            internal::task_local_block* _block = internal::task_local_current_block();
+            if(_block != nullptr && _block->values[m_iSlot] != nullptr)
+                return static_cast<pointer>(_block->values[m_iSlot]);
+
+            return create(_block);
+        }
+
+        /**
+         * @brief Has the current task a value?
+         */
+        bool has_value() const {
+            if(m_iSlot < 0) return false;
+
+            internal::task_local_block* _block = internal::task_local_current_block();
+            return (_block != nullptr) && (_block->values[m_iSlot] != nullptr);
+        }
+
+        /**
+         * @brief Destroy the value of the current task.
+         */
+        void reset() {
+            if(m_iSlot < 0) return;
+
+            internal::task_local_block* _block = internal::task_local_current_block();
+            if(_block == nullptr) return;
+
+            destroy(_block->values[m_iSlot]);
+            _block->values[m_iSlot] = nullptr;
+        }
+
+        /**
+         * @brief Get the slot index of this object, -1 if no slot was free.
+         */
+        int get_slot() const { return m_iSlot; }
+
+        reference operator * ()   { return *get(); }
+        pointer   operator -> ()  { return get(); }
+    private:
+        /**
+         * @brief The slow path of get: create the block and the value.
+         */
+        pointer create(internal::task_local_block* block) {
+            if(block == nullptr) block = internal::task_local_create_block();
+            if(block == nullptr) return nullptr;
+
+            pointer _value = m_bHasInitial ? new value_type(m_tInitial) : new value_type();
+            block->values[m_iSlot] = _value;
+
+            return _value;
+        }
+
+        static void destroy(void* value) {
+            delete static_cast<pointer>(value);
+        }
+    private:
+        int m_iSlot;
+        bool m_bHasInitial;
+        value_type m_tInitial;
+    };
+}
+
+#endif
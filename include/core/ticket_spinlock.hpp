@@ -0,0 +1,107 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_TICKET_SPINLOCK_H__
+#define __SQUADS_TICKET_SPINLOCK_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "backoff.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    /**
+     * @brief A fair (FIFO) ticket spinlock.
+     *
+     * Each locker draws a ticket and spins until his ticket is served, so the
+     * lock is granted in the order of the lock calls.
+     *
+     * @note Spin only for short sections. When the owner can be preempted on the
+     * same core, use the yield_backoff.
+     *
+     * @tparam TBACKOFF The backoff policy of the spin loop.
+     *
+     * @ingroup lock
+     */
+    template <class TBACKOFF = pause_backoff>
+    class basic_ticket_spinlock {
+    public:
+        using self_type = basic_ticket_spinlock<TBACKOFF>;
+        using backoff_type = TBACKOFF;
+
+        basic_ticket_spinlock() : m_uiNext(0), m_uiServing(0) { }
+
+        basic_ticket_spinlock(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        /**
+         * @brief Lock the spinlock.
+         * @param not_use Not use, for basic_autolock
+         * @return 0
+         */
+        int lock(unsigned int not_use = 0) {
+            uint32_t _ticket = m_uiNext.fetch_add(1, atomic::memory_order::Relaxed);
+            backoff_type _backoff;
+
+            while(m_uiServing.load(atomic::memory_order::Acquire) != _ticket)
+                _backoff.pause();
+
+            return 0;
+        }
+
+        /**
+         * @brief Try to lock the spinlock, without waiting.
+         * @return true if the lock was acquired.
+         */
+        bool try_lock() {
+            uint32_t _serving = m_uiServing.load(atomic::memory_order::Acquire);
+            uint32_t _expected = _serving;
+
+            return m_uiNext.compare_exchange_strong(_expected, _serving + 1, atomic::memory_order::Acquire);
+        }
+
+        /**
+         * @brief Unlock the spinlock, the next ticket is served.
+         * @return 0
+         */
+        int unlock() {
+            m_uiServing.store(m_uiServing.load(atomic::memory_order::Relaxed) + 1,
+                atomic::memory_order::Release);
+            return 0;
+        }
+
+        bool is_locked() const {
+            return m_uiNext.load(atomic::memory_order::Relaxed) !=
+                   m_uiServing.load(atomic::memory_order::Relaxed);
+        }
+
+        /**
+         * @brief Get the number of waiting lockers, the owner included.
+         */
+        uint32_t get_queue_length() const {
+            return m_uiNext.load(atomic::memory_order::Relaxed) -
+                   m_uiServing.load(atomic::memory_order::Relaxed);
+        }
+    private:
+        atomic::basic_atomic_gcc<uint32_t> m_uiNext;
+        atomic::basic_atomic_gcc<uint32_t> m_uiServing;
+    };
+
+    using ticket_spinlock = basic_ticket_spinlock<>;
+}
+
+#endif
@@ -158,7 +158,7 @@ namespace squads  {
 		time_type m_time;
 	};
 
-	void swap(basic_timestamp a, basic_timestamp b) {
+	inline void swap(basic_timestamp& a, basic_timestamp& b) {
 		a.swap(b);
 	}
 
@@ -98,7 +98,7 @@ namespace squads {
 
         SQUADS_TEMPLATE_FULL_DECL_ONE(typename, T)
         void destruct_n(T* first, squads::size_t n, int_to_type<false>) {
-            sizeof(first);
+            (void)sizeof(first);
             for (size_t i = 0; i < n; ++i)
                     (first + i)->~T();
         }
@@ -110,7 +110,7 @@ namespace squads {
 
         SQUADS_TEMPLATE_FULL_DECL_ONE(typename, T)
         void destruct(T* mem, int_to_type<false>) {
-            sizeof(mem);
+            (void)sizeof(mem);
             mem->~T();
         }
 
@@ -153,7 +153,7 @@ namespace squads {
 
         SQUADS_TEMPLATE_FULL_DECL_TWO(class, TIter, class, TPred)
         void test_ordering(TIter first, TIter last, const TPred& pred) {
-        	sizeof(first); sizeof(last); sizeof(pred);
+        	(void)sizeof(first); (void)sizeof(last); (void)sizeof(pred);
         }
 
         SQUADS_TEMPLATE_FULL_DECL_THREE(typename, T1, typename, T2, class, TPred)
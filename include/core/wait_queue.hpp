@@ -0,0 +1,265 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_WAIT_QUEUE_H__
+#define __SQUADS_WAIT_QUEUE_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "deadline.hpp"
+#include "cancellation_token.hpp"
+#include "arch/arch_utils.hpp"
+
+namespace squads {
+    /**
+     * @brief A waiting task in a wait_queue, lives on the stack of the waiting task.
+     */
+    struct wait_node {
+        enum {
+            state_idle = 0,     /*!< not in a queue */
+            state_waiting = 1,  /*!< in the queue, the task is parked or will park */
+            state_woken = 2,    /*!< removed by a waker, the waker still reads the node */
+            state_done = 3      /*!< the waker is done with the node, the waiter may return */
+        };
+
+        void* task;
+        wait_node* next;
+        wait_node* prev;
+        /**
+         * A key for sub queues, like the address in the parking lot.
+         */
+        uintptr_t key;
+        /**
+         * Data of the waiter, like the wanted count of a semaphore.
+         */
+        uintptr_t data;
+        volatile uint32_t state;
+
+        wait_node()
+            : task(arch::arch_get_current_task()), next(nullptr), prev(nullptr),
+              key(0), data(0), state(state_idle) { }
+
+        wait_node(const wait_node&) = delete;
+        wait_node& operator = (const wait_node&) = delete;
+    };
+
+    /**
+     * @brief A intrusive FIFO queue of parked tasks, the base of the blocking primitives.
+     *
+     * The queue is protected by a short arch mux. The check of the primitive state
+     * and the push of the node must be done under the lock, so no wake up is lost.
+     *
+     * A waiter returns only, when its node is state_done: the waker stores it with
+     * release, after the last read of the node, and unparks after it. A notification
+     * of other code on the same notify index (task::notify, a mailbox) never lets
+     * the waiter return and free the node, while a waker walks a chain over it.
+     *
+     * @code
+     * // waiter
+     * wait_node node;
+     * queue.lock();
+     * if(state_is_free()) { queue.unlock(); return; }
+     * queue.push_back(&node);
+     * bool woken = queue.wait(node, timeout); // unlocks the queue
+     *
+     * // waker of one
+     * queue.lock();
+     * void* task = queue.pop_front();
+     * queue.unlock();
+     * wait_queue::unpark(task);
+     *
+     * // waker of a chain
+     * queue.lock();
+     * wait_node* chain = nullptr;
+     * while(!queue.empty()) { wait_node* n = queue.front(); queue.pop(n); n->next = chain; chain = n; }
+     * queue.unlock();
+     * wait_queue::wake_chain(chain);
+     * @endcode
+     */
+    class wait_queue {
+    public:
+        using self_type = wait_queue;
+
+        wait_queue() : m_pHead(nullptr), m_pTail(nullptr) {
+            arch::arch_mux_init(&m_mux);
+        }
+
+        wait_queue(const self_type&) = delete;
+        self_type& operator = (const self_type&) = delete;
+
+        void lock()     { arch::arch_mux_lock(&m_mux); }
+        void unlock()   { arch::arch_mux_unlock(&m_mux); }
+
+        /**
+         * @brief Add a node at the end of the queue.
+         * @note Hold the lock.
+         */
+        void push_back(wait_node* node) {
+            node->state = wait_node::state_waiting;
+            node->next = nullptr;
+            node->prev = m_pTail;
+
+            if(m_pTail != nullptr) m_pTail->next = node;
+            else m_pHead = node;
+            m_pTail = node;
+        }
+
+        /**
+         * @brief Remove the first node and mark it done, the node is not touched after.
+         * @note Hold the lock, call unpark with the result after unlock.
+         * @return The native task handle of the node or nullptr when empty.
+         */
+        void* pop_front() {
+            wait_node* _node = m_pHead;
+            if(_node == nullptr) return nullptr;
+
+            unlink(_node);
+            void* _task = _node->task;
+            __atomic_store_n(&_node->state, uint32_t(wait_node::state_done), __ATOMIC_RELEASE);
+
+            return _task;
+        }
+
+        /**
+         * @brief Remove a given waiting node and mark it woken, the node stays valid
+         * for the waker (the next pointer can link a chain) until wake.
+         * @note Hold the lock, call wake or wake_chain after unlock.
+         */
+        void pop(wait_node* node) {
+            unlink(node);
+            node->state = wait_node::state_woken;
+        }
+
+        /**
+         * @brief Remove a waiting node, on timeout or cancel.
+         * @note Hold the lock.
+         * @return true if removed and false when the node was already woken.
+         */
+        bool remove(wait_node* node) {
+            if(node->state != wait_node::state_waiting) return false;
+
+            unlink(node);
+            node->state = wait_node::state_idle;
+            return true;
+        }
+
+        /**
+         * @brief Get the first node.
+         * @note Hold the lock.
+         */
+        wait_node* front() const { return m_pHead; }
+
+        /**
+         * @brief Is the queue empty?
+         * @note Hold the lock for a exact value.
+         */
+        bool empty() const { return m_pHead == nullptr; }
+
+        /**
+         * @brief Unlock the queue and park, until the node is woken or the timeout.
+         * @note Hold the lock and push the node before, returns unlocked.
+         * @param node The pushed node of the current task.
+         * @param timeout How long to wait in ticks.
+         * @return true if woken and false on timeout or cancel.
+         */
+        bool wait(wait_node& node, unsigned int timeout) {
+            unlock();
+            return park(node, timeout);
+        }
+
+        /**
+         * @brief Park until the node is woken or the timeout.
+         * @note The node must be pushed before and the queue unlocked, a wake up
+         * between the unlock and the park is not lost.
+         * @param node The pushed node of the current task.
+         * @param timeout How long to wait in ticks.
+         * @return true if woken and false on timeout or cancel.
+         */
+        bool park(wait_node& node, unsigned int timeout) {
+            basic_deadline _dl = basic_deadline::from_ticks(timeout);
+
+            for(;;) {
+                bool _notified = arch::arch_park(_dl.remaining_ticks());
+                if(is_done(node)) return true;
+
+                // a foreign notification on a shared notify index parks again,
+                // the notification of a cancel leaves like a timeout
+                if(_notified && !cancellation_scope::current_cancelled()) continue;
+
+                lock();
+                bool _removed = remove(&node);
+                unlock();
+
+                if(_removed) return false;
+
+                // woken at the same time, the waker may still read the node
+                while(!is_done(node)) arch::arch_park(SQUADS_PORTMAX_DELAY);
+                return true;
+            }
+        }
+
+        /**
+         * @brief Unpark the task of a pop_front.
+         */
+        static void unpark(void* task) {
+            if(task != nullptr) arch::arch_unpark(task);
+        }
+
+        /**
+         * @brief Release a popped node to its waiter and unpark it.
+         * @note The node may be gone after the call.
+         */
+        static void wake(wait_node* node) {
+            void* _task = node->task;
+
+            __atomic_store_n(&node->state, uint32_t(wait_node::state_done), __ATOMIC_RELEASE);
+            unpark(_task);
+        }
+
+        /**
+         * @brief Wake a chain of popped nodes, linked by next.
+         */
+        static void wake_chain(wait_node* chain) {
+            while(chain != nullptr) {
+                wait_node* _next = chain->next;
+                wake(chain);
+                chain = _next;
+            }
+        }
+    private:
+        static bool is_done(const wait_node& node) {
+            return __atomic_load_n(&node.state, __ATOMIC_ACQUIRE) == wait_node::state_done;
+        }
+
+        void unlink(wait_node* node) {
+            if(node->prev != nullptr) node->prev->next = node->next;
+            else m_pHead = node->next;
+
+            if(node->next != nullptr) node->next->prev = node->prev;
+            else m_pTail = node->prev;
+
+            node->next = nullptr;
+            node->prev = nullptr;
+        }
+    private:
+        arch::arch_mux_t m_mux;
+        wait_node* m_pHead;
+        wait_node* m_pTail;
+    };
+}
+
+#endif
@@ -15,119 +15,132 @@
 *License along with the SQUADS  Library; if not, see
 *<https://www.gnu.org/licenses/>.
 */
-#ifndef __SQUADS_AUTO_PTR_H__
-#define __SQUADS_AUTO_PTR_H__
+#ifndef __SQUADS_WEAK_PTR_H__
+#define __SQUADS_WEAK_PTR_H__
 
 #include "config.hpp"
 #include "defines.hpp"
 #include "functional.hpp"
-#include "atomic/atomic.hpp"
+#include "shared_ptr.hpp"
 
 namespace squads {
-        template <typename T, typename TRefType = atomic::atomic_size_t >
-        class basic_weak_ptr {
-        public:
-            using value_type = T;
-            using element_type = T;
-            using reference = T&;
-            using const_value_type = const value_type;
-            using pointer = value_type*;
-            using count_type = TRefType;
-
-
-            using self_type = basic_weak_ptr<value_type, count_type>;
-            using shared_type = basic_shared_ptr<value_type, count_type>;
-
-
-            explicit basic_weak_ptr(value_type pValue = 0)
-                : m_ptr(pValue), m_ref(1)  { }
-
-            basic_weak_ptr( const self_type& r )
-                : m_ptr(r.m_ptr), m_ref(r.m_ref)  { }
-
-            basic_weak_ptr( shared_type& pShrd)
-                : m_ptr(pShrd.get()), m_ref( pShrd.ref() ) {}
-
-            template<class U, typename YRefType = count_type>
-            basic_weak_ptr( const basic_weak_ptr<U, YRefType>& r )
-                : m_ptr(r.m_ptr), m_ref(r.m_ref)  { }
-
-            template<class U, typename YRefType = count_type>
-            basic_weak_ptr( const basic_shared_ptr<U, YRefType>& pShrd)
-                : m_ptr(pShrd.get()), m_ref(pShrd.ref() ) {}
-
-            shared_type lock()                          { return shared_type(m_ptr); }
-            bool expired()                              { return m_ref.get() == 0; }
-            void reset()                                { self_type(0).swap(*this); }
-
-            count_type use_count()                  	{ return m_ref.get(); }
-
-            void swap(self_type& other) {
-                squads::swap<pointer>(m_ptr, other.m_ptr);
-                squads::swap<count_type >(m_ref, other.m_ref);
-            }
-            template<class Y, typename YRefType = atomic_size_t>
-            bool owner_before( const basic_weak_ptr<Y, YRefType> & rhs ) {
-                return m_ref < rhs.m_ref;
-            }
-            template<class Y, typename YRefType = atomic_size_t>
-            bool owner_before( const basic_shared_ptr<Y, YRefType> & rhs ) {
-                return m_ref < rhs.ref();
-            }
-
-            pointer get() const {
-		        return static_cast<T*>(m_ptr);
-	        }
-
-            pointer operator->() const {
-                assert(get() != 0);
-                return this->get();
-            }
-            const_value_type& operator*() {
-                assert(get() != 0);
-                return *this->get();
-            }
-
-            operator bool() {
-                return m_ptr != 0;
-            }
-
-            self_type& operator=( const self_type& r ) {
-                m_ptr = r.m_ptr;
-                m_ref = r.m_ref;
-                return *this;
-            }
-        private:
-        	pointer m_ptr;
-            count_type m_ref;
-        };
-
-        template < typename T >
-		using weak_ptr = basic_weak_ptr<T, size_t>;
-
-		template < typename T >
-		using weak_atomic_ptr = basic_weak_ptr<T, atomic_size_t>;
-
-		/**
-		 * @brief Make a weak pointer
-		 * @tparam T Value type of the pointer.
-		 * @tparam Args Argument for the object.
-		 */
-		template<typename T, typename... Args >
-		inline weak_ptr<T>  make_weak(Args&&... args) {
-			return weak_ptr<T>(new T (squads::forward<Args>(args)...) );
-		}
-
-		/**
-		 * @brief Make a weak atomic pointer
-		 * @tparam T Value type of the pointer.
-		 * @tparam Args Argument for the object.
-		 */
-		template<typename T, typename... Args >
-		inline weak_atomic_ptr<T> make_atomic_weak(Args&&... args) {
-			return weak_atomic_ptr<T>(new T (squads::forward<Args>(args)...) );
-		}
+    /**
+     * @brief A weak pointer, that observes a object of shared pointers without ownership.
+     *
+     * The weak pointer holds the control block, but not the object: use lock to get a
+     * shared pointer, that is empty when the object was destroyed.
+     *
+     * @tparam T The type of the object.
+     * @tparam TPOLICY The count policy: shared_count_atomic or shared_count_single.
+     */
+    template <typename T, class TPOLICY = shared_count_atomic>
+    class basic_weak_ptr {
+        template <typename U, class UPOLICY> friend class basic_shared_ptr;
+        template <typename U, class UPOLICY> friend class basic_weak_ptr;
+    public:
+        using value_type = T;
+        using element_type = T;
+        using pointer = value_type*;
+        using policy_type = TPOLICY;
+        using control_type = internal::basic_shared_control<policy_type>;
+
+        using self_type = basic_weak_ptr<value_type, policy_type>;
+        using shared_type = basic_shared_ptr<value_type, policy_type>;
+
+        constexpr basic_weak_ptr() noexcept : m_ptr(nullptr), m_pControl(nullptr) { }
+
+        template <typename U>
+        basic_weak_ptr(const basic_shared_ptr<U, policy_type>& shared) noexcept
+            : m_ptr(shared.m_ptr), m_pControl(shared.m_pControl) {
+            if(m_pControl != nullptr) m_pControl->add_weak();
+        }
+
+        basic_weak_ptr(const self_type& other) noexcept
+            : m_ptr(other.m_ptr), m_pControl(other.m_pControl) {
+            if(m_pControl != nullptr) m_pControl->add_weak();
+        }
+
+        template <typename U>
+        basic_weak_ptr(const basic_weak_ptr<U, policy_type>& other) noexcept
+            : m_ptr(other.m_ptr), m_pControl(other.m_pControl) {
+            if(m_pControl != nullptr) m_pControl->add_weak();
+        }
+
+        basic_weak_ptr(self_type&& other) noexcept
+            : m_ptr(other.m_ptr), m_pControl(other.m_pControl) {
+            other.m_ptr = nullptr;
+            other.m_pControl = nullptr;
+        }
+
+        ~basic_weak_ptr() {
+            if(m_pControl != nullptr) m_pControl->release_weak();
+        }
+
+        self_type& operator = (const self_type& other) noexcept {
+            self_type(other).swap(*this);
+            return *this;
+        }
+
+        self_type& operator = (self_type&& other) noexcept {
+            self_type(squads::move(other)).swap(*this);
+            return *this;
+        }
+
+        template <typename U>
+        self_type& operator = (const basic_shared_ptr<U, policy_type>& shared) noexcept {
+            self_type(shared).swap(*this);
+            return *this;
+        }
+
+        /**
+         * @brief Get a shared pointer of the object.
+         * @return The shared pointer or a empty pointer, when the object was destroyed.
+         */
+        shared_type lock() const noexcept {
+            if(m_pControl == nullptr || !m_pControl->add_ref_not_zero()) return shared_type();
+
+            return shared_type::adopt(m_ptr, m_pControl);
+        }
+
+        /**
+         * @brief Is the object destroyed?
+         */
+        bool expired() const noexcept           { return use_count() == 0; }
+
+        /**
+         * @brief Get the count of the shared pointers of the object.
+         */
+        uint32_t use_count() const noexcept {
+            return (m_pControl != nullptr) ? m_pControl->use_count() : 0;
+        }
+
+        void reset() noexcept                   { self_type().swap(*this); }
+
+        void swap(self_type& other) noexcept {
+            squads::swap<pointer>(m_ptr, other.m_ptr);
+            squads::swap<control_type*>(m_pControl, other.m_pControl);
+        }
+
+        template <typename U, class UPOLICY>
+        bool owner_before(const basic_weak_ptr<U, UPOLICY>& other) const noexcept {
+            return m_pControl < other.m_pControl;
+        }
+        template <typename U, class UPOLICY>
+        bool owner_before(const basic_shared_ptr<U, UPOLICY>& other) const noexcept {
+            return m_pControl < other.m_pControl;
+        }
+    private:
+        pointer m_ptr;
+        control_type* m_pControl;
+    };
+
+    template <typename T, class TPOLICY>
+    void swap(basic_weak_ptr<T, TPOLICY>& a, basic_weak_ptr<T, TPOLICY>& b) {
+        a.swap(b);
     }
 
+    template <typename T, class TPOLICY = shared_count_atomic>
+    using weak_ptr = basic_weak_ptr<T, TPOLICY>;
+}
 
 #endif
@@ -94,7 +94,7 @@ namespace squads {
 			 * @param alignment
 			 * @return Pointer to new memory, or NULL if allocation fails.
 			 */
-			pointer allocate(size_t count, size_t size, size_t alignment = 0) {
+			pointer allocate(size_t count, size_t size, size_t alignment) {
 				return allocate(count * size, (alignment == 0) ? squads::alignment_for(size) : alignment);
 			}
 
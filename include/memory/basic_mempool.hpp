@@ -0,0 +1,317 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_BASIC_MEMPOOL_H__
+#define __SQUADS_BASIC_MEMPOOL_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "basic_storage.hpp"
+#include "basic_lock_storage.hpp"
+#include "allocator_typetraits.hpp"
+#include "free_list.hpp"
+#include "core/type_traits.hpp"
+
+namespace squads {
+    namespace memory {
+		namespace internal {
+			/**
+			 * @brief The layout of the blocks of a mempool.
+			 *
+			 * Without magic a block is only the payload, the link of a free block is stored
+			 * in the payload. With SQUADS_CONFIG_MEMPOOL_USE_MAGIC each block has a header
+			 * with the start magic and the state (SQUADS_CONFIG_FREELIST_MEMPOOL_FREE or
+			 * SQUADS_CONFIG_FREELIST_MEMPOOL_USED) and the end magic after the payload.
+			 */
+			template <size_t TBLOCKSIZE, size_t TBLOCKCOUNT>
+			struct mempool_layout {
+				static_assert(TBLOCKSIZE > 0 && TBLOCKCOUNT > 0, "squads::mempool requires blocks");
+
+				static constexpr size_t alignment = squads::max_alignment;
+				static constexpr size_t payload = (TBLOCKSIZE < sizeof(free_block)) ? sizeof(free_block) : TBLOCKSIZE;
+#if SQUADS_CONFIG_MEMPOOL_USE_MAGIC == SQUADS_CONFIG_YES
+				static constexpr size_t header = alignment;
+				static constexpr size_t stride = (header + payload + 1 + alignment - 1) & ~(alignment - 1);
+#else
+				static constexpr size_t header = 0;
+				static constexpr size_t stride = (payload + alignment - 1) & ~(alignment - 1);
+#endif
+				static constexpr size_t size = stride * TBLOCKCOUNT;
+
+				static void* at(uint8_t* buffer, size_t index) {
+					return buffer + index * stride + header;
+				}
+
+				/**
+				 * @brief Is the pointer the payload of a block of the buffer?
+				 */
+				static bool contains(const uint8_t* buffer, const void* ptr) {
+					const uint8_t* _ptr = static_cast<const uint8_t*>(ptr);
+					if(_ptr < buffer + header || _ptr >= buffer + size) return false;
+
+					return (size_t(_ptr - buffer) % stride) == header;
+				}
+
+				/**
+				 * @brief Write the magic and the free state of a new block.
+				 */
+				static void init(void* ptr) {
+#if SQUADS_CONFIG_MEMPOOL_USE_MAGIC == SQUADS_CONFIG_YES
+					uint8_t* _block = static_cast<uint8_t*>(ptr) - header;
+
+					_block[0] = SQUADS_CONFIG_MEMPOOL_MAGIC_START;
+					_block[1] = SQUADS_CONFIG_FREELIST_MEMPOOL_FREE;
+					_block[header + payload] = SQUADS_CONFIG_MEMPOOL_MAGIC_END;
+#else
+					(void)ptr;
+#endif
+				}
+
+				/**
+				 * @brief Mark a allocated block used.
+				 */
+				static void acquire(void* ptr) {
+#if SQUADS_CONFIG_MEMPOOL_USE_MAGIC == SQUADS_CONFIG_YES
+					uint8_t* _block = static_cast<uint8_t*>(ptr) - header;
+					__atomic_store_n(&_block[1], uint8_t(SQUADS_CONFIG_FREELIST_MEMPOOL_USED), __ATOMIC_RELAXED);
+#else
+					(void)ptr;
+#endif
+				}
+
+				/**
+				 * @brief Check the magic of a freed block and mark it free.
+				 * @return false when the magic is broken or the block is not used (double free).
+				 */
+				static bool release(void* ptr) {
+#if SQUADS_CONFIG_MEMPOOL_USE_MAGIC == SQUADS_CONFIG_YES
+					uint8_t* _block = static_cast<uint8_t*>(ptr) - header;
+
+					if(_block[0] != SQUADS_CONFIG_MEMPOOL_MAGIC_START) return false;
+					if(_block[header + payload] != SQUADS_CONFIG_MEMPOOL_MAGIC_END) return false;
+
+					// only one of two racing frees wins
+					uint8_t _used = SQUADS_CONFIG_FREELIST_MEMPOOL_USED;
+					return __atomic_compare_exchange_n(&_block[1], &_used, uint8_t(SQUADS_CONFIG_FREELIST_MEMPOOL_FREE),
+													   false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+#else
+					(void)ptr;
+					return true;
+#endif
+				}
+			};
+		}
+
+		/**
+		 * @brief A pool of TBLOCKCOUNT fixed size blocks in a static buffer, a allocator
+		 * impl for basic_storage and basic_lock_storage.
+		 *
+		 * Allocate and free are O(1): the free blocks are linked in a list, the link is
+		 * stored in the free block self. The blocks are aligned to squads::max_alignment,
+		 * a request bigger than TBLOCKSIZE, or with a bigger alignment, returns nullptr.
+		 *
+		 * @code
+		 * using msg_allocator = mempool_allocator_safe<sizeof(message), 32, mutex>;
+		 *
+		 * msg_allocator alloc;
+		 * message* msg = alloc.construct<message>();
+		 * ...
+		 * alloc.destroy(msg);
+		 * @endcode
+		 *
+		 * @note All users with the same TBLOCKSIZE and TBLOCKCOUNT share the same pool.
+		 * @note Not thread safe, use mempool_allocator_safe or mempool_allocator_lockfree.
+		 * @note With SQUADS_CONFIG_MEMPOOL_USE_MAGIC each block is guarded with magic bytes,
+		 * a free of a broken or not used block is not done and counted in get_corrupted().
+		 *
+		 * @tparam TBLOCKSIZE The size of a block in bytes.
+		 * @tparam TBLOCKCOUNT The count of blocks.
+		 */
+		template <size_t TBLOCKSIZE, size_t TBLOCKCOUNT>
+		class basic_mempool {
+		public:
+			using allocator_category = std_allocator_tag();
+			using is_thread_safe = ::squads::false_type;
+			using layout_type = internal::mempool_layout<TBLOCKSIZE, TBLOCKCOUNT>;
+
+			static void first() noexcept { get_pool(); }
+
+			static void* allocate(size_t size, size_t alignment) noexcept {
+				if(size > TBLOCKSIZE || alignment > layout_type::alignment) return nullptr;
+
+				pool& _pool = get_pool();
+				free_block* _block = _pool.head;
+				if(_block == nullptr) return nullptr;
+
+				_pool.head = _block->next;
+				_pool.free--;
+				layout_type::acquire(_block);
+
+				return _block;
+			}
+
+			static void deallocate(void* ptr, size_t size, size_t alignment) noexcept {
+				if(ptr == nullptr) return;
+
+				pool& _pool = get_pool();
+				if(!layout_type::contains(_pool.buffer, ptr) || !layout_type::release(ptr)) {
+					_pool.corrupted++;
+					return;
+				}
+				free_block* _block = static_cast<free_block*>(ptr);
+
+				_block->next = _pool.head;
+				_pool.head = _block;
+				_pool.free++;
+			}
+
+			static size_t max_node_size()  {
+				return TBLOCKSIZE;
+			}
+			static size_t get_max_alocator_size()  {
+				return TBLOCKSIZE;
+			}
+
+			/**
+			 * @brief Get the count of free blocks.
+			 */
+			static size_t get_free() { return get_pool().free; }
+
+			/**
+			 * @brief Get the count of rejected frees, of foreign, broken or not used blocks.
+			 */
+			static size_t get_corrupted() { return get_pool().corrupted; }
+		private:
+			struct pool {
+				alignas(layout_type::alignment) uint8_t buffer[layout_type::size];
+				free_block* head;
+				size_t free;
+				size_t corrupted;
+
+				pool() : buffer{ }, head(nullptr), free(TBLOCKCOUNT), corrupted(0) {
+					// link from the end, so the first block is allocated first
+					for(size_t i = TBLOCKCOUNT; i > 0; i--) {
+						free_block* _block = static_cast<free_block*>(layout_type::at(buffer, i - 1));
+
+						layout_type::init(_block);
+						_block->next = head;
+						head = _block;
+					}
+				}
+			};
+
+			static pool& get_pool() {
+				static pool _pool;
+				return _pool;
+			}
+		};
+
+		/**
+		 * @brief The lock free variant of basic_mempool, the free blocks are in a free_list.
+		 *
+		 * Allocate and free can be used from more tasks and ISRs at the same time,
+		 * without a lock.
+		 *
+		 * @note The free list needs a 64 bit compare exchange, without the native
+		 * instruction it falls back to the lock stripes of the atomics (see is_lock_free).
+		 *
+		 * @tparam TBLOCKSIZE The size of a block in bytes.
+		 * @tparam TBLOCKCOUNT The count of blocks.
+		 */
+		template <size_t TBLOCKSIZE, size_t TBLOCKCOUNT>
+		class basic_mempool_lockfree {
+		public:
+			using allocator_category = std_allocator_tag();
+			using is_thread_safe = ::squads::true_type;
+			using layout_type = internal::mempool_layout<TBLOCKSIZE, TBLOCKCOUNT>;
+
+			static void first() noexcept { get_pool(); }
+
+			static void* allocate(size_t size, size_t alignment) noexcept {
+				if(size > TBLOCKSIZE || alignment > layout_type::alignment) return nullptr;
+
+				void* _block = get_pool().list.allocate();
+				if(_block != nullptr) layout_type::acquire(_block);
+
+				return _block;
+			}
+
+			static void deallocate(void* ptr, size_t size, size_t alignment) noexcept {
+				if(ptr == nullptr) return;
+
+				pool& _pool = get_pool();
+				if(!layout_type::contains(_pool.buffer, ptr) || !layout_type::release(ptr)) {
+					_pool.corrupted.fetch_add(1, atomic::memory_order::Relaxed);
+					return;
+				}
+				_pool.list.deallocate(ptr);
+			}
+
+			static size_t max_node_size()  {
+				return TBLOCKSIZE;
+			}
+			static size_t get_max_alocator_size()  {
+				return TBLOCKSIZE;
+			}
+
+			/**
+			 * @brief Get the count of free blocks, only a snapshot.
+			 */
+			static size_t get_free() { return get_pool().list.get_count(); }
+
+			/**
+			 * @brief Get the count of rejected frees, of foreign, broken or not used blocks.
+			 */
+			static size_t get_corrupted() {
+				return get_pool().corrupted.load(atomic::memory_order::Relaxed);
+			}
+
+			static bool is_lock_free() { return get_pool().list.is_lock_free(); }
+		private:
+			struct pool {
+				alignas(layout_type::alignment) uint8_t buffer[layout_type::size];
+				free_list list;
+				atomic::basic_atomic_gcc<uint32_t> corrupted;
+
+				pool() : buffer{ }, list(), corrupted(0) {
+					for(size_t i = TBLOCKCOUNT; i > 0; i--) {
+						void* _block = layout_type::at(buffer, i - 1);
+
+						layout_type::init(_block);
+						list.deallocate(_block);
+					}
+				}
+			};
+
+			static pool& get_pool() {
+				static pool _pool;
+				return _pool;
+			}
+		};
+
+		template <size_t TBLOCKSIZE, size_t TBLOCKCOUNT, class TFilter = basic_allocator_filter>
+		using mempool_allocator = basic_storage<basic_mempool<TBLOCKSIZE, TBLOCKCOUNT>, TFilter>;
+
+		template <size_t TBLOCKSIZE, size_t TBLOCKCOUNT, class TMutex, class TFilter = basic_allocator_filter>
+		using mempool_allocator_safe = basic_lock_storage<TMutex, basic_mempool<TBLOCKSIZE, TBLOCKCOUNT>, TFilter>;
+
+		template <size_t TBLOCKSIZE, size_t TBLOCKCOUNT, class TFilter = basic_allocator_filter>
+		using mempool_allocator_lockfree = basic_storage<basic_mempool_lockfree<TBLOCKSIZE, TBLOCKCOUNT>, TFilter>;
+    }
+}
+
+#endif
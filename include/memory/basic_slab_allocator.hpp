@@ -0,0 +1,351 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_BASIC_SLAB_ALLOCATOR_H__
+#define __SQUADS_BASIC_SLAB_ALLOCATOR_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "basic_storage.hpp"
+#include "basic_malloc_allocator.hpp"
+#include "allocator_typetraits.hpp"
+#include "free_list.hpp"
+#include "arch/arch_utils.hpp"
+#include "core/task_local.hpp"
+#include "core/sharded_counter.hpp"
+#include "core/type_traits.hpp"
+
+namespace squads {
+    namespace memory {
+		namespace internal {
+			/**
+			 * @brief Get the size of a slab size class: 8, 12, 16, 24, 32, 48, 64, ...
+			 */
+			constexpr size_t slab_class_size(int index) {
+				return (index & 1) ? (size_t(12) << (index >> 1)) : (size_t(8) << (index >> 1));
+			}
+
+			/**
+			 * @brief Get the smallest slab size class for a size.
+			 */
+			constexpr int slab_class_of(size_t size) {
+				if(size <= 8) return 0;
+
+				int _bit = int(sizeof(unsigned long) * 8 - 1) - __builtin_clzl((unsigned long)(size - 1));
+
+				if(size <= (size_t(3) << (_bit - 1))) return 2 * (_bit - 3) + 1;
+				return 2 * (_bit - 2);
+			}
+		}
+
+		/**
+		 * @brief The statistic of a slab size class.
+		 */
+		struct slab_stats {
+			/** The size of the objects of the class */
+			size_t size;
+			/** The count of allocations */
+			uint32_t allocations;
+			/** The count of frees */
+			uint32_t frees;
+			/** The count of pages, taken from the backing allocator */
+			uint32_t pages;
+			/** The count of free objects in the depot, without the magazines */
+			uint32_t depot;
+			/** The count of magazine refills from the depot */
+			uint32_t refills;
+			/** The count of magazine drains to the depot */
+			uint32_t drains;
+		};
+
+		/**
+		 * @brief A slab allocator with size classes and per task magazines, a allocator
+		 * impl for basic_storage.
+		 *
+		 * The requests are rounded up to a size class (8, 12, 16, 24, 32, 48, ... up to
+		 * SQUADS_CONFIG_SLAB_MAX_SIZE), bigger requests go to the backing allocator.
+		 * Each task has a magazine of free objects per size class, allocate and free
+		 * on the magazine take no lock and touch no shared memory. A empty magazine is
+		 * refilled from the lock free depot of the class and a full one is drained to
+		 * it, both in batches of the half magazine. A empty depot is filled with a new
+		 * slab page from the backing allocator.
+		 *
+		 * @code
+		 * slab_allocator<> alloc;
+		 *
+		 * message* msg = alloc.construct<message>();
+		 * ...
+		 * alloc.destroy(msg);
+		 * @endcode
+		 *
+		 * @note The size and the alignment of a free must be the same as on the allocate.
+		 * @note The pages are never given back to the backing allocator.
+		 * @note A ISR uses the depot direct and gets nullptr, when the depot is empty.
+		 * @note The magazines of a task are drained, when the task (a squads::task) ends.
+		 *
+		 * @tparam TBACKING The allocator impl for the pages and the big requests.
+		 */
+		template <class TBACKING = basic_malloc_allocaor_impl>
+		class basic_slab {
+		public:
+			using allocator_category = std_allocator_tag();
+			using is_thread_safe = ::squads::true_type;
+			using backing_type = TBACKING;
+
+			static constexpr int class_count = internal::slab_class_of(SQUADS_CONFIG_SLAB_MAX_SIZE) + 1;
+			static constexpr size_t max_size = internal::slab_class_size(class_count - 1);
+			static constexpr size_t slab_alignment = squads::max_alignment;
+
+			static void first() noexcept { get_state(); }
+
+			static void* allocate(size_t size, size_t alignment) noexcept {
+				int _index = class_of(size, alignment);
+				if(_index < 0) return backing_type::allocate(size, alignment);
+
+				size_class& _class = get_state().classes[_index];
+				magazine* _mag = get_magazine(_index);
+				void* _obj = nullptr;
+
+				if(_mag == nullptr) {
+					// a ISR, or a task without a free task local slot
+					_obj = _class.depot.allocate();
+					if(_obj == nullptr && !arch::arch_in_isr() && grow(_class, _index))
+						_obj = _class.depot.allocate();
+				} else if(_mag->count != 0 || refill(*_mag, _class, _index)) {
+					free_block* _block = _mag->head;
+
+					_mag->head = _block->next;
+					_mag->count--;
+					_obj = _block;
+				}
+				if(_obj != nullptr) _class.allocations++;
+
+				return _obj;
+			}
+
+			static void deallocate(void* ptr, size_t size, size_t alignment) noexcept {
+				if(ptr == nullptr) return;
+
+				int _index = class_of(size, alignment);
+				if(_index < 0) {
+					backing_type::deallocate(ptr, size, alignment);
+					return;
+				}
+				size_class& _class = get_state().classes[_index];
+				magazine* _mag = get_magazine(_index);
+
+				_class.frees++;
+
+				if(_mag == nullptr) {
+					_class.depot.deallocate(ptr);
+					return;
+				}
+				if(_mag->count >= SQUADS_CONFIG_SLAB_MAGAZINE_SIZE)
+					drain(*_mag, _class, batch);
+
+				free_block* _block = static_cast<free_block*>(ptr);
+				_block->next = _mag->head;
+				_mag->head = _block;
+				_mag->count++;
+			}
+
+			static size_t max_node_size()  {
+				return max_size;
+			}
+			static size_t get_max_alocator_size()  {
+				return backing_type::get_max_alocator_size();
+			}
+
+			/**
+			 * @brief Drain all magazines of the current task to the depots.
+			 */
+			static void flush() {
+				if(arch::arch_in_isr() || !get_local().has_value()) return;
+
+				magazine_set* _set = get_local().get();
+				for(int i = 0; i < class_count; i++)
+					drain(_set->mags[i], get_state().classes[i], _set->mags[i].count);
+			}
+
+			/**
+			 * @brief Get the statistic of a size class.
+			 * @param index The index of the size class, 0 to class_count - 1.
+			 * @param stats The statistic.
+			 * @return false when the index is out of range.
+			 */
+			static bool get_stats(int index, slab_stats& stats) {
+				if(index < 0 || index >= class_count) return false;
+
+				size_class& _class = get_state().classes[index];
+
+				stats.size = internal::slab_class_size(index);
+				stats.allocations = _class.allocations.value();
+				stats.frees = _class.frees.value();
+				stats.pages = _class.pages.load(atomic::memory_order::Relaxed);
+				stats.depot = _class.depot.get_count();
+				stats.refills = _class.refills.load(atomic::memory_order::Relaxed);
+				stats.drains = _class.drains.load(atomic::memory_order::Relaxed);
+
+				return true;
+			}
+
+			/**
+			 * @brief Get the size class of a request.
+			 * @return The index of the size class or -1 for the backing allocator.
+			 */
+			static int class_of(size_t size, size_t alignment) {
+				if(alignment == 0) alignment = 1;
+				if(size > max_size || alignment > slab_alignment) return -1;
+
+				int _index = internal::slab_class_of(size);
+				while(_index < class_count && (internal::slab_class_size(_index) & (alignment - 1)) != 0)
+					_index++;
+
+				return (_index < class_count) ? _index : -1;
+			}
+		private:
+			static constexpr size_t batch = (SQUADS_CONFIG_SLAB_MAGAZINE_SIZE + 1) / 2;
+
+			struct size_class {
+				free_list depot;
+				basic_sharded_counter<uint32_t> allocations;
+				basic_sharded_counter<uint32_t> frees;
+				atomic::basic_atomic_gcc<uint32_t> pages;
+				atomic::basic_atomic_gcc<uint32_t> refills;
+				atomic::basic_atomic_gcc<uint32_t> drains;
+
+				size_class() : depot(), allocations(), frees(), pages(0), refills(0), drains(0) { }
+			};
+
+			struct state {
+				size_class classes[class_count];
+			};
+
+			/**
+			 * @brief The free objects of a task for one size class, linked in the objects.
+			 */
+			struct magazine {
+				free_block* head;
+				size_t count;
+			};
+
+			/**
+			 * @brief The magazines of a task, in a task_local.
+			 */
+			struct magazine_set {
+				magazine mags[class_count];
+
+				magazine_set() : mags{ } { }
+				~magazine_set() {
+					for(int i = 0; i < class_count; i++)
+						drain(mags[i], get_state().classes[i], mags[i].count);
+				}
+			};
+
+			static magazine* get_magazine(int index) {
+				if(arch::arch_in_isr()) return nullptr;
+
+				magazine_set* _set = get_local().get();
+				return (_set != nullptr) ? &_set->mags[index] : nullptr;
+			}
+
+			/**
+			 * @brief Refill a empty magazine with a batch from the depot, grow the depot when empty.
+			 * The depot pops the batch block by block, so a racing task that allocates
+			 * and writes a block of the same chain is never followed.
+			 */
+			static bool refill(magazine& mag, size_class& cls, int index) {
+				size_t _count = 0;
+				free_block* _chain = cls.depot.allocate_chain(batch, _count);
+
+				if(_count == 0) {
+					if(!grow(cls, index)) return false;
+					_chain = cls.depot.allocate_chain(batch, _count);
+					if(_count == 0) return false;
+				}
+				mag.head = _chain;
+				mag.count = _count;
+				cls.refills.fetch_add(1, atomic::memory_order::Relaxed);
+
+				return true;
+			}
+
+			/**
+			 * @brief Move count objects from the magazine to the depot, in one chain.
+			 */
+			static void drain(magazine& mag, size_class& cls, size_t count) {
+				if(count > mag.count) count = mag.count;
+				if(count == 0) return;
+
+				free_block* _first = mag.head;
+				free_block* _last = _first;
+				for(size_t i = 1; i < count; i++)
+					_last = _last->next;
+
+				mag.head = _last->next;
+				mag.count -= count;
+				cls.depot.deallocate_chain(_first, _last, count);
+				cls.drains.fetch_add(1, atomic::memory_order::Relaxed);
+			}
+
+			/**
+			 * @brief Take a new page from the backing allocator and put the objects in the depot.
+			 */
+			static bool grow(size_class& cls, int index) {
+				size_t _size = internal::slab_class_size(index);
+				size_t _page = SQUADS_CONFIG_SLAB_PAGE_SIZE;
+				if(_page < _size * SQUADS_CONFIG_SLAB_MAGAZINE_SIZE)
+					_page = _size * SQUADS_CONFIG_SLAB_MAGAZINE_SIZE;
+
+				// the backing allocator may give less alignment, the page is never freed
+				uint8_t* _raw = static_cast<uint8_t*>(backing_type::allocate(_page + slab_alignment - 1, slab_alignment));
+				if(_raw == nullptr) return false;
+
+				uint8_t* _start = reinterpret_cast<uint8_t*>(
+					(reinterpret_cast<uintptr_t>(_raw) + slab_alignment - 1) & ~uintptr_t(slab_alignment - 1));
+				size_t _count = _page / _size;
+
+				for(size_t i = 0; i + 1 < _count; i++)
+					reinterpret_cast<free_block*>(_start + i * _size)->next =
+						reinterpret_cast<free_block*>(_start + (i + 1) * _size);
+
+				free_block* _last = reinterpret_cast<free_block*>(_start + (_count - 1) * _size);
+				_last->next = nullptr;
+
+				cls.depot.deallocate_chain(reinterpret_cast<free_block*>(_start), _last, _count);
+				cls.pages.fetch_add(1, atomic::memory_order::Relaxed);
+
+				return true;
+			}
+
+			static state& get_state() {
+				static state _state;
+				return _state;
+			}
+
+			static task_local<magazine_set>& get_local() {
+				static task_local<magazine_set> _local;
+				return _local;
+			}
+		};
+
+		template <class TFilter = basic_allocator_filter, class TBACKING = basic_malloc_allocaor_impl>
+		using slab_allocator = basic_storage<basic_slab<TBACKING>, TFilter>;
+    }
+}
+
+#endif
@@ -23,6 +23,7 @@
 #include "core/functional.hpp"
 #include "core/alignment.hpp"
 #include "core/utils.hpp"
+#include "core/algorithm.hpp"
 
 #include "basic_allocator_sized_filter.hpp"
 
@@ -94,7 +95,7 @@ namespace squads {
 			 * @param alignment
 			 * @return Pointer to new memory, or NULL if allocation fails.
 			 */
-			pointer allocate(size_t count, size_t size, size_t alignment = 0) {
+			pointer allocate(size_t count, size_t size, size_t alignment) {
 				return allocate(count * size, (alignment == 0) ? squads::alignment_for(size) : alignment);
 			}
 
@@ -161,7 +162,7 @@ namespace squads {
 
 				auto _size = sizeof(TT);
 
-				destruct<TT>(address);
+				squads::destruct<TT>(address);
 				deallocate(address, _size, squads::alignment_for(_size));
 			}
 
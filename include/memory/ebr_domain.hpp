@@ -0,0 +1,338 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_EBR_DOMAIN_H__
+#define __SQUADS_EBR_DOMAIN_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "basic_malloc_allocator.hpp"
+#include "core/task_local.hpp"
+#include "core/utils.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    namespace memory {
+		/**
+		 * @brief A epoch based reclamation domain, for the nodes of lock free structures.
+		 *
+		 * A reader enters a critical section before it reads shared nodes and leaves it
+		 * after. A removed node is retired and freed in batches, when all tasks that was
+		 * in a critical section at the time of retire have left it. This is detected with
+		 * a global epoch: it advances, when all active tasks have seen the current epoch,
+		 * and nodes retired in epoch e are freed when the global epoch is e + 2.
+		 *
+		 * @code
+		 * ebr_domain<> g_ebr;
+		 *
+		 * // reader
+		 * {
+		 *     ebr_domain<>::guard g(g_ebr);
+		 *     node* n = head.load();
+		 *     ...
+		 * }
+		 *
+		 * // writer, after unlink of the node
+		 * g_ebr.retire(n);
+		 * @endcode
+		 *
+		 * @note Each task that use the domain is bound to a record, the record is
+		 * released when the task (a squads::task) ends. Max SQUADS_CONFIG_EBR_MAX_TASKS
+		 * tasks at the same time. A blocked task in a critical section stops the reclamation.
+		 *
+		 * @tparam TAllocator The allocator of the retired objects and the retire nodes.
+		 */
+		template <class TAllocator = malloc_allocator<> >
+		class basic_ebr_domain {
+		public:
+			using self_type = basic_ebr_domain<TAllocator>;
+			using allocator_type = TAllocator;
+			/**
+			 * @brief The function to free a retired pointer.
+			 */
+			using reclaim_func = void (*)(self_type& domain, void* ptr);
+
+			/**
+			 * @brief RAII critical section.
+			 */
+			class guard {
+			public:
+				explicit guard(self_type& domain) : m_refDomain(domain) { m_bEntered = m_refDomain.enter(); }
+				~guard() { if(m_bEntered) m_refDomain.leave(); }
+
+				guard(const guard&) = delete;
+				guard& operator = (const guard&) = delete;
+
+				/**
+				 * @brief Is the critical section entered, false when no record was free.
+				 */
+				operator bool () const { return m_bEntered; }
+			private:
+				self_type& m_refDomain;
+				bool m_bEntered;
+			};
+
+			basic_ebr_domain() : m_uiEpoch(0), m_allocator(), m_local() { }
+
+			/**
+			 * @brief Destroy the domain and free all retired objects.
+			 *
+			 * After the body m_local (the last member) releases its task_local slot,
+			 * the participants of all tasks are destroyed then, while the records live.
+			 * So no task writes into the domain, when it ends later.
+			 * @note No task may use the domain.
+			 */
+			~basic_ebr_domain() {
+				for(int i = 0; i < SQUADS_CONFIG_EBR_MAX_TASKS; i++) {
+					for(int e = 0; e < 3; e++)
+						free_list(m_records[i], e);
+				}
+			}
+
+			basic_ebr_domain(const self_type&) = delete;
+			self_type& operator = (const self_type&) = delete;
+
+			/**
+			 * @brief Enter a critical section, can nested.
+			 * @return false when no record for the current task was free.
+			 */
+			bool enter() {
+				record* _rec = get_record();
+				if(_rec == nullptr) return false;
+
+				if(_rec->nesting++ > 0) return true;
+
+				uint32_t _epoch = m_uiEpoch.load(atomic::memory_order::Relaxed);
+				for(;;) {
+					_rec->state.store((_epoch << 1) | 1, atomic::memory_order::SeqCst);
+
+					// the epoch must not advance between load and publish
+					uint32_t _now = m_uiEpoch.load(atomic::memory_order::SeqCst);
+					if(_now == _epoch) break;
+					_epoch = _now;
+				}
+				reclaim(*_rec, _epoch);
+				return true;
+			}
+
+			/**
+			 * @brief Leave the critical section.
+			 */
+			void leave() {
+				record* _rec = get_record();
+				if(_rec == nullptr || _rec->nesting == 0) return;
+
+				if(--_rec->nesting == 0)
+					_rec->state.store(0, atomic::memory_order::Release);
+			}
+
+			/**
+			 * @brief Retire a object from the allocator of the domain (construct),
+			 * it is destroyed when no reader can hold it.
+			 * @return false when no record for the current task was free, the object is not retired.
+			 */
+			template <typename T>
+			bool retire(T* ptr) {
+				return retire(static_cast<void*>(ptr), &self_type::template reclaim_object<T>);
+			}
+
+			/**
+			 * @brief Retire a pointer with a own free function.
+			 * @param ptr The pointer to free.
+			 * @param func The function to free the pointer.
+			 * @return false when no record for the current task was free, the pointer is not retired.
+			 */
+			bool retire(void* ptr, reclaim_func func) {
+				if(ptr == nullptr) return true;
+
+				record* _rec = get_record();
+				if(_rec == nullptr) return false;
+
+				retired* _node = static_cast<retired*>(m_allocator.allocate(sizeof(retired), alignof(retired)));
+				if(_node == nullptr) return false;
+
+				_node->ptr = ptr;
+				_node->func = func;
+
+				// the epoch after the unlink of the pointer
+				uint32_t _epoch = m_uiEpoch.load(atomic::memory_order::SeqCst);
+				int _index = _epoch % 3;
+
+				// a list on the same index is three or more epochs old
+				if(_rec->lists[_index] != nullptr && _rec->list_epoch[_index] != _epoch)
+					free_list(*_rec, _index);
+				_node->next = _rec->lists[_index];
+				_rec->lists[_index] = _node;
+				_rec->list_epoch[_index] = _epoch;
+
+				if(++_rec->count >= SQUADS_CONFIG_EBR_RETIRE_THRESHOLD) collect();
+				return true;
+			}
+
+			/**
+			 * @brief Construct a object with the allocator of the domain, for retire.
+			 */
+			template <class T, typename... Args>
+			T* construct(Args&&... args) {
+				return m_allocator.template construct<T>(squads::forward<Args>(args)...);
+			}
+
+			/**
+			 * @brief Try to advance the global epoch and free the retired objects
+			 * of the current task and of the free records.
+			 */
+			void collect() {
+				try_advance();
+
+				uint32_t _epoch = m_uiEpoch.load(atomic::memory_order::Acquire);
+				record* _own = get_record();
+
+				for(int i = 0; i < SQUADS_CONFIG_EBR_MAX_TASKS; i++) {
+					record& _rec = m_records[i];
+
+					if(&_rec == _own) {
+						reclaim(_rec, _epoch);
+						continue;
+					}
+					// claim a free record, for the objects of ended tasks
+					uint32_t _expected = 0;
+					if(_rec.in_use.compare_exchange_strong(_expected, 1, atomic::memory_order::Acquire)) {
+						reclaim(_rec, _epoch);
+						_rec.in_use.store(0, atomic::memory_order::Release);
+					}
+				}
+			}
+
+			/**
+			 * @brief Get the global epoch.
+			 */
+			uint32_t get_epoch() const {
+				return m_uiEpoch.load(atomic::memory_order::Relaxed);
+			}
+
+			allocator_type& get_allocator() { return m_allocator; }
+		private:
+			struct retired {
+				retired* next;
+				void* ptr;
+				reclaim_func func;
+			};
+
+			struct alignas(SQUADS_CONFIG_CACHE_LINE_SIZE) record {
+				/** (epoch << 1) | 1 in a critical section, 0 outside */
+				atomic::basic_atomic_gcc<uint32_t> state;
+				atomic::basic_atomic_gcc<uint32_t> in_use;
+				uint32_t nesting;
+				uint32_t count;
+				retired* lists[3];
+				uint32_t list_epoch[3];
+
+				record() : state(0), in_use(0), nesting(0), count(0), lists{ }, list_epoch{ } { }
+			};
+
+			/**
+			 * @brief The binding of a task to a record, in a task_local.
+			 */
+			struct participant {
+				record* rec;
+
+				participant() : rec(nullptr) { }
+				~participant() {
+					if(rec != nullptr) {
+						rec->nesting = 0;
+						rec->state.store(0, atomic::memory_order::Release);
+						rec->in_use.store(0, atomic::memory_order::Release);
+					}
+				}
+			};
+
+			record* get_record() {
+				participant* _part = m_local.get();
+				if(_part == nullptr) return nullptr;
+
+				if(_part->rec == nullptr) {
+					for(int i = 0; i < SQUADS_CONFIG_EBR_MAX_TASKS; i++) {
+						uint32_t _expected = 0;
+						if(m_records[i].in_use.compare_exchange_strong(_expected, 1, atomic::memory_order::Acquire)) {
+							_part->rec = &m_records[i];
+							break;
+						}
+					}
+				}
+				return _part->rec;
+			}
+
+			/**
+			 * @brief Advance the global epoch, when all active records have seen it.
+			 */
+			bool try_advance() {
+				uint32_t _epoch = m_uiEpoch.load(atomic::memory_order::SeqCst);
+
+				for(int i = 0; i < SQUADS_CONFIG_EBR_MAX_TASKS; i++) {
+					uint32_t _state = m_records[i].state.load(atomic::memory_order::SeqCst);
+
+					if((_state & 1) != 0 && (_state >> 1) != _epoch) return false;
+				}
+				uint32_t _next = (_epoch + 1) & 0x7FFFFFFFu;
+				return m_uiEpoch.compare_exchange_strong(_epoch, _next, atomic::memory_order::AcqRel);
+			}
+
+			/**
+			 * @brief Free the lists of a record, that was retired two epochs before.
+			 */
+			void reclaim(record& rec, uint32_t epoch) {
+				for(int i = 0; i < 3; i++) {
+					if(rec.lists[i] == nullptr) continue;
+
+					if(((epoch - rec.list_epoch[i]) & 0x7FFFFFFFu) >= 2)
+						free_list(rec, i);
+				}
+			}
+
+			void free_list(record& rec, int index) {
+				retired* _node = rec.lists[index];
+				rec.lists[index] = nullptr;
+
+				while(_node != nullptr) {
+					retired* _next = _node->next;
+
+					_node->func(*this, _node->ptr);
+					m_allocator.deallocate(_node, sizeof(retired), alignof(retired));
+
+					rec.count--;
+					_node = _next;
+				}
+			}
+
+			template <typename T>
+			static void reclaim_object(self_type& domain, void* ptr) {
+				domain.m_allocator.destroy(static_cast<T*>(ptr));
+			}
+		private:
+			record m_records[SQUADS_CONFIG_EBR_MAX_TASKS];
+			atomic::basic_atomic_gcc<uint32_t> m_uiEpoch;
+			allocator_type m_allocator;
+			/** the last member, destroyed first: unbinds the tasks before the records die */
+			task_local<participant> m_local;
+		};
+
+		template <class TAllocator = malloc_allocator<> >
+		using ebr_domain = basic_ebr_domain<TAllocator>;
+    }
+}
+
+#endif
@@ -0,0 +1,128 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_FREE_LIST_H__
+#define __SQUADS_FREE_LIST_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "core/lockfree_stack.hpp"
+
+namespace squads {
+    namespace memory {
+		/**
+		 * @brief A free block, the link is stored in the block self.
+		 */
+		struct free_block {
+			free_block* next;
+		};
+
+		/**
+		 * @brief A intrusive lock free list of free memory blocks, the base of lock free pools.
+		 *
+		 * The link of a free block is stored in the first word of the block, so the
+		 * blocks must be at least sizeof(void*) big and pointer aligned. Chains of
+		 * blocks can pushed with one compare exchange and popped block by block, for
+		 * the refill and the flush of task or core caches.
+		 *
+		 * @code
+		 * free_list g_free;
+		 * for(size_t i = 0; i < count; i++)
+		 *     g_free.deallocate(buffer + i * block_size);
+		 *
+		 * void* block = g_free.allocate();
+		 * @endcode
+		 *
+		 * @note The blocks must stay readable, while the list is used.
+		 */
+		class free_list {
+		public:
+			using self_type = free_list;
+			using stack_type = basic_lockfree_stack<free_block>;
+
+			free_list() : m_stack(), m_iCount(0) { }
+
+			free_list(const self_type&) = delete;
+			self_type& operator = (const self_type&) = delete;
+
+			/**
+			 * @brief Pop a free block.
+			 * @return The block or nullptr when the list is empty.
+			 */
+			void* allocate() {
+				free_block* _block = m_stack.pop();
+				if(_block != nullptr) m_iCount.fetch_sub(1, atomic::memory_order::Relaxed);
+
+				return _block;
+			}
+
+			/**
+			 * @brief Push a free block.
+			 */
+			void deallocate(void* block) {
+				if(block == nullptr) return;
+
+				m_stack.push(static_cast<free_block*>(block));
+				m_iCount.fetch_add(1, atomic::memory_order::Relaxed);
+			}
+
+			/**
+			 * @brief Pop a chain of max blocks, one block after the other.
+			 * @param max The max count of blocks.
+			 * @param count The count of the popped blocks.
+			 * @return The first block, linked with free_block::next.
+			 */
+			free_block* allocate_chain(size_t max, size_t& count) {
+				free_block* _chain = m_stack.pop_chain(max, count);
+				if(count != 0) m_iCount.fetch_sub(int32_t(count), atomic::memory_order::Relaxed);
+
+				return _chain;
+			}
+
+			/**
+			 * @brief Push a chain of blocks.
+			 * @param first The first block.
+			 * @param last The last block.
+			 * @param count The count of the blocks in the chain.
+			 */
+			void deallocate_chain(free_block* first, free_block* last, size_t count) {
+				if(first == nullptr) return;
+
+				m_stack.push_chain(first, last);
+				m_iCount.fetch_add(int32_t(count), atomic::memory_order::Relaxed);
+			}
+
+			/**
+			 * @brief Get the count of free blocks, only a snapshot.
+			 * @note A block is counted after the push, so a other task can pop and
+			 * uncount it before: the counter can be negative for a moment.
+			 */
+			uint32_t get_count() const {
+				int32_t _count = m_iCount.load(atomic::memory_order::Relaxed);
+				return (_count < 0) ? 0 : uint32_t(_count);
+			}
+
+			bool empty() const { return m_stack.empty(); }
+			bool is_lock_free() const { return m_stack.is_lock_free(); }
+		private:
+			stack_type m_stack;
+			atomic::basic_atomic_gcc<int32_t> m_iCount;
+		};
+    }
+}
+
+#endif
@@ -0,0 +1,518 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#ifndef __SQUADS_HAZARD_POINTER_H__
+#define __SQUADS_HAZARD_POINTER_H__
+
+#include "config.hpp"
+#include "defines.hpp"
+#include "basic_malloc_allocator.hpp"
+#include "core/task_local.hpp"
+#include "core/sort.hpp"
+#include "arch/arch_utils.hpp"
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    namespace memory {
+		/**
+		 * @brief A hazard pointer domain, for the safe reclamation of the nodes of lock
+		 * free structures with bounded memory.
+		 *
+		 * A reader publishes each node, that it will access, in one of his hazard
+		 * slots (protect). A removed node is retired and only freed, when no hazard
+		 * slot holds it. Retired nodes are scanned in batches: all hazard slots are
+		 * collected and sorted, then each retired node is binary searched. Unlike
+		 * epochs, a suspended reader only holds his own protected nodes.
+		 *
+		 * @code
+		 * // pop of a lock free stack
+		 * hazard_domain<>::guard hp(g_hazard, 0);
+		 * node* top;
+		 * do {
+		 *     top = hp.protect(m_head);
+		 *     if(top == nullptr) return false;
+		 * } while(!m_head.compare_exchange_weak(top, top->next));
+		 * hp.clear();
+		 * g_hazard.retire(top);
+		 * @endcode
+		 *
+		 * @note For a lock free queue (Michael-Scott) use slot 0 for the head and
+		 * slot 1 for the next node of the head.
+		 * @note Each task that use the domain is bound to a record with
+		 * SQUADS_CONFIG_HAZARD_SLOTS slots, max SQUADS_CONFIG_HAZARD_MAX_TASKS tasks at
+		 * the same time. A guard or a retire of a further task takes a free overflow
+		 * record for its scope, the overflow records are allocated with new on demand
+		 * and reused. So the readers don't wait for each other or for the writers.
+		 * @note Only without memory for a new overflow record a guard blocks: it
+		 * sleeps a tick at a time, until a overflow record is free. A retire then
+		 * sleeps until no hazard slot holds the pointer and frees it direct.
+		 *
+		 * @tparam TAllocator The allocator of the retired objects and the retire nodes.
+		 */
+		template <class TAllocator = malloc_allocator<> >
+		class basic_hazard_domain {
+		public:
+			using self_type = basic_hazard_domain<TAllocator>;
+			using allocator_type = TAllocator;
+			/**
+			 * @brief The function to free a retired pointer.
+			 */
+			using reclaim_func = void (*)(void* ptr, void* context);
+
+		private:
+			struct record;
+		public:
+			/**
+			 * @brief A RAII hazard slot of the current task.
+			 */
+			class guard {
+			public:
+				/**
+				 * @param domain The hazard domain.
+				 * @param index The slot of the current task, 0 to SQUADS_CONFIG_HAZARD_SLOTS - 1.
+				 */
+				guard(self_type& domain, int index)
+					: m_refDomain(domain), m_iIndex(index), m_pRecord(nullptr), m_bOverflow(false) { }
+				~guard() {
+					clear();
+					if(m_bOverflow) self_type::release_overflow(m_pRecord);
+				}
+
+				guard(const guard&) = delete;
+				guard& operator = (const guard&) = delete;
+
+				/**
+				 * @brief Protect the value of a atomic pointer.
+				 * @note Without a own record, the guard holds a overflow record until the end.
+				 */
+				template <typename T>
+				T* protect(const atomic::basic_atomic_gcc<T*>& src) {
+					return self_type::protect_in(get_record(), m_iIndex, src);
+				}
+
+				/**
+				 * @brief Protect a known pointer, validate the source after.
+				 */
+				void set(void* ptr) { get_record()->hazards[m_iIndex].store(ptr, atomic::memory_order::SeqCst); }
+				void clear() {
+					if(m_pRecord != nullptr) m_pRecord->hazards[m_iIndex].store(nullptr, atomic::memory_order::Release);
+				}
+			private:
+				record* get_record() {
+					if(m_pRecord == nullptr) {
+						m_pRecord = m_refDomain.get_record();
+						if(m_pRecord == nullptr) {
+							m_pRecord = m_refDomain.acquire_overflow(true);
+							m_bOverflow = true;
+						}
+					}
+					return m_pRecord;
+				}
+			private:
+				self_type& m_refDomain;
+				int m_iIndex;
+				record* m_pRecord;
+				bool m_bOverflow;
+			};
+
+			basic_hazard_domain() : m_pOverflow(nullptr), m_allocator(), m_local() { }
+
+			/**
+			 * @brief Destroy the domain and free all retired objects.
+			 *
+			 * After the body m_local (the last member) releases its task_local slot,
+			 * the participants of all tasks are destroyed then, while the records live.
+			 * So no task writes into the domain, when it ends later.
+			 * @note No task may use the domain.
+			 */
+			~basic_hazard_domain() {
+				for(int i = 0; i < SQUADS_CONFIG_HAZARD_MAX_TASKS; i++)
+					scan_record(m_records[i], nullptr, 0);
+				for(record* _rec = m_pOverflow.load(atomic::memory_order::Acquire); _rec != nullptr; _rec = _rec->next)
+					scan_record(*_rec, nullptr, 0);
+
+				// the scan reads the overflow hazards, delete the records after
+				record* _rec = m_pOverflow.load(atomic::memory_order::Acquire);
+				while(_rec != nullptr) {
+					record* _next = _rec->next;
+					delete _rec;
+					_rec = _next;
+				}
+			}
+
+			basic_hazard_domain(const self_type&) = delete;
+			self_type& operator = (const self_type&) = delete;
+
+			/**
+			 * @brief Protect the value of a atomic pointer in a hazard slot.
+			 * @param index The slot of the current task.
+			 * @param src The atomic pointer, that hold the node.
+			 * @return The protected value or nullptr when no record for the current task was free.
+			 * @note Use a guard, it falls back to the overflow record.
+			 */
+			template <typename T>
+			T* protect(int index, const atomic::basic_atomic_gcc<T*>& src) {
+				record* _rec = get_record();
+				if(_rec == nullptr) return nullptr;
+
+				return protect_in(_rec, index, src);
+			}
+
+			/**
+			 * @brief Set a hazard slot to a pointer, the source must be validated after.
+			 */
+			void set(int index, void* ptr) {
+				record* _rec = get_record();
+				if(_rec != nullptr) _rec->hazards[index].store(ptr, atomic::memory_order::SeqCst);
+			}
+
+			/**
+			 * @brief Clear a hazard slot.
+			 */
+			void clear(int index) {
+				record* _rec = get_record();
+				if(_rec != nullptr) _rec->hazards[index].store(nullptr, atomic::memory_order::Release);
+			}
+
+			/**
+			 * @brief Retire a object from the allocator of the domain (construct),
+			 * it is destroyed when no hazard slot holds it.
+			 */
+			template <typename T>
+			void retire(T* ptr) {
+				retire(static_cast<void*>(ptr), &self_type::template reclaim_object<T>, this);
+			}
+
+			/**
+			 * @brief Retire a object, it is freed with a deleter (like memory::basic_deleter),
+			 * when no hazard slot holds it.
+			 * @note The deleter must live until the object is freed.
+			 */
+			template <typename T, class TDeleter>
+			void retire(T* ptr, TDeleter& deleter) {
+				retire(static_cast<void*>(ptr), &self_type::template reclaim_deleter<T, TDeleter>, &deleter);
+			}
+
+			/**
+			 * @brief Retire a pointer with a own free function.
+			 *
+			 * Without a own record, the pointer is retired in a overflow record. When
+			 * no retire node or overflow record can be allocated, the task waits until
+			 * no hazard slot holds the pointer and frees it direct. So a retired pointer
+			 * is never lost.
+			 *
+			 * @param ptr The pointer to free.
+			 * @param func The function to free the pointer.
+			 * @param context The second argument of the function.
+			 */
+			void retire(void* ptr, reclaim_func func, void* context) {
+				if(ptr == nullptr) return;
+
+				record* _rec = get_record();
+				bool _overflow = (_rec == nullptr);
+				if(_overflow) _rec = acquire_overflow(false);
+
+				retired* _node = nullptr;
+				if(_rec != nullptr)
+					_node = static_cast<retired*>(m_allocator.allocate(sizeof(retired), alignof(retired)));
+
+				if(_node == nullptr) {
+					if(_overflow && _rec != nullptr) release_overflow(_rec);
+
+					// the readers can be lower priority, sleep and let them run
+					while(is_protected(ptr)) arch::arch_delay(1);
+					func(ptr, context);
+					return;
+				}
+				_node->ptr = ptr;
+				_node->func = func;
+				_node->context = context;
+
+				_node->next = _rec->list;
+				_rec->list = _node;
+
+				if(++_rec->count >= SQUADS_CONFIG_HAZARD_SCAN_THRESHOLD) scan(_rec);
+				if(_overflow) release_overflow(_rec);
+			}
+
+			/**
+			 * @brief Construct a object with the allocator of the domain, for retire.
+			 */
+			template <class T, typename... Args>
+			T* construct(Args&&... args) {
+				return m_allocator.template construct<T>(squads::forward<Args>(args)...);
+			}
+
+			/**
+			 * @brief Free all retired objects of the current task and of the free
+			 * records, that no hazard slot holds.
+			 */
+			void scan() {
+				scan(get_record());
+			}
+
+			/**
+			 * @brief Get the count of the allocated overflow records.
+			 */
+			size_t get_overflow_count() const {
+				size_t _count = 0;
+
+				for(record* _rec = m_pOverflow.load(atomic::memory_order::Acquire); _rec != nullptr; _rec = _rec->next)
+					_count++;
+				return _count;
+			}
+
+			allocator_type& get_allocator() { return m_allocator; }
+		private:
+			struct retired {
+				retired* next;
+				void* ptr;
+				reclaim_func func;
+				void* context;
+			};
+
+			struct alignas(SQUADS_CONFIG_CACHE_LINE_SIZE) record {
+				atomic::basic_atomic_gcc<void*> hazards[SQUADS_CONFIG_HAZARD_SLOTS];
+				atomic::basic_atomic_gcc<uint32_t> in_use;
+				retired* list;
+				uint32_t count;
+				/** the next overflow record, never changed after the push */
+				record* next;
+
+				record() : in_use(0), list(nullptr), count(0), next(nullptr) {
+					for(int s = 0; s < SQUADS_CONFIG_HAZARD_SLOTS; s++)
+						hazards[s].store(nullptr, atomic::memory_order::Relaxed);
+				}
+			};
+
+			/**
+			 * @brief The binding of a task to a record, in a task_local.
+			 */
+			struct participant {
+				record* rec;
+
+				participant() : rec(nullptr) { }
+				~participant() {
+					if(rec != nullptr) {
+						for(int s = 0; s < SQUADS_CONFIG_HAZARD_SLOTS; s++)
+							rec->hazards[s].store(nullptr, atomic::memory_order::Release);
+						rec->in_use.store(0, atomic::memory_order::Release);
+					}
+				}
+			};
+
+			record* get_record() {
+				participant* _part = m_local.get();
+				if(_part == nullptr) return nullptr;
+
+				if(_part->rec == nullptr) {
+					for(int i = 0; i < SQUADS_CONFIG_HAZARD_MAX_TASKS; i++) {
+						uint32_t _expected = 0;
+						if(m_records[i].in_use.compare_exchange_strong(_expected, 1, atomic::memory_order::Acquire)) {
+							_part->rec = &m_records[i];
+							break;
+						}
+					}
+				}
+				return _part->rec;
+			}
+
+			template <typename T>
+			static T* protect_in(record* rec, int index, const atomic::basic_atomic_gcc<T*>& src) {
+				T* _ptr = src.load(atomic::memory_order::Relaxed);
+
+				for(;;) {
+					rec->hazards[index].store(_ptr, atomic::memory_order::SeqCst);
+
+					// the node can be retired before the publish
+					T* _now = src.load(atomic::memory_order::SeqCst);
+					if(_now == _ptr) return _ptr;
+					_ptr = _now;
+				}
+			}
+
+			/**
+			 * @brief Take a free overflow record, for a task without a own record.
+			 * A new record is allocated and pushed, when all are in use.
+			 * @param wait Without memory wait for a free record, else return nullptr.
+			 */
+			record* acquire_overflow(bool wait) {
+				for(;;) {
+					for(record* _rec = m_pOverflow.load(atomic::memory_order::Acquire); _rec != nullptr; _rec = _rec->next) {
+						uint32_t _expected = 0;
+						if(_rec->in_use.compare_exchange_strong(_expected, 1, atomic::memory_order::Acquire))
+							return _rec;
+					}
+
+					record* _new = new record();
+					if(_new != nullptr) {
+						_new->in_use.store(1, atomic::memory_order::Relaxed);
+
+						record* _head = m_pOverflow.load(atomic::memory_order::Relaxed);
+						do {
+							_new->next = _head;
+						} while(!m_pOverflow.compare_exchange_weak(_head, _new, atomic::memory_order::Release));
+
+						return _new;
+					}
+					if(!wait) return nullptr;
+
+					// the holders can be lower priority, sleep and let them run
+					arch::arch_delay(1);
+				}
+			}
+
+			/**
+			 * @brief Give a overflow record back, the retired objects stay in it.
+			 */
+			static void release_overflow(record* rec) {
+				for(int s = 0; s < SQUADS_CONFIG_HAZARD_SLOTS; s++)
+					rec->hazards[s].store(nullptr, atomic::memory_order::Release);
+				rec->in_use.store(0, atomic::memory_order::Release);
+			}
+
+			/**
+			 * @brief Free all retired objects of the own record and of the free records.
+			 * @param own The record of the current task, or the held overflow record.
+			 */
+			void scan(record* own) {
+				uintptr_t _hazards[SQUADS_CONFIG_HAZARD_MAX_TASKS * SQUADS_CONFIG_HAZARD_SLOTS];
+				size_t _count = 0;
+
+				for(int i = 0; i < SQUADS_CONFIG_HAZARD_MAX_TASKS; i++) {
+					for(int s = 0; s < SQUADS_CONFIG_HAZARD_SLOTS; s++) {
+						void* _ptr = m_records[i].hazards[s].load(atomic::memory_order::SeqCst);
+						if(_ptr != nullptr) _hazards[_count++] = reinterpret_cast<uintptr_t>(_ptr);
+					}
+				}
+				squads::insertion_sort(_hazards, _hazards + _count);
+
+				for(int i = 0; i < SQUADS_CONFIG_HAZARD_MAX_TASKS; i++)
+					scan_other(m_records[i], own, _hazards, _count);
+
+				for(record* _rec = m_pOverflow.load(atomic::memory_order::Acquire); _rec != nullptr; _rec = _rec->next)
+					scan_other(*_rec, own, _hazards, _count);
+			}
+
+			/**
+			 * @brief Scan the own record, or claim a free record for the objects of ended tasks.
+			 */
+			void scan_other(record& rec, record* own, const uintptr_t* hazards, size_t count) {
+				if(&rec == own) {
+					scan_record(rec, hazards, count);
+					return;
+				}
+				uint32_t _expected = 0;
+				if(rec.in_use.compare_exchange_strong(_expected, 1, atomic::memory_order::Acquire)) {
+					scan_record(rec, hazards, count);
+					rec.in_use.store(0, atomic::memory_order::Release);
+				}
+			}
+
+			/**
+			 * @brief Is the pointer in any hazard slot of the own and the overflow records?
+			 */
+			bool is_protected(void* ptr) {
+				for(int i = 0; i < SQUADS_CONFIG_HAZARD_MAX_TASKS; i++) {
+					for(int s = 0; s < SQUADS_CONFIG_HAZARD_SLOTS; s++) {
+						if(m_records[i].hazards[s].load(atomic::memory_order::SeqCst) == ptr) return true;
+					}
+				}
+				return is_protected_overflow(ptr);
+			}
+
+			/**
+			 * @brief Is the pointer in a hazard slot of a overflow record? The overflow
+			 * records are few, so they are searched linear and not sorted.
+			 */
+			bool is_protected_overflow(void* ptr) {
+				for(record* _rec = m_pOverflow.load(atomic::memory_order::Acquire); _rec != nullptr; _rec = _rec->next) {
+					for(int s = 0; s < SQUADS_CONFIG_HAZARD_SLOTS; s++) {
+						if(_rec->hazards[s].load(atomic::memory_order::SeqCst) == ptr) return true;
+					}
+				}
+				return false;
+			}
+
+			/**
+			 * @brief Free all retired objects of a record, that are not in the sorted
+			 * hazards and not in a overflow record.
+			 */
+			void scan_record(record& rec, const uintptr_t* hazards, size_t count) {
+				retired* _node = rec.list;
+				rec.list = nullptr;
+				rec.count = 0;
+
+				while(_node != nullptr) {
+					retired* _next = _node->next;
+
+					if(contains(hazards, count, reinterpret_cast<uintptr_t>(_node->ptr)) || is_protected_overflow(_node->ptr)) {
+						_node->next = rec.list;
+						rec.list = _node;
+						rec.count++;
+					} else {
+						_node->func(_node->ptr, _node->context);
+						m_allocator.deallocate(_node, sizeof(retired), alignof(retired));
+					}
+					_node = _next;
+				}
+			}
+
+			static bool contains(const uintptr_t* hazards, size_t count, uintptr_t ptr) {
+				size_t _low = 0, _high = count;
+
+				while(_low < _high) {
+					size_t _mid = (_low + _high) / 2;
+
+					if(hazards[_mid] < ptr) _low = _mid + 1;
+					else _high = _mid;
+				}
+				return _low < count && hazards[_low] == ptr;
+			}
+
+			template <typename T>
+			static void reclaim_object(void* ptr, void* context) {
+				static_cast<self_type*>(context)->m_allocator.destroy(static_cast<T*>(ptr));
+			}
+
+			template <typename T, class TDeleter>
+			static void reclaim_deleter(void* ptr, void* context) {
+				(*static_cast<TDeleter*>(context))(static_cast<T*>(ptr));
+			}
+		private:
+			record m_records[SQUADS_CONFIG_HAZARD_MAX_TASKS];
+			/** the list of the overflow records, for the tasks without a own record */
+			atomic::basic_atomic_gcc<record*> m_pOverflow;
+			allocator_type m_allocator;
+			/** the last member, destroyed first: unbinds the tasks before the records die */
+			task_local<participant> m_local;
+		};
+
+		template <class TAllocator = malloc_allocator<> >
+		using hazard_domain = basic_hazard_domain<TAllocator>;
+
+		/**
+		 * @brief Get the default hazard domain of the library, like for the atomic_shared_ptr.
+		 */
+		inline hazard_domain<>& get_default_hazard_domain() {
+			static hazard_domain<> _domain;
+			return _domain;
+		}
+    }
+}
+
+#endif
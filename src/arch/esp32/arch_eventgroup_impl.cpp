@@ -23,6 +23,7 @@
 #include "core/eventgroup.hpp"
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
+#include "freertos/timers.h"
 
 #include "esp_log.h"
 
@@ -31,7 +32,7 @@ namespace squads  {
     //  construtor
     //-----------------------------------
     eventgroup::eventgroup(const char* strName)
-    	: m_pHandle(nullptr) {
+    	: m_pHandle(nullptr), m_pListener(nullptr), m_pListenerCtx(nullptr) {
 		sprintf(m_strName, "evg_%s", strName);
     }
 
@@ -39,7 +40,7 @@ namespace squads  {
     //  construtor
     //-----------------------------------
     eventgroup::eventgroup(native_handle_type handle)
-        : m_pHandle(handle) {
+        : m_pHandle(handle), m_pListener(nullptr), m_pListenerCtx(nullptr) {
         	if( !is_init() ) ESP_LOGE(m_strName, "the given handle is NULL this group will not work!!");
 	}
 
@@ -145,14 +146,31 @@ namespace squads  {
         if(xPortInIsrContext()) {
             BaseType_t xHigherPriorityTaskWoken = pdFALSE;
             success = xEventGroupSetBitsFromISR((EventGroupHandle_t )m_pHandle, uxBitsToSet, &xHigherPriorityTaskWoken);
+
+            // the set is deferred to the timer task, so is the listener: the pended
+            // call runs after the set, then the listener sees the bits
+            if(success == pdPASS && m_pListener != nullptr)
+                xTimerPendFunctionCallFromISR(&eventgroup::call_listener, this, 0, &xHigherPriorityTaskWoken);
+
             if(xHigherPriorityTaskWoken)
                 _frxt_setup_switch();
         } else {
             success = xEventGroupSetBits((EventGroupHandle_t )m_pHandle, (event_bit_type)uxBitsToSet);
+            call_listener(this, 0);
         }
         return success;
     }
 
+    //-----------------------------------
+    //  call_listener
+    //-----------------------------------
+    void eventgroup::call_listener(void* pvGroup, uint32_t ulUnused) {
+        eventgroup* _group = static_cast<eventgroup*>(pvGroup);
+
+        listener_type _listener = _group->m_pListener;
+        if(_listener != nullptr) _listener(_group->m_pListenerCtx);
+    }
+
     //-----------------------------------
     //  init_internal
     //-----------------------------------
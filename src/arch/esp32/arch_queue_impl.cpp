@@ -61,7 +61,10 @@ int arch_queue_impl::enqueue_back(const void *item, unsigned int timeout) {
         success = xQueueSend((QueueHandle_t)m_pHandle, item, timeout );
     }
 
-    return success == pdTRUE ? 0 : 1;
+    if(success != pdTRUE) return 1;
+
+    notify_listener();
+    return 0;
 }
 int arch_queue_impl::enqueue_front(const void *item, unsigned int timeout) {
     BaseType_t success;
@@ -79,7 +82,10 @@ int arch_queue_impl::enqueue_front(const void *item, unsigned int timeout) {
         success = xQueueSendToFront((QueueHandle_t)m_pHandle, item, timeout );
     }
 
-    return success == pdTRUE ? 0 : 1;
+    if(success != pdTRUE) return 1;
+
+    notify_listener();
+    return 0;
 }
 int arch_queue_impl::overwrite(void *item,  unsigned int timeout) {
     if (m_pHandle == NULL)
@@ -98,6 +104,7 @@ int arch_queue_impl::overwrite(void *item,  unsigned int timeout) {
     {
         (void)xQueueOverwrite((QueueHandle_t)m_pHandle, item);
     }
+    notify_listener();
     return 0;
 }
 int arch_queue_impl::dequeue(void *item, unsigned int timeout) {
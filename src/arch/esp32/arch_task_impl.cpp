@@ -22,6 +22,7 @@
 
 #include "core/task.hpp"
 #include "core/autolock.hpp"
+#include "core/task_local.hpp"
 #include "freertos/FreeRTOS.h"
 #include "esp_task.h"
 #include "esp_log.h"
@@ -116,6 +117,20 @@ namespace squads {
             return wait(_time.to_ticks());
         }
 
+        int task::join(const basic_deadline& dl, cancellation_token* token) {
+            if(!joinable()) return 1;
+
+            if(!m_bRunning) return 1;
+            if(m_pHandle == xTaskGetCurrentTaskHandle())  {
+                return 1;
+            }
+
+            cancellation_scope _scope(token);
+            if(_scope.is_cancelled()) return SQUADS_RESULT_CANCELLED;
+
+            return m_eventGroup.is_bit(EVENTGROUP_BIT_JOINABLE, dl.remaining_ticks()) ? 0 : _scope.failed_result();
+        }
+
         bool task::joinable() const noexcept {
             return (m_pHandle != nullptr);
         }
@@ -160,6 +175,7 @@ namespace squads {
 
                 return 2;
             }
+            internal::task_local_cleanup(this);
             vTaskDelete((TaskHandle_t)m_pHandle); m_pHandle = 0;
             m_bRunning = false;
             on_kill();
@@ -334,6 +350,7 @@ namespace squads {
 
                 // clean up
                 esp_task->on_cleanup();
+                internal::task_local_cleanup(nullptr);
 
                 // set the return value and delete the task
                 esp_task->m_runningMutex.lock();
@@ -365,17 +382,7 @@ namespace squads {
         //  wait
         //-----------------------------------
         int task::wait(condition_variable& cv, mutex& cvl, unsigned int timeOut)  {
-            autolock<mutex> autolock(m_runningMutex);
-
-            cv.add_list(this);
-
-            cvl.unlock();
-            int ret = m_waitSem.lock(timeOut);
-            cvl.lock();
-
-            notify_take( true, timeOut);
-
-            return ret;
+            return cv.wait(cvl, timeOut);
         }
         bool task::notify(task* task, uint32_t ulValue, int action) {
             BaseType_t success;
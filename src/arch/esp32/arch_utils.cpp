@@ -107,6 +107,82 @@ namespace squads {
                 return xTaskGetTickCount();
             }
         }
+        int arch_get_core_id() {
+            return xPortGetCoreID();
+        }
+        bool arch_in_isr() {
+            return xPortInIsrContext();
+        }
+
+        void* arch_get_current_task() {
+            return xTaskGetCurrentTaskHandle();
+        }
+
+        void arch_notify_give(void* handle) {
+            if(handle == NULL) return;
+
+            if (xPortInIsrContext()) {
+                BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+                vTaskNotifyGiveFromISR( (TaskHandle_t)handle, &xHigherPriorityTaskWoken );
+
+                if(xHigherPriorityTaskWoken)
+                    _frxt_setup_switch();
+            } else {
+                xTaskNotifyGive( (TaskHandle_t)handle );
+            }
+        }
+        bool arch_abort_delay(void* handle) {
+            if(handle == NULL) return false;
+
+            return xTaskAbortDelay( (TaskHandle_t)handle ) == pdPASS;
+        }
+
+        void arch_mux_init(arch_mux_t* mux) {
+            portMUX_INITIALIZE(mux);
+        }
+        void arch_mux_lock(arch_mux_t* mux) {
+            if (xPortInIsrContext()) {
+                portENTER_CRITICAL_ISR(mux);
+            } else {
+                portENTER_CRITICAL(mux);
+            }
+        }
+        void arch_mux_unlock(arch_mux_t* mux) {
+            if (xPortInIsrContext()) {
+                portEXIT_CRITICAL_ISR(mux);
+            } else {
+                portEXIT_CRITICAL(mux);
+            }
+        }
+        bool arch_park(unsigned int timeout) {
+#if SQUADS_ARCH_CONFIG_PARK_NOTIFY_INDEX > 0
+            return ulTaskNotifyTakeIndexed( SQUADS_ARCH_CONFIG_PARK_NOTIFY_INDEX, pdTRUE, timeout ) != 0;
+#else
+            return ulTaskNotifyTake( pdTRUE, timeout ) != 0;
+#endif
+        }
+        void arch_unpark(void* handle) {
+            if(handle == NULL) return;
+#if SQUADS_ARCH_CONFIG_PARK_NOTIFY_INDEX > 0
+            if (xPortInIsrContext()) {
+                BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+                vTaskNotifyGiveIndexedFromISR( (TaskHandle_t)handle,
+                    SQUADS_ARCH_CONFIG_PARK_NOTIFY_INDEX, &xHigherPriorityTaskWoken );
+
+                if(xHigherPriorityTaskWoken)
+                    _frxt_setup_switch();
+            } else {
+                xTaskNotifyGiveIndexed( (TaskHandle_t)handle, SQUADS_ARCH_CONFIG_PARK_NOTIFY_INDEX );
+            }
+#else
+            arch_notify_give(handle);
+#endif
+        }
+        void arch_cpu_relax() {
+            __asm__ __volatile__ ("nop");
+        }
         void arch_delay(const unsigned long& ts) {
             vTaskDelay( ts );
         }
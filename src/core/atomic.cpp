@@ -0,0 +1,37 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#include "atomic/__internal_atomic_gcc_impl.hpp"
+
+namespace squads {
+    namespace atomic {
+        namespace internal {
+            static_assert((SQUADS_CONFIG_ATOMIC_LOCK_STRIPES & (SQUADS_CONFIG_ATOMIC_LOCK_STRIPES - 1)) == 0,
+                "SQUADS_CONFIG_ATOMIC_LOCK_STRIPES must be a power of two");
+
+            atomic_stripe& get_atomic_stripe(const volatile void* address) {
+                // a function static, atomics of global objects are used before main
+                static atomic_stripe _stripes[SQUADS_CONFIG_ATOMIC_LOCK_STRIPES];
+
+                // fibonacci hashing, the high bits are the best mixed
+                uint32_t _hash = uint32_t(reinterpret_cast<uintptr_t>(address) >> 3) * 2654435769u;
+
+                return _stripes[_hash >> (32 - __builtin_ctz(SQUADS_CONFIG_ATOMIC_LOCK_STRIPES))];
+            }
+        }
+    }
+}
@@ -0,0 +1,149 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+
+#include "core/cancellation_token.hpp"
+#include "core/task_local.hpp"
+
+namespace squads {
+    //-----------------------------------
+    //  cancellation_token
+    //-----------------------------------
+    cancellation_token::cancellation_token()
+        : m_pWaiters(nullptr), m_uiCancelled(0) {
+        arch::arch_mux_init(&m_mux);
+    }
+
+    void cancellation_token::cancel() {
+        if(m_uiCancelled.exchange(1, atomic::memory_order::AcqRel) != 0) return;
+
+        // mark the registered tasks, each is woken once
+        arch::arch_mux_lock(&m_mux);
+        for(waiter* _node = m_pWaiters; _node != nullptr; _node = _node->next)
+            _node->pending = true;
+        arch::arch_mux_unlock(&m_mux);
+
+        for(;;) {
+            arch::arch_mux_lock(&m_mux);
+
+            waiter* _node = m_pWaiters;
+            while(_node != nullptr && !_node->pending) _node = _node->next;
+
+            if(_node == nullptr) {
+                arch::arch_mux_unlock(&m_mux);
+                return;
+            }
+            // the node stay valid, while aborting is set
+            _node->pending = false;
+            _node->aborting = true;
+            void* _task = _node->task;
+            arch::arch_mux_unlock(&m_mux);
+
+            // the abort wakes a blocked task, the notification a task that parks later
+            arch::arch_abort_delay(_task);
+            arch::arch_unpark(_task);
+
+            arch::arch_mux_lock(&m_mux);
+            _node->aborting = false;
+            arch::arch_mux_unlock(&m_mux);
+        }
+    }
+
+    bool cancellation_token::enter(waiter* node) {
+        arch::arch_mux_lock(&m_mux);
+
+        if(is_cancelled()) {
+            arch::arch_mux_unlock(&m_mux);
+            return false;
+        }
+        node->prev = nullptr;
+        node->next = m_pWaiters;
+        if(m_pWaiters != nullptr) m_pWaiters->prev = node;
+        m_pWaiters = node;
+
+        arch::arch_mux_unlock(&m_mux);
+        return true;
+    }
+
+    void cancellation_token::leave(waiter* node) {
+        arch::arch_mux_lock(&m_mux);
+
+        // the cancel wakes the task at the moment, only a short wait
+        while(node->aborting) {
+            arch::arch_mux_unlock(&m_mux);
+            arch::arch_delay(1);
+            arch::arch_mux_lock(&m_mux);
+        }
+        if(node->prev != nullptr) node->prev->next = node->next;
+        else m_pWaiters = node->next;
+
+        if(node->next != nullptr) node->next->prev = node->prev;
+
+        arch::arch_mux_unlock(&m_mux);
+    }
+
+    //-----------------------------------
+    //  cancellation_scope
+    //-----------------------------------
+    /** The innermost registered scope of each task */
+    static task_local<cancellation_scope*> g_currentScope;
+
+    cancellation_scope::cancellation_scope(cancellation_token* token)
+        : m_pToken(token), m_pOuter(nullptr), m_bRegistered(false) {
+
+        if(m_pToken == nullptr) return;
+
+        m_node.task = arch::arch_get_current_task();
+        m_node.next = nullptr;
+        m_node.prev = nullptr;
+        m_node.pending = false;
+        m_node.aborting = false;
+
+        m_bRegistered = m_pToken->enter(&m_node);
+        if(!m_bRegistered) return;
+
+        // without a free slot, a cancel before the park is taken for a foreign notification
+        cancellation_scope** _current = g_currentScope.get();
+        if(_current == nullptr) return;
+
+        m_pOuter = *_current;
+        *_current = this;
+    }
+
+    cancellation_scope::~cancellation_scope() {
+        leave();
+    }
+
+    void cancellation_scope::leave() {
+        if(!m_bRegistered) return;
+
+        m_pToken->leave(&m_node);
+        m_bRegistered = false;
+
+        if(g_currentScope.has_value()) {
+            cancellation_scope** _current = g_currentScope.get();
+            if(*_current == this) *_current = m_pOuter;
+        }
+    }
+
+    bool cancellation_scope::current_cancelled() {
+        if(!g_currentScope.has_value()) return false;
+
+        cancellation_scope* _scope = *g_currentScope.get();
+        return (_scope != nullptr) && _scope->is_cancelled();
+    }
+}
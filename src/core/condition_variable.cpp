@@ -21,36 +21,31 @@
 
 namespace squads {
     condition_variable::condition_variable()
-            : m_mutex(), m_waitList() { }
-    
-    void condition_variable::add_list(task_type *thread) {
-        autolock<mutex> autolock(m_mutex);
+            : m_queue() { }
 
-        m_waitList.push_back(thread);
-    }
     void condition_variable::signal() {
-        autolock<mutex> autolock(m_mutex);
-
-        if ( !m_waitList.empty() ) {
-            task_type *thr = m_waitList.front();
-            m_waitList.pop_front();
+        m_queue.lock();
+        void* _task = m_queue.pop_front();
+        m_queue.unlock();
 
-            thr->signal();
-        }
+        wait_queue::unpark(_task);
     }
     void condition_variable::broadcast() {
-        autolock<mutex> autolock(m_mutex);
-
-        while ( !m_waitList.empty() ) {
-            task_type *thr = m_waitList.front();
-            m_waitList.pop_front();
-
-            thr->signal();
+        wait_node* _head = nullptr;
+        wait_node* _tail = nullptr;
+
+        // chain all waiters over the next pointer, each one wakes the next
+        m_queue.lock();
+        while ( !m_queue.empty() ) {
+            wait_node* _node = m_queue.front();
+            m_queue.pop(_node);
+
+            if(_tail != nullptr) _tail->next = _node;
+            else _head = _node;
+            _tail = _node;
         }
-    }
+        m_queue.unlock();
 
-    int condition_variable::wait(mutex& mx, unsigned int timeOut) {
-        task_type *thr =  task_type::get_self();
-        return thr->wait(*this, mx, timeOut);
+        if(_head != nullptr) wait_queue::wake(_head);
     }
 }
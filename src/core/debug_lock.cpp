@@ -0,0 +1,150 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#include "core/debug_lock.hpp"
+
+#if SQUADS_CONFIG_LOCK_PROFILER == SQUADS_CONFIG_YES
+
+#include <stdio.h>
+
+namespace squads {
+    namespace internal {
+        struct lock_profile_list {
+            arch::arch_mux_t mux;
+            lock_profile* head;
+
+            lock_profile_list() : head(nullptr) { arch::arch_mux_init(&mux); }
+        };
+
+        // a function static, the profiles of global locks are created before main
+        static lock_profile_list& get_profile_list() {
+            static lock_profile_list _list;
+            return _list;
+        }
+
+        struct lock_profile_snapshot {
+            const char* name;
+            uint32_t acquisitions, contended, timeouts, try_fails;
+            uint32_t wait_total, wait_max, hold_total, hold_max;
+            void* tasks[SQUADS_CONFIG_LOCK_PROFILER_TOP_TASKS];
+            uint32_t waits[SQUADS_CONFIG_LOCK_PROFILER_TOP_TASKS];
+        };
+
+        static void take_snapshot(const lock_profile& profile, lock_profile_snapshot& snap) {
+            snap.name = profile.get_name();
+            snap.acquisitions = profile.get_acquisitions();
+            snap.contended = profile.get_contended();
+            snap.timeouts = profile.get_timeouts();
+            snap.try_fails = profile.get_try_fails();
+            snap.wait_total = profile.get_wait_total();
+            snap.wait_max = profile.get_wait_max();
+            snap.hold_total = profile.get_hold_total();
+            snap.hold_max = profile.get_hold_max();
+
+            for(int i = 0; i < SQUADS_CONFIG_LOCK_PROFILER_TOP_TASKS; i++) {
+                snap.tasks[i] = profile.get_waiter(i).task.load(atomic::memory_order::Relaxed);
+                snap.waits[i] = profile.get_waiter(i).wait.load(atomic::memory_order::Relaxed);
+            }
+        }
+
+        static void print_snapshot(const lock_profile_snapshot& snap) {
+            printf("lock %s: acquisitions %u, contended %u (%u%%), timeouts %u, try fails %u\n",
+                snap.name, unsigned(snap.acquisitions), unsigned(snap.contended),
+                unsigned(snap.acquisitions ? (uint64_t(snap.contended) * 100) / snap.acquisitions : 0),
+                unsigned(snap.timeouts), unsigned(snap.try_fails));
+            printf("    wait: total %u us, max %u us, avg %u us\n",
+                unsigned(snap.wait_total), unsigned(snap.wait_max),
+                unsigned(snap.contended ? snap.wait_total / snap.contended : 0));
+            printf("    hold: total %u us, max %u us, avg %u us\n",
+                unsigned(snap.hold_total), unsigned(snap.hold_max),
+                unsigned(snap.acquisitions ? snap.hold_total / snap.acquisitions : 0));
+
+            for(int i = 0; i < SQUADS_CONFIG_LOCK_PROFILER_TOP_TASKS; i++) {
+                if(snap.tasks[i] != nullptr)
+                    printf("    waiter %p: %u us\n", snap.tasks[i], unsigned(snap.waits[i]));
+            }
+        }
+    }
+
+    lock_profile::lock_profile(const char* name)
+        : m_strName(name), m_uiAcquisitions(0), m_uiContended(0), m_uiTimeouts(0), m_uiTryFails(0),
+          m_uiWaitTotal(0), m_uiWaitMax(0), m_uiHoldTotal(0), m_uiHoldMax(0),
+          m_pNext(nullptr), m_pPrev(nullptr) {
+
+        internal::lock_profile_list& _list = internal::get_profile_list();
+
+        arch::arch_mux_lock(&_list.mux);
+        m_pNext = _list.head;
+        if(_list.head != nullptr) _list.head->m_pPrev = this;
+        _list.head = this;
+        arch::arch_mux_unlock(&_list.mux);
+    }
+
+    lock_profile::~lock_profile() {
+        internal::lock_profile_list& _list = internal::get_profile_list();
+
+        arch::arch_mux_lock(&_list.mux);
+        if(m_pPrev != nullptr) m_pPrev->m_pNext = m_pNext;
+        else _list.head = m_pNext;
+        if(m_pNext != nullptr) m_pNext->m_pPrev = m_pPrev;
+        arch::arch_mux_unlock(&_list.mux);
+    }
+
+    void lock_profile::reset() {
+        m_uiAcquisitions.store(0, atomic::memory_order::Relaxed);
+        m_uiContended.store(0, atomic::memory_order::Relaxed);
+        m_uiTimeouts.store(0, atomic::memory_order::Relaxed);
+        m_uiTryFails.store(0, atomic::memory_order::Relaxed);
+        m_uiWaitTotal.store(0, atomic::memory_order::Relaxed);
+        m_uiWaitMax.store(0, atomic::memory_order::Relaxed);
+        m_uiHoldTotal.store(0, atomic::memory_order::Relaxed);
+        m_uiHoldMax.store(0, atomic::memory_order::Relaxed);
+
+        for(int i = 0; i < SQUADS_CONFIG_LOCK_PROFILER_TOP_TASKS; i++) {
+            m_aWaiters[i].task.store(nullptr, atomic::memory_order::Relaxed);
+            m_aWaiters[i].wait.store(0, atomic::memory_order::Relaxed);
+        }
+    }
+
+    void lock_profile::dump() const {
+        internal::lock_profile_snapshot _snap;
+
+        internal::take_snapshot(*this, _snap);
+        internal::print_snapshot(_snap);
+    }
+
+    void lock_profile::dump_all() {
+        internal::lock_profile_list& _list = internal::get_profile_list();
+        internal::lock_profile_snapshot _snap;
+
+        // printf can block, so each profile is copied under the mux and printed after
+        for(int n = 0; ; n++) {
+            arch::arch_mux_lock(&_list.mux);
+            lock_profile* _profile = _list.head;
+            for(int i = 0; i < n && _profile != nullptr; i++)
+                _profile = _profile->m_pNext;
+
+            if(_profile != nullptr) internal::take_snapshot(*_profile, _snap);
+            arch::arch_mux_unlock(&_list.mux);
+
+            if(_profile == nullptr) break;
+            internal::print_snapshot(_snap);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,242 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+
+#include "core/event_loop.hpp"
+#include "core/autolock.hpp"
+#include "arch/arch_utils.hpp"
+
+namespace squads {
+    namespace internal {
+        static inline bool ticks_expired(unsigned int expire, unsigned int now) {
+            return int32_t(expire - now) <= 0;
+        }
+    }
+    //-----------------------------------
+    //  event_source::signal
+    //-----------------------------------
+    void event_source::signal() {
+        event_loop* _loop = m_pLoop;
+        if(_loop == nullptr) return;
+
+        if(m_uiQueued.exchange(1, atomic::memory_order::AcqRel) != 0) return;
+
+        _loop->push_ready(this);
+        _loop->wakeup();
+    }
+
+    //-----------------------------------
+    //  event_loop
+    //-----------------------------------
+    event_loop::event_loop(const char* strName, priority uiPriority,
+        unsigned short usStackDepth) noexcept
+        : base_type(strName, uiPriority, usStackDepth),
+          m_timerLock(), m_pTimers(nullptr), m_pReady(nullptr),
+          m_pNative(nullptr), m_bQuit(false) { }
+
+    int event_loop::attach(event_source& source) {
+        if(source.m_pLoop != nullptr) return 1;
+
+        source.m_uiQueued.store(0);
+        source.m_pLoop = this;
+        source.on_attach();
+
+        return 0;
+    }
+
+    int event_loop::detach(event_source& source) {
+        if(source.m_pLoop != this) return 1;
+
+        source.on_detach();
+        source.m_pLoop = nullptr;
+
+        return 0;
+    }
+
+    int event_loop::start_timer(event_timer& timer, unsigned int xTicks, bool bPeriodic) {
+        {
+            autolock<mutex> lock(m_timerLock);
+
+            if(timer.m_pLoop != nullptr) return 1;
+
+            timer.m_uiExpire = arch::arch_get_ticks() + xTicks;
+            timer.m_uiPeriod = bPeriodic ? (xTicks > 0 ? xTicks : 1) : 0;
+            timer.m_pLoop = this;
+
+            insert_timer(&timer);
+        }
+        wakeup();
+        return 0;
+    }
+
+    int event_loop::stop_timer(event_timer& timer) {
+        autolock<mutex> lock(m_timerLock);
+
+        if(timer.m_pLoop != this) return 1;
+
+        remove_timer(&timer);
+        timer.m_pLoop = nullptr;
+
+        return 0;
+    }
+
+    void event_loop::quit() {
+        m_bQuit = true;
+        wakeup();
+    }
+
+    void event_loop::wakeup() {
+        arch::arch_notify_give(m_pNative);
+    }
+
+    //-----------------------------------
+    //  on_task
+    //-----------------------------------
+    int event_loop::on_task() {
+        m_pNative = arch::arch_get_current_task();
+
+        while(!m_bQuit) {
+            unsigned int _timeout = run_timers();
+
+            dispatch_ready();
+
+            if(m_pReady.load(atomic::memory_order::Acquire) != nullptr)
+                _timeout = 0;
+
+            if(_timeout != 0)
+                task::notify_take(true, _timeout);
+        }
+        m_pNative = nullptr;
+
+        return 0;
+    }
+
+    //-----------------------------------
+    //  push_ready
+    //-----------------------------------
+    void event_loop::push_ready(event_source* source) {
+        event_source* _head = m_pReady.load(atomic::memory_order::Relaxed);
+
+        do {
+            source->m_pNextReady = _head;
+        } while(!m_pReady.compare_exchange_weak(_head, source, atomic::memory_order::Release));
+    }
+
+    //-----------------------------------
+    //  dispatch_ready
+    //-----------------------------------
+    void event_loop::dispatch_ready() {
+        event_source* _list = m_pReady.exchange(nullptr, atomic::memory_order::Acquire);
+        event_source* _fifo = nullptr;
+
+        // the ready list is a stack, reverse it for dispatch in signal order
+        while(_list != nullptr) {
+            event_source* _next = _list->m_pNextReady;
+            _list->m_pNextReady = _fifo;
+            _fifo = _list;
+            _list = _next;
+        }
+
+        while(_fifo != nullptr) {
+            event_source* _source = _fifo;
+            _fifo = _fifo->m_pNextReady;
+
+            // a signal while on_dispatch run, queue the source again
+            _source->m_uiQueued.store(0, atomic::memory_order::Release);
+
+            if(_source->m_pLoop != this) continue;
+
+            _source->on_dispatch();
+
+            if(_source->m_pLoop == this && _source->is_ready())
+                _source->signal();
+        }
+    }
+
+    //-----------------------------------
+    //  run_timers
+    //-----------------------------------
+    unsigned int event_loop::run_timers() {
+        m_timerLock.lock();
+
+        for(;;) {
+            event_timer* _timer = m_pTimers;
+            unsigned int _now = arch::arch_get_ticks();
+
+            if(_timer == nullptr) {
+                m_timerLock.unlock();
+                return SQUADS_PORTMAX_DELAY;
+            }
+            if(!internal::ticks_expired(_timer->m_uiExpire, _now)) {
+                unsigned int _wait = _timer->m_uiExpire - _now;
+                m_timerLock.unlock();
+                return _wait;
+            }
+
+            remove_timer(_timer);
+
+            if(_timer->m_uiPeriod != 0) {
+                _timer->m_uiExpire += _timer->m_uiPeriod;
+
+                // we are to late, skip the missed periods
+                if(internal::ticks_expired(_timer->m_uiExpire, _now))
+                    _timer->m_uiExpire = _now + _timer->m_uiPeriod;
+
+                insert_timer(_timer);
+            } else {
+                _timer->m_pLoop = nullptr;
+            }
+
+            m_timerLock.unlock();
+            _timer->on_timer();
+            m_timerLock.lock();
+        }
+    }
+
+    //-----------------------------------
+    //  insert_timer
+    //-----------------------------------
+    void event_loop::insert_timer(event_timer* timer) {
+        event_timer* _prev = nullptr;
+        event_timer* _pos = m_pTimers;
+
+        while(_pos != nullptr && internal::ticks_expired(_pos->m_uiExpire, timer->m_uiExpire)) {
+            _prev = _pos;
+            _pos = _pos->m_pNext;
+        }
+
+        timer->m_pPrev = _prev;
+        timer->m_pNext = _pos;
+
+        if(_pos != nullptr) _pos->m_pPrev = timer;
+        if(_prev != nullptr) _prev->m_pNext = timer;
+        else m_pTimers = timer;
+    }
+
+    //-----------------------------------
+    //  remove_timer
+    //-----------------------------------
+    void event_loop::remove_timer(event_timer* timer) {
+        if(timer->m_pPrev != nullptr) timer->m_pPrev->m_pNext = timer->m_pNext;
+        else m_pTimers = timer->m_pNext;
+
+        if(timer->m_pNext != nullptr) timer->m_pNext->m_pPrev = timer->m_pPrev;
+
+        timer->m_pNext = nullptr;
+        timer->m_pPrev = nullptr;
+    }
+}
@@ -0,0 +1,126 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#include "core/intrusive_ptr.hpp"
+#include "core/lockfree_stack.hpp"
+
+namespace squads {
+    namespace internal {
+        using merge_queue = basic_lockfree_stack<ref_counted::merge_node>;
+
+        static_assert((SQUADS_CONFIG_REF_COUNTED_QUEUES & (SQUADS_CONFIG_REF_COUNTED_QUEUES - 1)) == 0,
+            "SQUADS_CONFIG_REF_COUNTED_QUEUES must be a power of two");
+
+        static merge_queue& get_merge_queue(const void* owner) {
+            static merge_queue _queues[SQUADS_CONFIG_REF_COUNTED_QUEUES];
+
+            // fibonacci hashing, the high bits are the best mixed
+            uint32_t _hash = uint32_t(reinterpret_cast<uintptr_t>(owner) >> 4) * 2654435769u;
+
+            return _queues[_hash >> (32 - __builtin_ctz(SQUADS_CONFIG_REF_COUNTED_QUEUES))];
+        }
+    }
+
+    void ref_counted::release(uint32_t n) noexcept {
+        if(is_biased()) {
+            // the queued objects of the owner, this has a reference and stays alive
+            merge_queued();
+        }
+        // merge_queued can have merged this
+        if(is_biased()) {
+            uint32_t _biased = (n < uint32_t(m_iBiased)) ? n : uint32_t(m_iBiased);
+            m_iBiased -= int32_t(_biased);
+            n -= _biased;
+
+            if(m_iBiased == 0 && merge()) return;
+            if(n == 0) return;
+        }
+        release_shared(n);
+    }
+
+    bool ref_counted::merge() noexcept {
+        int32_t _add = (m_iBiased << count_shift) | flag_merged;
+        m_iBiased = 0;
+
+        // the merged flag is only set here, so the add sets the bit
+        int32_t _new = m_iShared.fetch_add(_add, atomic::memory_order::AcqRel) + _add;
+
+        if((_new >> count_shift) == 0 && (_new & flag_queued) == 0) {
+            destroy();
+            return true;
+        }
+        return false;
+    }
+
+    void ref_counted::release_shared(uint32_t n) noexcept {
+        int32_t _sub = int32_t(n) << count_shift;
+        int32_t _old = m_iShared.load(atomic::memory_order::Relaxed);
+        int32_t _new;
+
+        // the sub and the queued flag in one step: after a sub alone, the owner can
+        // merge and destroy the object, before the flag is set
+        do {
+            _new = _old - _sub;
+
+            if((_new & (flag_merged | flag_queued)) == 0 && (_new >> count_shift) <= 0)
+                _new |= flag_queued;
+        } while(!m_iShared.compare_exchange_weak(_old, _new, atomic::memory_order::AcqRel));
+
+        if((_new & flag_merged) != 0) {
+            // a queued object is destroyed by the owner
+            if((_new >> count_shift) == 0 && (_new & flag_queued) == 0) destroy();
+            return;
+        }
+        // the rest of the references are biased, the owner must merge. The object
+        // lives, until the owner has taken it from the queue
+        if((_old & flag_queued) == 0 && (_new & flag_queued) != 0)
+            internal::get_merge_queue(m_pOwner).push(&m_node);
+    }
+
+    void ref_counted::merge_from_queue() noexcept {
+        if((m_iShared.load(atomic::memory_order::Relaxed) & flag_merged) == 0) merge();
+
+        int32_t _old = m_iShared.fetch_and(~int32_t(flag_queued), atomic::memory_order::AcqRel);
+        if((_old >> count_shift) == 0) destroy();
+    }
+
+    void ref_counted::merge_queued() noexcept {
+        void* _task = arch::arch_get_current_task();
+        internal::merge_queue& _queue = internal::get_merge_queue(_task);
+
+        if(_queue.empty()) return;
+
+        merge_node* _node = _queue.pop_all();
+        merge_node* _first = nullptr;
+        merge_node* _last = nullptr;
+
+        while(_node != nullptr) {
+            merge_node* _next = _node->next;
+
+            if(_node->object->m_pOwner == _task) {
+                _node->object->merge_from_queue();
+            } else {
+                // a other owner in the same queue
+                _node->next = _first;
+                _first = _node;
+                if(_last == nullptr) _last = _node;
+            }
+            _node = _next;
+        }
+        if(_first != nullptr) _queue.push_chain(_first, _last);
+    }
+}
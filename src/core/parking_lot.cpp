@@ -0,0 +1,107 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#include "core/parking_lot.hpp"
+
+namespace squads {
+    namespace internal {
+        struct alignas(SQUADS_CONFIG_CACHE_LINE_SIZE) parking_bucket {
+            wait_queue queue;
+        };
+
+        static_assert((SQUADS_CONFIG_PARKING_LOT_BUCKETS & (SQUADS_CONFIG_PARKING_LOT_BUCKETS - 1)) == 0 &&
+            SQUADS_CONFIG_PARKING_LOT_BUCKETS >= 2, "SQUADS_CONFIG_PARKING_LOT_BUCKETS must be a power of two");
+
+        static parking_bucket g_aParkingDefault[SQUADS_CONFIG_PARKING_LOT_BUCKETS];
+        static parking_bucket* g_pParkingBuckets = g_aParkingDefault;
+        static unsigned int g_uiParkingCount = SQUADS_CONFIG_PARKING_LOT_BUCKETS;
+        static unsigned int g_uiParkingBits = __builtin_ctz(SQUADS_CONFIG_PARKING_LOT_BUCKETS);
+    }
+
+    bool parking_lot::init(unsigned int buckets) {
+        if(internal::g_pParkingBuckets != internal::g_aParkingDefault) return false;
+
+        unsigned int _bits = 1;
+        while((1u << _bits) < buckets && _bits < 16) _bits++;
+
+        internal::parking_bucket* _table = new internal::parking_bucket[1u << _bits];
+        if(_table == nullptr) return false;
+
+        internal::g_uiParkingBits = _bits;
+        internal::g_uiParkingCount = 1u << _bits;
+        internal::g_pParkingBuckets = _table;
+
+        return true;
+    }
+
+    wait_queue& parking_lot::get_queue(const volatile void* address) {
+        // fibonacci hashing, the high bits are the best mixed
+        uint32_t _hash = uint32_t(reinterpret_cast<uintptr_t>(address) >> 2) * 2654435769u;
+
+        return internal::g_pParkingBuckets[_hash >> (32 - internal::g_uiParkingBits)].queue;
+    }
+
+    bool parking_lot::unpark_one(const volatile void* address) {
+        wait_queue& _queue = get_queue(address);
+        uintptr_t _key = reinterpret_cast<uintptr_t>(address);
+        wait_node* _woken = nullptr;
+
+        _queue.lock();
+        for(wait_node* _node = _queue.front(); _node != nullptr; _node = _node->next) {
+            if(_node->key == _key) {
+                _queue.pop(_node);
+                _woken = _node;
+                break;
+            }
+        }
+        _queue.unlock();
+
+        if(_woken == nullptr) return false;
+
+        wait_queue::wake(_woken);
+        return true;
+    }
+
+    unsigned int parking_lot::unpark_all(const volatile void* address) {
+        wait_queue& _queue = get_queue(address);
+        uintptr_t _key = reinterpret_cast<uintptr_t>(address);
+        wait_node* _chain = nullptr;
+        unsigned int _count = 0;
+
+        _queue.lock();
+        wait_node* _node = _queue.front();
+        while(_node != nullptr) {
+            wait_node* _next = _node->next;
+
+            if(_node->key == _key) {
+                _queue.pop(_node);
+                _node->next = _chain;
+                _chain = _node;
+                _count++;
+            }
+            _node = _next;
+        }
+        _queue.unlock();
+
+        wait_queue::wake_chain(_chain);
+        return _count;
+    }
+
+    unsigned int parking_lot::get_bucket_count() {
+        return internal::g_uiParkingCount;
+    }
+}
@@ -21,29 +21,34 @@
 
 
 namespace squads {
-    basic_binary_semaphore::basic_binary_semaphore() : m_bLock(false) { }
+    basic_binary_semaphore::basic_binary_semaphore() : m_uiState(unlocked) { }
     
     int basic_binary_semaphore::lock(unsigned int timeout) noexcept {
-        for (;;) {
-            if (!m_bLock.exchange(true, atomic::memory_order::Acquire)) {
-                break;
-            }
-            while (m_bLock.load(atomic::memory_order::Relaxed)) {
-                squads::arch::arch_yield();
+        if (try_lock()) return 0;
+        if (timeout == 0) return 1;
+
+        basic_deadline _dl = basic_deadline::from_ticks(timeout);
+
+        // mark contended, so the unlock wakes up a parked task
+        while (m_uiState.exchange(contended, atomic::memory_order::Acquire) != unlocked) {
+            auto const pred = [this] { return m_uiState.load(atomic::memory_order::Relaxed) == contended; };
+
+            if (parking_lot::park(&m_uiState, pred, _dl.remaining_ticks()) == parking_lot::park_timeout) {
+                uint32_t _expected = unlocked;
+                return m_uiState.compare_exchange_strong(_expected, contended, atomic::memory_order::Acquire) ? 0 : 1;
             }
         }
         return 0;
     }
 
     bool basic_binary_semaphore::try_lock() noexcept {
-        return !m_bLock.load(atomic::memory_order::Relaxed) &&
-            (!m_bLock.exchange(true, atomic::memory_order::Acquire));
+        uint32_t _expected = unlocked;
+        return m_uiState.compare_exchange_strong(_expected, locked, atomic::memory_order::Acquire);
     }
 
     int basic_binary_semaphore::unlock() noexcept {
-        m_bLock.store(false, atomic::memory_order::Release);
+        if (m_uiState.exchange(unlocked, atomic::memory_order::Release) == contended)
+            parking_lot::unpark_one(&m_uiState);
         return 0;
     }
-
-    
-}
\ No newline at end of file
+}
@@ -0,0 +1,118 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+
+#include "core/task.hpp"
+#include "core/task_local.hpp"
+#include "arch/arch_utils.hpp"
+
+namespace squads {
+    namespace internal {
+        /** guards the slots and the list of the blocks */
+        static arch::arch_mux_t g_muxTaskLocal = SQUADS_ARCH_CONFIG_MUX_INIT;
+        /** the destroy function of each slot, nullptr when the slot is free */
+        static task_local_destroy_t g_aTaskLocalDestroy[SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS];
+        static task_local_block* g_pTaskLocalBlocks = nullptr;
+
+        int task_local_register(task_local_destroy_t destroy) {
+            int _slot = -1;
+
+            arch::arch_mux_lock(&g_muxTaskLocal);
+            for(int i = 0; i < SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS; i++) {
+                if(g_aTaskLocalDestroy[i] == nullptr) {
+                    g_aTaskLocalDestroy[i] = destroy;
+                    _slot = i;
+                    break;
+                }
+            }
+            arch::arch_mux_unlock(&g_muxTaskLocal);
+
+            return _slot;
+        }
+
+        void task_local_unregister(int slot) {
+            if(slot < 0 || slot >= SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS) return;
+
+            task_local_destroy_t _destroy = g_aTaskLocalDestroy[slot];
+
+            // take the values one by one, the destroy runs without the mux
+            for(;;) {
+                void* _value = nullptr;
+
+                arch::arch_mux_lock(&g_muxTaskLocal);
+                for(task_local_block* _block = g_pTaskLocalBlocks; _block != nullptr; _block = _block->next) {
+                    if(_block->values[slot] != nullptr) {
+                        _value = _block->values[slot];
+                        _block->values[slot] = nullptr;
+                        break;
+                    }
+                }
+                if(_value == nullptr) g_aTaskLocalDestroy[slot] = nullptr;
+                arch::arch_mux_unlock(&g_muxTaskLocal);
+
+                if(_value == nullptr) return;
+                _destroy(_value);
+            }
+        }
+
+        task_local_block* task_local_create_block() {
+            task_local_block* _block = new task_local_block();
+            if(_block == nullptr) return nullptr;
+
+            for(int i = 0; i < SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS; i++)
+                _block->values[i] = nullptr;
+
+            arch::arch_mux_lock(&g_muxTaskLocal);
+            _block->prev = nullptr;
+            _block->next = g_pTaskLocalBlocks;
+            if(g_pTaskLocalBlocks != nullptr) g_pTaskLocalBlocks->prev = _block;
+            g_pTaskLocalBlocks = _block;
+            arch::arch_mux_unlock(&g_muxTaskLocal);
+
+            SQUADS_ARCH_TLS_SET(SQUADS_CONFIG_TASK_LOCAL_TLS_INDEX, _block);
+            return _block;
+        }
+
+        void task_local_cleanup(task* t) {
+            task_local_block* _block = static_cast<task_local_block*>(
+                task::get_storage_pointer(t, SQUADS_CONFIG_TASK_LOCAL_TLS_INDEX) );
+
+            if(_block == nullptr) return;
+
+            task::set_storage_pointer(t, SQUADS_CONFIG_TASK_LOCAL_TLS_INDEX, nullptr);
+
+            // unlink the block, a later release of a slot doesn't see it
+            task_local_destroy_t _destroy[SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS];
+
+            arch::arch_mux_lock(&g_muxTaskLocal);
+            if(_block->prev != nullptr) _block->prev->next = _block->next;
+            else g_pTaskLocalBlocks = _block->next;
+            if(_block->next != nullptr) _block->next->prev = _block->prev;
+
+            for(int i = 0; i < SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS; i++)
+                _destroy[i] = g_aTaskLocalDestroy[i];
+            arch::arch_mux_unlock(&g_muxTaskLocal);
+
+            // destroy in reverse order of the slots
+            for(int i = SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS - 1; i >= 0; i--) {
+                if(_block->values[i] != nullptr && _destroy[i] != nullptr)
+                    _destroy[i](_block->values[i]);
+            }
+            delete _block;
+        }
+    }
+}
@@ -0,0 +1,117 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#include "config.hpp"
+#include "core/timespan.hpp"
+#include "core/timestamp.hpp"
+
+namespace squads {
+    namespace {
+        const basic_timespan::time_type us_per_ms   = 1000LL;
+        const basic_timespan::time_type us_per_sec  = 1000LL * us_per_ms;
+        const basic_timespan::time_type us_per_min  = 60LL * us_per_sec;
+        const basic_timespan::time_type us_per_hour = 60LL * us_per_min;
+        const basic_timespan::time_type us_per_day  = 24LL * us_per_hour;
+    }
+
+    basic_timespan::basic_timespan() : m_timeSpan(0) { }
+
+    basic_timespan::basic_timespan(time_type ms) : m_timeSpan(ms) { }
+
+    basic_timespan::basic_timespan(struct timeval& val) : m_timeSpan(0) {
+        assign(val);
+    }
+
+    basic_timespan::basic_timespan(uint16_t days, uint8_t hours, uint8_t minutes, uint8_t seconds, uint16_t microSeconds)
+        : m_timeSpan(0) {
+        assign(days, hours, minutes, seconds, microSeconds);
+    }
+
+    basic_timespan::basic_timespan(const self_type& other) : m_timeSpan(other.m_timeSpan) { }
+
+    uint16_t basic_timespan::get_days() const {
+        return uint16_t(m_timeSpan / us_per_day);
+    }
+    uint8_t basic_timespan::get_hours() const {
+        return uint8_t((m_timeSpan / us_per_hour) % 24);
+    }
+    uint8_t basic_timespan::get_minutes() const {
+        return uint8_t((m_timeSpan / us_per_min) % 60);
+    }
+    uint8_t basic_timespan::get_seconds() const {
+        return uint8_t((m_timeSpan / us_per_sec) % 60);
+    }
+    uint16_t basic_timespan::get_milliseconds() const {
+        return uint16_t((m_timeSpan / us_per_ms) % 1000);
+    }
+    basic_timespan::int_type basic_timespan::get_microseconds() const {
+        return int_type(m_timeSpan % us_per_ms);
+    }
+
+    basic_timespan::int_type basic_timespan::get_total_hours() const {
+        return int_type(m_timeSpan / us_per_hour);
+    }
+    basic_timespan::int_type basic_timespan::get_total_minutes() const {
+        return int_type(m_timeSpan / us_per_min);
+    }
+    basic_timespan::int_type basic_timespan::get_total_seconds() const {
+        return int_type(m_timeSpan / us_per_sec);
+    }
+    basic_timespan::int_type basic_timespan::get_total_milliseconds() const {
+        return int_type(m_timeSpan / us_per_ms);
+    }
+    basic_timespan::int_type basic_timespan::get_total_microseconds() const {
+        return int_type(m_timeSpan);
+    }
+
+    basic_timespan& basic_timespan::operator = (const self_type& timespan) {
+        m_timeSpan = timespan.m_timeSpan; return *this;
+    }
+    basic_timespan& basic_timespan::operator = (time_type microseconds) {
+        m_timeSpan = microseconds; return *this;
+    }
+    basic_timespan& basic_timespan::operator = (struct timeval val) {
+        return assign(val);
+    }
+
+    basic_timespan& basic_timespan::assign(uint16_t days, uint8_t hours, uint8_t minutes, uint8_t seconds, uint16_t microSeconds) {
+        m_timeSpan = time_type(days) * us_per_day + time_type(hours) * us_per_hour +
+                     time_type(minutes) * us_per_min + time_type(seconds) * us_per_sec +
+                     time_type(microSeconds);
+        return *this;
+    }
+
+    basic_timespan& basic_timespan::assign(struct timeval val) {
+        m_timeSpan = time_type(val.tv_sec) * us_per_sec + time_type(val.tv_usec);
+        return *this;
+    }
+
+    basic_timespan basic_timespan::now() {
+        return basic_timespan(basic_timestamp().get_microseconds());
+    }
+
+    basic_timespan basic_timespan::from_ticks(const unsigned int& ticks) {
+        return basic_timespan(time_type(ticks) * SQUADS_ARCH_NSPER_TICK / 1000LL);
+    }
+
+    basic_timespan::time_type basic_timespan::to_ticks() const {
+        if(m_timeSpan <= 0) return 0;
+
+        // rounded up, a wait is never shorter than the span
+        return (m_timeSpan * 1000LL + SQUADS_ARCH_NSPER_TICK - 1) / SQUADS_ARCH_NSPER_TICK;
+    }
+}
@@ -0,0 +1,50 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+#include "config.hpp"
+#include "core/timestamp.hpp"
+
+#include <sys/time.h>
+
+namespace squads {
+    basic_timestamp::basic_timestamp() : m_time(0) {
+        update();
+    }
+
+    basic_timestamp::basic_timestamp(time_type tv) : m_time(tv) { }
+
+    basic_timestamp::basic_timestamp(const self_type& other) : m_time(other.m_time) { }
+
+    void basic_timestamp::update() {
+        struct timeval _tv;
+        gettimeofday(&_tv, NULL);
+
+        m_time = time_type(_tv.tv_sec) * resulution + time_type(_tv.tv_usec);
+    }
+
+    void basic_timestamp::swap(self_type& time) {
+        squads::swap(m_time, time.m_time);
+    }
+
+    basic_timestamp basic_timestamp::from_epoch(const squads::time_t t) {
+        return self_type(time_type(t) * resulution);
+    }
+
+    basic_timestamp basic_timestamp::from_utc(const time_type val) {
+        return self_type((val - ((time_type(0x01b21dd2) << 32) + 0x13814000)) / 10);
+    }
+}
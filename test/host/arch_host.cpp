@@ -0,0 +1,260 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * The arch layer of the host build: the squads::arch functions over std::thread,
+ * so the primitives can be tested and benchmarked on a development machine.
+ *
+ * - A task is a thread, the handle is a per thread host_task.
+ * - park/unpark and the task notification are a counter with a condition variable,
+ *   arch_abort_delay wakes a blocked park like xTaskAbortDelay.
+ * - The mux is a recursive spinlock, that yields while it spins.
+ * - The ticks are milliseconds (configTICK_RATE_HZ 1000) of the steady clock.
+ */
+#include "config.hpp"
+#include "arch/arch_utils.hpp"
+#include "arch/arch_mutex_impl.hpp"
+#include "core/task.hpp"
+#include "core/task_local.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+    struct host_task {
+        std::mutex mtx;
+        std::condition_variable cv;
+        uint32_t notify = 0;
+        bool blocked = false;
+        bool aborted = false;
+        int core = 0;
+        uint32_t token = 0;
+        void* storage[configNUM_THREAD_LOCAL_STORAGE_POINTERS] = { };
+    };
+
+    std::atomic<uint32_t> g_uiTasks(0);
+    const auto g_start = std::chrono::steady_clock::now();
+
+    /**
+     * @brief Destroy the task_local values, when the thread ends.
+     * The host_task self is never freed, a late unpark can't touch freed memory.
+     */
+    struct host_task_guard {
+        host_task* task = nullptr;
+
+        ~host_task_guard() {
+            if(task != nullptr) squads::internal::task_local_cleanup(nullptr);
+        }
+    };
+
+    host_task* current() {
+        static thread_local host_task_guard _guard;
+
+        if(_guard.task == nullptr) {
+            host_task* _task = new host_task();
+
+            _task->token = g_uiTasks.fetch_add(1) + 1;
+            _task->core = int(_task->token % SQUADS_CONFIG_NUM_CORES);
+            _guard.task = _task;
+        }
+        return _guard.task;
+    }
+
+    /**
+     * @brief Wait for a notification, like ulTaskNotifyTake(pdTRUE, timeout).
+     */
+    uint32_t notify_take(unsigned int timeout) {
+        host_task* _task = current();
+        std::unique_lock<std::mutex> _lock(_task->mtx);
+
+        auto _ready = [_task] { return _task->notify != 0 || _task->aborted; };
+
+        if(!_ready() && timeout != 0) {
+            _task->blocked = true;
+            if(timeout == SQUADS_PORTMAX_DELAY) _task->cv.wait(_lock, _ready);
+            else _task->cv.wait_for(_lock, std::chrono::milliseconds(timeout), _ready);
+            _task->blocked = false;
+        }
+        _task->aborted = false;
+
+        uint32_t _value = _task->notify;
+        _task->notify = 0;
+        return _value;
+    }
+
+    void notify_give(void* handle) {
+        host_task* _task = static_cast<host_task*>(handle);
+        {
+            std::lock_guard<std::mutex> _lock(_task->mtx);
+            _task->notify++;
+        }
+        _task->cv.notify_one();
+    }
+
+    /**
+     * @brief A binary semaphore, the native object of squads::mutex on the host.
+     */
+    struct host_semaphore {
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool taken = false;
+    };
+}
+
+extern "C" {
+namespace squads {
+    namespace arch {
+        unsigned long arch_micros() {
+            return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - g_start).count();
+        }
+        unsigned long arch_millis() {
+            return arch_micros() / 1000;
+        }
+        unsigned int arch_get_ticks() {
+            return (unsigned int)(arch_micros() / 1000);
+        }
+        int arch_get_core_id() {
+            return current()->core;
+        }
+        bool arch_in_isr() {
+            return false;
+        }
+        void* arch_get_current_task() {
+            return current();
+        }
+        void arch_notify_give(void* handle) {
+            if(handle != nullptr) notify_give(handle);
+        }
+        bool arch_abort_delay(void* handle) {
+            if(handle == nullptr) return false;
+
+            host_task* _task = static_cast<host_task*>(handle);
+            {
+                std::lock_guard<std::mutex> _lock(_task->mtx);
+                if(!_task->blocked) return false;
+                _task->aborted = true;
+            }
+            _task->cv.notify_one();
+            return true;
+        }
+
+        void arch_mux_init(arch_mux_t* mux) {
+            mux->owner = 0;
+            mux->count = 0;
+        }
+        void arch_mux_lock(arch_mux_t* mux) {
+            uint32_t _token = current()->token;
+
+            if(__atomic_load_n(&mux->owner, __ATOMIC_RELAXED) == _token) {
+                mux->count++;
+                return;
+            }
+            for(;;) {
+                uint32_t _free = 0;
+                if(__atomic_compare_exchange_n(&mux->owner, &_free, _token, false,
+                                               __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) break;
+                std::this_thread::yield();
+            }
+            mux->count = 1;
+        }
+        void arch_mux_unlock(arch_mux_t* mux) {
+            if(--mux->count == 0)
+                __atomic_store_n(&mux->owner, 0, __ATOMIC_RELEASE);
+        }
+
+        bool arch_park(unsigned int timeout) {
+            return notify_take(timeout) != 0;
+        }
+        void arch_unpark(void* handle) {
+            if(handle != nullptr) notify_give(handle);
+        }
+
+        void arch_cpu_relax() {
+            // the holder of a lock may be preempted, give it the cpu
+            std::this_thread::yield();
+        }
+        void arch_yield() {
+            std::this_thread::yield();
+        }
+        void arch_delay(const unsigned long& ts) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(ts));
+        }
+        void arch_task_panic() {
+            std::abort();
+        }
+    }
+}
+}
+
+void* pvTaskGetThreadLocalStoragePointer(TaskHandle_t task, BaseType_t index) {
+    host_task* _task = (task != nullptr) ? static_cast<host_task*>(task) : current();
+    if(index < 0 || index >= configNUM_THREAD_LOCAL_STORAGE_POINTERS) return nullptr;
+
+    return _task->storage[index];
+}
+
+void vTaskSetThreadLocalStoragePointer(TaskHandle_t task, BaseType_t index, void* value) {
+    host_task* _task = (task != nullptr) ? static_cast<host_task*>(task) : current();
+    if(index >= 0 && index < configNUM_THREAD_LOCAL_STORAGE_POINTERS) _task->storage[index] = value;
+}
+
+namespace squads {
+    namespace arch {
+        bool arch_mutex_simple_impl::create() {
+            m_pHandle = new host_semaphore();
+            return true;
+        }
+        bool arch_mutex_simple_impl::destroy() {
+            delete static_cast<host_semaphore*>(m_pHandle);
+            m_pHandle = nullptr;
+            return true;
+        }
+        bool arch_mutex_simple_impl::take(unsigned int timeout) noexcept {
+            host_semaphore* _sem = static_cast<host_semaphore*>(m_pHandle);
+            std::unique_lock<std::mutex> _lock(_sem->mtx);
+
+            auto _free = [_sem] { return !_sem->taken; };
+
+            if(timeout == SQUADS_PORTMAX_DELAY) _sem->cv.wait(_lock, _free);
+            else if(!_sem->cv.wait_for(_lock, std::chrono::milliseconds(timeout), _free)) return false;
+
+            _sem->taken = true;
+            return true;
+        }
+        bool arch_mutex_simple_impl::give() noexcept {
+            host_semaphore* _sem = static_cast<host_semaphore*>(m_pHandle);
+            {
+                std::lock_guard<std::mutex> _lock(_sem->mtx);
+                if(!_sem->taken) return false;
+                _sem->taken = false;
+            }
+            _sem->cv.notify_one();
+            return true;
+        }
+    }
+
+    void task::set_storage_pointer(task* t, unsigned short index, void* value) {
+        if(t == nullptr) vTaskSetThreadLocalStoragePointer(nullptr, index, value);
+    }
+    void* task::get_storage_pointer(task* t, unsigned short index) {
+        return (t == nullptr) ? pvTaskGetThreadLocalStoragePointer(nullptr, index) : nullptr;
+    }
+}
@@ -0,0 +1,68 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * atomic_shared_ptr read scaling: loads per second of 1..N readers, while one
+ * writer stores a new snapshot all 100 us.
+ */
+#include "host_test.hpp"
+#include "core/atomic_shared_ptr.hpp"
+
+using namespace squads;
+
+struct snapshot {
+    int version;
+    explicit snapshot(int v) : version(v) { }
+};
+
+static void run(unsigned readers) {
+    atomic_shared_ptr<snapshot> _ptr(make_shared<snapshot>(0));
+    volatile bool _stop = false;
+    unsigned long _loads = 0;
+    int _stores = 0;
+
+    double _secs = host_test::measure([&] {
+        std::thread _timer([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            __atomic_store_n(&_stop, true, __ATOMIC_RELAXED);
+        });
+        host_test::run_threads(readers + 1, [&](unsigned index) {
+            if(index == 0) {
+                while(!__atomic_load_n(&_stop, __ATOMIC_RELAXED)) {
+                    _ptr.store(make_shared<snapshot>(++_stores));
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+                return;
+            }
+            unsigned long _n = 0;
+            while(!__atomic_load_n(&_stop, __ATOMIC_RELAXED)) {
+                shared_ptr<snapshot> _snap = _ptr.load();
+                CHECK(_snap.get() != nullptr);
+                _n++;
+            }
+            __atomic_add_fetch(&_loads, _n, __ATOMIC_RELAXED);
+        });
+        _timer.join();
+    });
+    std::printf("%-8u %16.0f %10d\n", readers, double(_loads) / _secs, _stores);
+}
+
+int main() {
+    std::printf("%-8s %16s %10s\n", "readers", "loads/s", "stores");
+    for(unsigned _readers = 1; _readers <= host_test::max_threads(); _readers++) run(_readers);
+    return 0;
+}
@@ -0,0 +1,54 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * condition_variable round trip latency: two threads hand a turn back and
+ * forth, one round trip are two notify_one and two wakeups.
+ */
+#include "host_test.hpp"
+#include "core/condition_variable.hpp"
+#include "core/fast_mutex.hpp"
+#include "core/mutex.hpp"
+
+using namespace squads;
+
+template <class TMUTEX>
+static void run(const char* name, int rounds) {
+    TMUTEX _mtx;
+    condition_variable _cv;
+    int _turn = 0;
+
+    double _secs = host_test::measure([&] {
+        host_test::run_threads(2, [&](unsigned index) {
+            for(int i = 0; i < rounds; i++) {
+                _mtx.lock(SQUADS_PORTMAX_DELAY);
+                while(_turn != int(index)) _cv.wait(_mtx);
+                _turn = 1 - _turn;
+                _cv.notify_one();
+                _mtx.unlock();
+            }
+        });
+    });
+    std::printf("%-12s %10d round trips %10.2f us/round trip\n", name, rounds,
+                _secs * 1e6 / rounds);
+}
+
+int main() {
+    run<fast_mutex>("fast_mutex", 20000);
+    run<mutex>("mutex", 20000);
+    return 0;
+}
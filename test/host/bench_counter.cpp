@@ -0,0 +1,51 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * sharded_counter against counter<T>: increments per second of 1..N threads
+ * on one counter.
+ */
+#include "host_test.hpp"
+#include "core/counter.hpp"
+#include "core/sharded_counter.hpp"
+
+using namespace squads;
+
+template <class TCOUNTER>
+static double run(unsigned threads, unsigned long rounds) {
+    TCOUNTER _counter;
+
+    double _secs = host_test::measure([&] {
+        host_test::run_threads(threads, [&](unsigned) {
+            for(unsigned long i = 0; i < rounds; i++) ++_counter;
+        });
+    });
+    CHECK(uint32_t(_counter.value()) == uint32_t(threads * rounds));
+    return double(threads * rounds) / _secs;
+}
+
+int main() {
+    const unsigned long _rounds = 2000000;
+
+    std::printf("%-8s %18s %18s\n", "threads", "counter<u32>/s", "sharded_counter/s");
+    for(unsigned _threads = 1; _threads <= host_test::max_threads(); _threads++) {
+        double _plain = run<counter<uint32_t>>(_threads, _rounds);
+        double _sharded = run<sharded_counter<uint32_t>>(_threads, _rounds);
+        std::printf("%-8u %18.0f %18.0f\n", _threads, _plain, _sharded);
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * intrusive_ptr against squads::shared_ptr: copies (retain and release) per
+ * second in the owner task (biased count) and in 1..N other tasks.
+ */
+#include "host_test.hpp"
+#include "core/intrusive_ptr.hpp"
+#include "core/shared_ptr.hpp"
+
+using namespace squads;
+
+struct object : public ref_counted {
+    int value = 0;
+};
+
+struct plain {
+    int value = 0;
+};
+
+template <class TPTR>
+static double run(const TPTR& shared, unsigned threads, unsigned long rounds) {
+    double _secs = host_test::measure([&] {
+        host_test::run_threads(threads, [&](unsigned) {
+            for(unsigned long i = 0; i < rounds; i++) {
+                TPTR _copy(shared);
+                __asm__ __volatile__("" : : "r"(_copy.get()) : "memory");
+            }
+        });
+    });
+    return double(threads * rounds) / _secs;
+}
+
+template <class TPTR>
+static double run_owner(const TPTR& shared, unsigned long rounds) {
+    double _secs = host_test::measure([&] {
+        for(unsigned long i = 0; i < rounds; i++) {
+            TPTR _copy(shared);
+            __asm__ __volatile__("" : : "r"(_copy.get()) : "memory");
+        }
+    });
+    return double(rounds) / _secs;
+}
+
+int main() {
+    const unsigned long _rounds = 2000000;
+    intrusive_ptr<object> _intrusive(new object());
+    shared_ptr<plain> _shared = squads::make_shared<plain>();
+
+    std::printf("%-14s %18s %18s\n", "tasks", "intrusive_ptr/s", "shared_ptr/s");
+    std::printf("%-14s %18.0f %18.0f\n", "owner", run_owner(_intrusive, _rounds), run_owner(_shared, _rounds));
+
+    _intrusive->unbias();
+    for(unsigned _threads = 1; _threads <= host_test::max_threads(); _threads++) {
+        std::printf("%-14u %18.0f %18.0f\n", _threads,
+                    run(_intrusive, _threads, _rounds), run(_shared, _threads, _rounds));
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * lockfree_stack throughput: pop/push pairs per second of 1..N threads, one
+ * node and chains of 8 nodes.
+ */
+#include "host_test.hpp"
+#include "core/lockfree_stack.hpp"
+
+using namespace squads;
+
+struct node {
+    node* next;
+};
+
+static double run(unsigned threads, size_t chain, unsigned long rounds) {
+    static node _nodes[256];
+    lockfree_stack<node> _stack;
+
+    for(node& n : _nodes) _stack.push(&n);
+
+    double _secs = host_test::measure([&] {
+        host_test::run_threads(threads, [&](unsigned) {
+            for(unsigned long r = 0; r < rounds; r++) {
+                size_t _n = 0;
+                node* _first = _stack.pop_chain(chain, _n);
+                if(_first == nullptr) continue;
+
+                node* _last = _first;
+                while(_last->next != nullptr) _last = _last->next;
+                _stack.push_chain(_first, _last);
+            }
+        });
+    });
+    return double(threads * rounds) / _secs;
+}
+
+int main() {
+    const unsigned long _rounds = 500000;
+
+    std::printf("%-8s %16s %16s\n", "threads", "1 node/s", "8 nodes/s");
+    for(unsigned _threads = 1; _threads <= host_test::max_threads(); _threads++)
+        std::printf("%-8u %16.0f %16.0f\n", _threads, run(_threads, 1, _rounds), run(_threads, 8, _rounds));
+
+    return 0;
+}
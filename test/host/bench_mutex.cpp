@@ -0,0 +1,63 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * fast_mutex against squads::mutex: lock/unlock pairs per second for 1..N
+ * threads and a short, medium and long critical section.
+ */
+#include "host_test.hpp"
+#include "core/fast_mutex.hpp"
+#include "core/mutex.hpp"
+
+using namespace squads;
+
+static volatile unsigned long g_sink;
+
+static inline void critical_section(unsigned work) {
+    for(unsigned i = 0; i < work; i++) g_sink = g_sink + i;
+}
+
+template <class TMUTEX>
+static double run(unsigned threads, unsigned work, unsigned long rounds) {
+    TMUTEX _mtx;
+
+    double _secs = host_test::measure([&] {
+        host_test::run_threads(threads, [&](unsigned) {
+            for(unsigned long i = 0; i < rounds; i++) {
+                _mtx.lock(SQUADS_PORTMAX_DELAY);
+                critical_section(work);
+                _mtx.unlock();
+            }
+        });
+    });
+    return double(threads * rounds) / _secs;
+}
+
+int main() {
+    const unsigned _work[] = { 0, 10, 100 };
+    const unsigned long _rounds = 50000;
+
+    std::printf("%-8s %-6s %16s %16s\n", "threads", "work", "fast_mutex/s", "mutex/s");
+    for(unsigned _threads = 1; _threads <= host_test::max_threads(); _threads++) {
+        for(unsigned _w : _work) {
+            double _fast = run<fast_mutex>(_threads, _w, _rounds);
+            double _slow = run<mutex>(_threads, _w, _rounds);
+            std::printf("%-8u %-6u %16.0f %16.0f\n", _threads, _w, _fast, _slow);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * basic_counting_semaphore throughput and fairness: acquire(n)/release(n)
+ * pairs per second and max/min pairs per thread in a fixed time.
+ */
+#include "host_test.hpp"
+#include "core/semaphore.hpp"
+
+#include <algorithm>
+
+using namespace squads;
+
+static void run(unsigned threads, size_t n) {
+    basic_counting_semaphore<4> _sem;
+    std::vector<unsigned long> _count(threads, 0);
+    volatile bool _stop = false;
+
+    std::thread _timer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        __atomic_store_n(&_stop, true, __ATOMIC_RELAXED);
+    });
+    // the run time, the timer stops the threads after about 200 ms
+    double _secs = host_test::measure([&] {
+        host_test::run_threads(threads, [&](unsigned index) {
+            unsigned long _n = 0;
+
+            while(!__atomic_load_n(&_stop, __ATOMIC_RELAXED)) {
+                _sem.acquire(n);
+                _sem.release(n);
+                _n++;
+            }
+            _count[index] = _n;
+        });
+    });
+    _timer.join();
+    CHECK(_sem.get_left() == 4);
+
+    unsigned long _total = 0;
+    for(unsigned long c : _count) _total += c;
+
+    unsigned long _max = *std::max_element(_count.begin(), _count.end());
+    unsigned long _min = *std::min_element(_count.begin(), _count.end());
+
+    std::printf("%-8u %-4zu %14.0f %10.2f\n", threads, n, double(_total) / _secs,
+                _min == 0 ? 0.0 : double(_max) / double(_min));
+}
+
+int main() {
+    std::printf("%-8s %-4s %14s %10s\n", "threads", "n", "pairs/s", "max/min");
+    for(unsigned _threads = 1; _threads <= host_test::max_threads() * 2; _threads++) {
+        run(_threads, 1);
+        run(_threads, 3);
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * seqlock read scaling: loads per second of 1..N readers, while one writer
+ * stores a new pose all 10 us, compared with the same pose behind a std::mutex.
+ * Each reader checks, that it never sees a torn pose.
+ */
+#include "host_test.hpp"
+#include "core/seqlock.hpp"
+
+#include <mutex>
+
+using namespace squads;
+
+struct pose {
+    uint32_t x, y, z, version;
+};
+
+static pose make_pose(uint32_t v) {
+    return pose{ v, v * 3, v * 7, v };
+}
+
+static bool is_consistent(const pose& p) {
+    return p.x == p.version && p.y == p.version * 3 && p.z == p.version * 7;
+}
+
+template <class TLOAD, class TSTORE>
+static double run(unsigned readers, TLOAD load, TSTORE store, uint32_t& stores) {
+    volatile bool _stop = false;
+    unsigned long _loads = 0;
+    stores = 0;
+
+    double _secs = host_test::measure([&] {
+        std::thread _timer([&] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            __atomic_store_n(&_stop, true, __ATOMIC_RELAXED);
+        });
+        host_test::run_threads(readers + 1, [&](unsigned index) {
+            if(index == 0) {
+                while(!__atomic_load_n(&_stop, __ATOMIC_RELAXED)) {
+                    store(make_pose(++stores));
+                    std::this_thread::sleep_for(std::chrono::microseconds(10));
+                }
+                return;
+            }
+            unsigned long _n = 0;
+            while(!__atomic_load_n(&_stop, __ATOMIC_RELAXED)) {
+                CHECK(is_consistent(load()));
+                _n++;
+            }
+            __atomic_add_fetch(&_loads, _n, __ATOMIC_RELAXED);
+        });
+        _timer.join();
+    });
+    return double(_loads) / _secs;
+}
+
+int main() {
+    std::printf("%-8s %16s %10s %16s %10s\n", "readers", "seqlock loads/s", "stores",
+                "mutex loads/s", "stores");
+
+    for(unsigned _readers = 1; _readers <= host_test::max_threads(); _readers++) {
+        seqlock<pose> _seq;
+        std::mutex _mtx;
+        pose _pose = make_pose(0);
+        uint32_t _seqStores, _mtxStores;
+
+        _seq.store(_pose);
+
+        double _seqRate = run(_readers,
+            [&] { return _seq.load(); },
+            [&](const pose& p) { _seq.store(p); }, _seqStores);
+        double _mtxRate = run(_readers,
+            [&] { std::lock_guard<std::mutex> _lock(_mtx); return _pose; },
+            [&](const pose& p) { std::lock_guard<std::mutex> _lock(_mtx); _pose = p; }, _mtxStores);
+
+        std::printf("%-8u %16.0f %10u %16.0f %10u\n", _readers, _seqRate, _seqStores,
+                    _mtxRate, _mtxStores);
+    }
+    return 0;
+}
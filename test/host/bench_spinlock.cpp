@@ -0,0 +1,103 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * Contention of the spinlocks: the throughput and the fairness (max/min
+ * acquisitions per thread in a fixed time) of ticket_spinlock, mcs_spinlock
+ * and spinlock<T>.
+ */
+#include "host_test.hpp"
+#include "core/spinlock.hpp"
+#include "core/ticket_spinlock.hpp"
+#include "core/mcs_spinlock.hpp"
+
+#include <algorithm>
+
+using namespace squads;
+
+static volatile unsigned long g_sink;
+
+/**
+ * @brief Adapt the mcs_spinlock to lock()/unlock(), with a node per thread.
+ */
+struct mcs_adapter {
+    mcs_spinlock lock_;
+
+    void lock(mcs_node& n) { lock_.lock(n); }
+    void unlock(mcs_node& n) { lock_.unlock(n); }
+};
+
+template <class TLOCK>
+struct plain_adapter {
+    TLOCK lock_;
+
+    void lock(mcs_node&) { lock_.lock(); }
+    void unlock(mcs_node&) { lock_.unlock(); }
+};
+
+template <class TADAPTER>
+static void run(const char* name, unsigned threads, unsigned work) {
+    TADAPTER _lock;
+    std::vector<unsigned long> _count(threads, 0);
+    unsigned long _shared = 0;
+    volatile bool _stop = false;
+
+    std::thread _timer([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        __atomic_store_n(&_stop, true, __ATOMIC_RELAXED);
+    });
+    // the run time, the timer stops the threads after about 200 ms
+    double _secs = host_test::measure([&] {
+        host_test::run_threads(threads, [&](unsigned index) {
+            mcs_node _node;
+            unsigned long _n = 0;
+
+            while(!__atomic_load_n(&_stop, __ATOMIC_RELAXED)) {
+                _lock.lock(_node);
+                _shared++;
+                for(unsigned i = 0; i < work; i++) g_sink = g_sink + i;
+                _lock.unlock(_node);
+                _n++;
+            }
+            _count[index] = _n;
+        });
+    });
+    _timer.join();
+
+    unsigned long _total = 0;
+    for(unsigned long c : _count) _total += c;
+    CHECK(_total == _shared);
+
+    unsigned long _max = *std::max_element(_count.begin(), _count.end());
+    unsigned long _min = *std::min_element(_count.begin(), _count.end());
+
+    std::printf("%-16s %-8u %-6u %14.0f %10.2f\n", name, threads, work,
+                double(_total) / _secs, _min == 0 ? 0.0 : double(_max) / double(_min));
+}
+
+int main() {
+    std::printf("%-16s %-8s %-6s %14s %10s\n", "lock", "threads", "work", "locks/s", "max/min");
+    for(unsigned _threads = 1; _threads <= host_test::max_threads(); _threads++) {
+        for(unsigned _work : { 0u, 50u }) {
+            run<plain_adapter<ticket_spinlock>>("ticket_spinlock", _threads, _work);
+            run<plain_adapter<basic_ticket_spinlock<yield_backoff>>>("ticket/yield", _threads, _work);
+            run<mcs_adapter>("mcs_spinlock", _threads, _work);
+            run<plain_adapter<spinlock<int>>>("spinlock<int>", _threads, _work);
+        }
+    }
+    return 0;
+}
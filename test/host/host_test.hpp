@@ -0,0 +1,66 @@
+/*
+ * Small helpers for the host tests and benchmarks, no test framework needed.
+ */
+#ifndef __SQUADS_HOST_TEST_H__
+#define __SQUADS_HOST_TEST_H__
+
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Check a condition, print the location and abort, when it fails.
+ * Unlike assert it stays active with NDEBUG.
+ */
+#define CHECK(cond)                                                         \
+    do {                                                                    \
+        if(!(cond)) {                                                       \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n",               \
+                         __FILE__, __LINE__, #cond);                        \
+            std::abort();                                                   \
+        }                                                                   \
+    } while(0)
+
+namespace host_test {
+    /**
+     * @brief Run fn(index) on n threads, all start together and return when all are done.
+     */
+    template <typename TFUNC>
+    void run_threads(unsigned n, TFUNC fn) {
+        std::vector<std::thread> _threads;
+        volatile bool _go = false;
+
+        _threads.reserve(n);
+        for(unsigned i = 0; i < n; i++) {
+            _threads.emplace_back([&_go, &fn, i] {
+                while(!__atomic_load_n(&_go, __ATOMIC_ACQUIRE)) std::this_thread::yield();
+                fn(i);
+            });
+        }
+        __atomic_store_n(&_go, true, __ATOMIC_RELEASE);
+        for(auto& t : _threads) t.join();
+    }
+
+    /**
+     * @brief The wall time of fn() in seconds.
+     */
+    template <typename TFUNC>
+    double measure(TFUNC fn) {
+        auto _start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+    }
+
+    /**
+     * @brief The number of threads for a contention run, the cpus but at least 2.
+     */
+    inline unsigned max_threads() {
+        unsigned _n = std::thread::hardware_concurrency();
+        return _n < 2 ? 2 : (_n > 8 ? 8 : _n);
+    }
+}
+
+#endif
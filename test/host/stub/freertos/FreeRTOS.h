@@ -0,0 +1,42 @@
+/*
+ * Minimal FreeRTOS declarations for the host build, only the types and
+ * macros that the squads headers use in include/arch/freertos/config.hpp.
+ */
+#ifndef __SQUADS_HOST_STUB_FREERTOS_H__
+#define __SQUADS_HOST_STUB_FREERTOS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+
+typedef uint32_t TickType_t;
+typedef void* TaskHandle_t;
+typedef void* EventGroupHandle_t;
+typedef void* QueueHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+typedef struct {
+    volatile uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED                { 0, 0 }
+#define portNUM_PROCESSORS                          2
+#define portMAX_DELAY                               0xffffffffu
+#define tskNO_AFFINITY                              0x7fffffff
+#define tskIDLE_PRIORITY                            0
+
+#define configMAX_PRIORITIES                        25
+#define configTICK_RATE_HZ                          1000
+#define configSUPPORT_DYNAMIC_ALLOCATION            1
+#define configQUEUE_REGISTRY_SIZE                   0
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS     2
+
+#define pdTRUE                                      1
+#define pdFALSE                                     0
+#define pdPASS                                      1
+#define pdFAIL                                      0
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ * Only the thread local storage pointers, implemented in arch_host.cpp.
+ */
+#ifndef __SQUADS_HOST_STUB_TASK_H__
+#define __SQUADS_HOST_STUB_TASK_H__
+
+#include "freertos/FreeRTOS.h"
+
+void* pvTaskGetThreadLocalStoragePointer(TaskHandle_t task, BaseType_t index);
+void vTaskSetThreadLocalStoragePointer(TaskHandle_t task, BaseType_t index, void* value);
+
+#endif
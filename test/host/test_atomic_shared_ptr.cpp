@@ -0,0 +1,154 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * atomic_shared_ptr with more tasks than hazard records (built with
+ * SQUADS_CONFIG_HAZARD_MAX_TASKS 2): a load never reports empty, a compare
+ * exchange never spins forever and no box or object leaks. Readers in overflow
+ * records hold their guards at the same time, without blocking a writer.
+ */
+#include "host_test.hpp"
+#include "core/atomic_shared_ptr.hpp"
+
+using namespace squads;
+
+static_assert(SQUADS_CONFIG_HAZARD_MAX_TASKS == 2, "build with 2 hazard records");
+
+static int g_alive;
+
+struct snapshot {
+    int version;
+    int check;
+
+    explicit snapshot(int v) : version(v), check(v * 7) { __atomic_add_fetch(&g_alive, 1, __ATOMIC_RELAXED); }
+    ~snapshot() { __atomic_sub_fetch(&g_alive, 1, __ATOMIC_RELAXED); }
+};
+
+using domain_type = memory::hazard_domain<>;
+
+/**
+ * @brief Use the domain once, then wait for all: so all threads use the domain at the same time.
+ */
+template <class TPTR>
+static void join_all(TPTR& ptr, int& arrived, unsigned threads) {
+    CHECK(ptr.load().get() != nullptr);
+    __atomic_add_fetch(&arrived, 1, __ATOMIC_ACQ_REL);
+    while(__atomic_load_n(&arrived, __ATOMIC_ACQUIRE) < int(threads)) std::this_thread::yield();
+}
+using pointer_type = basic_atomic_shared_ptr<snapshot, shared_count_atomic, domain_type>;
+
+static void test_readers_and_writer() {
+    {
+        domain_type _domain;
+        {
+            pointer_type _ptr(make_shared<snapshot>(0), _domain);
+            const unsigned _readers = 5;
+            int _arrived = 0;
+
+            host_test::run_threads(_readers + 1, [&](unsigned index) {
+                join_all(_ptr, _arrived, _readers + 1);
+
+                if(index == 0) {
+                    for(int v = 1; v <= 5000; v++) {
+                        _ptr.store(make_shared<snapshot>(v));
+                        if((v & 15) == 0) std::this_thread::yield();
+                    }
+                    return;
+                }
+                int _last = 0;
+                for(int i = 0; i < 5000; i++) {
+                    shared_ptr<snapshot> _snap = _ptr.load();
+
+                    CHECK(_snap.get() != nullptr);
+                    CHECK(_snap->check == _snap->version * 7);
+                    CHECK(_snap->version >= _last);
+                    _last = _snap->version;
+                }
+            });
+            CHECK(_ptr.load()->version == 5000);
+            CHECK(!_ptr.is_lock_free());
+        }
+    }
+    CHECK(g_alive == 0);
+}
+
+static void test_compare_exchange() {
+    {
+        domain_type _domain;
+        {
+            pointer_type _ptr(make_shared<snapshot>(0), _domain);
+            const unsigned _threads = 5;
+            const int _rounds = 2000;
+            int _arrived = 0;
+
+            host_test::run_threads(_threads, [&](unsigned) {
+                join_all(_ptr, _arrived, _threads);
+
+                for(int i = 0; i < _rounds; i++) {
+                    shared_ptr<snapshot> _expected = _ptr.load();
+
+                    while(!_ptr.compare_exchange_strong(_expected, make_shared<snapshot>(_expected->version + 1)))
+                        CHECK(_expected.get() != nullptr);
+                }
+            });
+            CHECK(_ptr.load()->version == int(_threads) * _rounds);
+        }
+    }
+    CHECK(g_alive == 0);
+}
+
+static void test_overflow_readers() {
+    {
+        domain_type _domain;
+        atomic::basic_atomic_gcc<snapshot*> _src(_domain.construct<snapshot>(1));
+        const unsigned _readers = 4;
+        int _held = 0;
+        volatile bool _done = false;
+
+        host_test::run_threads(_readers + 1, [&](unsigned index) {
+            if(index == 0) {
+                while(__atomic_load_n(&_held, __ATOMIC_ACQUIRE) < int(_readers)) std::this_thread::yield();
+
+                // two readers hold overflow records at the same time, the writer doesn't wait
+                CHECK(_domain.get_overflow_count() >= 2);
+                snapshot* _old = _src.exchange(_domain.construct<snapshot>(2));
+                _domain.retire(_old);
+                _domain.scan();
+                CHECK(__atomic_load_n(&g_alive, __ATOMIC_RELAXED) == 2);
+
+                __atomic_store_n(&_done, true, __ATOMIC_RELEASE);
+                return;
+            }
+            domain_type::guard _hp(_domain, 0);
+            snapshot* _snap = _hp.protect(_src);
+
+            __atomic_add_fetch(&_held, 1, __ATOMIC_ACQ_REL);
+            while(!__atomic_load_n(&_done, __ATOMIC_ACQUIRE)) std::this_thread::yield();
+            CHECK(_snap->version == 1 && _snap->check == 7);
+        });
+        _domain.retire(_src.exchange(nullptr));
+    }
+    CHECK(g_alive == 0);
+}
+
+int main() {
+    test_overflow_readers();
+    test_readers_and_writer();
+    test_compare_exchange();
+    std::printf("test_atomic_shared_ptr: ok\n");
+    return 0;
+}
@@ -0,0 +1,111 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * barrier: over many phases all participants arrive before any passes, the
+ * completion function runs once per phase before the waiters wake up, and
+ * arrive_and_drop shrinks the next phases; a lonely arriver times out.
+ */
+#include "host_test.hpp"
+#include "core/barrier.hpp"
+
+using namespace squads;
+
+struct counting_completion {
+    volatile int* arrived;
+    volatile int* completions;
+    volatile ptrdiff_t* expected;
+
+    void operator()() noexcept {
+        // all participants of the phase arrived, exactly once
+        CHECK(*arrived == *expected);
+        *arrived = 0;
+        *completions = *completions + 1;
+    }
+};
+
+using counting_barrier = barrier<counting_completion>;
+
+static void test_phases(unsigned threads) {
+    const int _phases = 100;
+    volatile int _arrived = 0;
+    volatile int _completions = 0;
+    volatile ptrdiff_t _expected = threads;
+
+    counting_barrier _barrier(threads, counting_completion{ &_arrived, &_completions, &_expected });
+
+    host_test::run_threads(threads, [&](unsigned) {
+        for(int i = 0; i < _phases; i++) {
+            __atomic_add_fetch(&_arrived, 1, __ATOMIC_RELAXED);
+            CHECK(_barrier.arrive_and_wait(5000) == 0);
+
+            // the completion of this phase has run
+            CHECK(__atomic_load_n(&_completions, __ATOMIC_RELAXED) >= i + 1);
+        }
+    });
+    CHECK(_completions == _phases);
+    CHECK(_barrier.get_phase() == uint32_t(_phases));
+}
+
+static void test_arrive_and_drop() {
+    const unsigned _threads = 6;
+    const int _phases = 40;
+    volatile int _arrived = 0;
+    volatile int _completions = 0;
+    volatile ptrdiff_t _expected = _threads;
+
+    counting_barrier _barrier(_threads, counting_completion{ &_arrived, &_completions, &_expected });
+
+    host_test::run_threads(_threads, [&](unsigned index) {
+        for(int i = 0; i < _phases; i++) {
+            __atomic_add_fetch(&_arrived, 1, __ATOMIC_RELAXED);
+
+            // two tasks leave the group at phase 10 and 20
+            if((index == 0 && i == 10) || (index == 1 && i == 20)) {
+                __atomic_sub_fetch(&_expected, 1, __ATOMIC_RELAXED);
+                __atomic_sub_fetch(&_arrived, 1, __ATOMIC_RELAXED);
+                _barrier.arrive_and_drop();
+                return;
+            }
+            CHECK(_barrier.arrive_and_wait(5000) == 0);
+        }
+    });
+    CHECK(_completions == _phases);
+    CHECK(_barrier.get_expected() == ptrdiff_t(_threads - 2));
+}
+
+static void test_timeout() {
+    barrier<> _barrier(2);
+
+    uint32_t _phase = _barrier.arrive();
+    CHECK(_barrier.wait(_phase, 10) == 1);
+    CHECK(_barrier.wait(_phase, 0) == 1);
+
+    // the second arrival completes the phase
+    CHECK(_barrier.arrive_and_wait(0) == 0);
+    CHECK(_barrier.wait(_phase, 10) == 0);
+    CHECK(_barrier.get_phase() == 1);
+}
+
+int main() {
+    test_phases(2);
+    test_phases(SQUADS_CONFIG_BARRIER_ARITY * SQUADS_CONFIG_BARRIER_ARITY + 3);
+    test_arrive_and_drop();
+    test_timeout();
+    std::printf("test_barrier: ok\n");
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * cancellation_token: the cancel wakes each registered task once and never waits
+ * for them; a task, that was not blocked yet, leaves its next park at once; the
+ * event_flags deadline wait reports the cancel in its status.
+ */
+#include "host_test.hpp"
+#include "core/cancellation_token.hpp"
+#include "core/event_flags.hpp"
+#include "core/fast_mutex.hpp"
+#include "core/wait_queue.hpp"
+
+using namespace squads;
+
+static void test_cancel_parked() {
+    cancellation_token _token;
+    fast_mutex _mutex;
+    volatile int _result = -1;
+
+    _mutex.lock();
+    host_test::run_threads(2, [&](unsigned index) {
+        if(index == 0) {
+            _result = _mutex.lock(basic_deadline::from_ticks(5000), &_token);
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        _token.cancel();
+    });
+    CHECK(_result == SQUADS_RESULT_CANCELLED);
+    _mutex.unlock();
+
+    // cancelled before the call
+    CHECK(_mutex.lock(basic_deadline::from_ticks(5000), &_token) == SQUADS_RESULT_CANCELLED);
+
+    _token.reset();
+    CHECK(_mutex.lock(basic_deadline::from_ticks(5000), &_token) == 0);
+    _mutex.unlock();
+}
+
+static void test_cancel_before_park() {
+    cancellation_token _token;
+    volatile bool _registered = false;
+    volatile bool _cancelled = false;
+    double _cancel = 0, _wait = 0;
+
+    host_test::run_threads(2, [&](unsigned index) {
+        if(index == 0) {
+            wait_queue _queue;
+            wait_node _node;
+            cancellation_scope _scope(&_token);
+
+            __atomic_store_n(&_registered, true, __ATOMIC_RELEASE);
+            // registered but busy, the wake up of the cancel comes before the park
+            while(!__atomic_load_n(&_cancelled, __ATOMIC_ACQUIRE)) std::this_thread::yield();
+
+            _queue.lock();
+            _queue.push_back(&_node);
+            _wait = host_test::measure([&] { CHECK(!_queue.wait(_node, 5000)); });
+            CHECK(_scope.failed_result() == SQUADS_RESULT_CANCELLED);
+            return;
+        }
+        while(!__atomic_load_n(&_registered, __ATOMIC_ACQUIRE)) std::this_thread::yield();
+
+        _cancel = host_test::measure([&] { _token.cancel(); });
+        __atomic_store_n(&_cancelled, true, __ATOMIC_RELEASE);
+    });
+    CHECK(_cancel < 1.0);
+    CHECK(_wait < 1.0);
+}
+
+static void test_event_flags_status() {
+    cancellation_token _token;
+    event_flags _flags;
+    int _status = -1;
+
+    _flags.set(1);
+    _flags.wait(1, true, false, basic_deadline::from_ticks(100), &_token, &_status);
+    CHECK(_status == 0);
+
+    _flags.wait(1, false, false, basic_deadline::from_ticks(20), &_token, &_status);
+    CHECK(_status == 1);
+
+    _token.cancel();
+    _flags.wait(1, false, false, basic_deadline::from_ticks(100), &_token, &_status);
+    CHECK(_status == SQUADS_RESULT_CANCELLED);
+}
+
+int main() {
+    test_cancel_parked();
+    test_cancel_before_park();
+    test_event_flags_status();
+    std::printf("test_cancellation_token: ok\n");
+    return 0;
+}
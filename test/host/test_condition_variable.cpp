@@ -0,0 +1,120 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * condition_variable: ping-pong, notify_all wakes all waiters, the timeout,
+ * a cancel while another task holds the lock and the lock is held again on
+ * return.
+ */
+#include "host_test.hpp"
+#include "core/condition_variable.hpp"
+#include "core/fast_mutex.hpp"
+#include "core/cancellation_token.hpp"
+#include "core/deadline.hpp"
+
+#include <atomic>
+
+using namespace squads;
+
+static void test_ping_pong() {
+    fast_mutex _mtx;
+    condition_variable _cv;
+    int _turn = 0;
+    const int _rounds = 5000;
+
+    host_test::run_threads(2, [&](unsigned index) {
+        for(int i = 0; i < _rounds; i++) {
+            _mtx.lock();
+            while(_turn != int(index)) _cv.wait(_mtx);
+            CHECK(_mtx.is_locked());
+            _turn = 1 - _turn;
+            _cv.notify_one();
+            _mtx.unlock();
+        }
+    });
+}
+
+static void test_notify_all() {
+    fast_mutex _mtx;
+    condition_variable _cv;
+    bool _ready = false;
+    int _woken = 0;
+    const unsigned _waiters = 4;
+
+    std::thread _notifier([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        _mtx.lock();
+        _ready = true;
+        _cv.notify_all();
+        _mtx.unlock();
+    });
+    host_test::run_threads(_waiters, [&](unsigned) {
+        _mtx.lock();
+        while(!_ready) _cv.wait(_mtx);
+        _woken++;
+        _mtx.unlock();
+    });
+    _notifier.join();
+    CHECK(_woken == int(_waiters));
+}
+
+static void test_timeout() {
+    fast_mutex _mtx;
+    condition_variable _cv;
+
+    _mtx.lock();
+    CHECK(_cv.wait(_mtx, 10) == 1);
+    CHECK(_mtx.is_locked());
+    _mtx.unlock();
+}
+
+// The waiter is cancelled while the canceller holds the lock. It must wait
+// for the lock and hold it again when wait returns.
+static void test_cancel_relock() {
+    fast_mutex _mtx;
+    condition_variable _cv;
+    cancellation_token _token;
+    std::atomic<bool> _parked(false);
+    std::atomic<bool> _released(false);
+
+    std::thread _canceller([&] {
+        while(!_parked.load()) std::this_thread::yield();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        _mtx.lock();
+        _token.cancel();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        _released.store(true);
+        _mtx.unlock();
+    });
+
+    _mtx.lock();
+    _parked.store(true);
+    CHECK(_cv.wait(_mtx, basic_deadline::from_ticks(5000), &_token) == SQUADS_RESULT_CANCELLED);
+    CHECK(_mtx.is_locked());
+    CHECK(_released.load());
+    _mtx.unlock();
+    _canceller.join();
+}
+
+int main() {
+    test_ping_pong();
+    test_notify_all();
+    test_timeout();
+    test_cancel_relock();
+    std::printf("test_condition_variable: ok\n");
+    return 0;
+}
@@ -0,0 +1,68 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * debug_lock with the lock profiler: acquisitions, contention, timeouts and
+ * failed try_lock's are counted apart.
+ */
+#include "host_test.hpp"
+#include "core/debug_lock.hpp"
+#include "core/mutex.hpp"
+
+using namespace squads;
+
+static_assert(SQUADS_CONFIG_LOCK_PROFILER == SQUADS_CONFIG_YES, "build with the lock profiler");
+
+static void test_counters() {
+    mutex _mtx;
+    debug_lock<mutex> _dbg(_mtx, "test");
+
+    CHECK(_dbg.lock(SQUADS_PORTMAX_DELAY) == 0);
+    CHECK(_dbg.get_profile().get_acquisitions() == 1);
+    CHECK(_dbg.get_profile().get_contended() == 0);
+
+    host_test::run_threads(1, [&](unsigned) {
+        CHECK(!_dbg.try_lock());
+        CHECK(_dbg.lock(0) == 1);
+        CHECK(_dbg.lock(10) == 1);
+    });
+    CHECK(_dbg.get_profile().get_try_fails() == 2);
+    CHECK(_dbg.get_profile().get_timeouts() == 1);
+    CHECK(_dbg.get_profile().get_wait_max() >= 5000);
+
+    std::thread _waiter([&] {
+        CHECK(_dbg.lock(SQUADS_PORTMAX_DELAY) == 0);
+        _dbg.unlock();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    _dbg.unlock();
+    _waiter.join();
+
+    CHECK(_dbg.get_profile().get_acquisitions() == 2);
+    CHECK(_dbg.get_profile().get_contended() == 1);
+    CHECK(_dbg.get_profile().get_hold_max() >= 5000);
+
+    _dbg.reset();
+    CHECK(_dbg.get_profile().get_try_fails() == 0);
+    CHECK(_dbg.get_profile().get_timeouts() == 0);
+}
+
+int main() {
+    test_counters();
+    std::printf("test_debug_lock: ok\n");
+    return 0;
+}
@@ -0,0 +1,98 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * epoch based reclamation: a retired object lives while a reader is in a
+ * critical section, and a domain can die before the tasks that used it. More
+ * domains than task_local slots are created one after the other.
+ */
+#include "host_test.hpp"
+#include "memory/ebr_domain.hpp"
+
+#include <memory>
+
+using namespace squads;
+using namespace squads::memory;
+
+static int g_iLive = 0;
+
+struct node {
+    int value;
+    explicit node(int v) : value(v) { __atomic_add_fetch(&g_iLive, 1, __ATOMIC_RELAXED); }
+    ~node() { __atomic_sub_fetch(&g_iLive, 1, __ATOMIC_RELAXED); }
+};
+
+static int live() { return __atomic_load_n(&g_iLive, __ATOMIC_RELAXED); }
+
+static void test_reader_holds() {
+    ebr_domain<> _domain;
+    node* _n = _domain.construct<node>(1);
+    volatile int _step = 0;
+
+    host_test::run_threads(2, [&](unsigned index) {
+        if(index == 0) {
+            ebr_domain<>::guard _cs(_domain);
+            CHECK(_cs);
+            __atomic_store_n(&_step, 1, __ATOMIC_RELEASE);
+            while(__atomic_load_n(&_step, __ATOMIC_ACQUIRE) != 2) std::this_thread::yield();
+            // the reader still may touch the node
+            CHECK(_n->value == 1);
+            return;
+        }
+        while(__atomic_load_n(&_step, __ATOMIC_ACQUIRE) != 1) std::this_thread::yield();
+
+        CHECK(_domain.retire(_n));
+        for(int i = 0; i < 4; i++) _domain.collect();
+        CHECK(live() == 1);
+        __atomic_store_n(&_step, 2, __ATOMIC_RELEASE);
+    });
+    for(int i = 0; i < 4; i++) _domain.collect();
+    CHECK(live() == 0);
+}
+
+static void test_domain_dies_first() {
+    for(int round = 0; round < 3 * SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS; round++) {
+        std::unique_ptr<ebr_domain<>> _domain(new ebr_domain<>());
+        volatile int _step = 0;
+
+        host_test::run_threads(2, [&](unsigned index) {
+            if(index == 0) {
+                // the task binds a record and lives longer than the domain
+                {
+                    ebr_domain<>::guard _cs(*_domain);
+                    CHECK(_cs);
+                }
+                __atomic_store_n(&_step, 1, __ATOMIC_RELEASE);
+                while(__atomic_load_n(&_step, __ATOMIC_ACQUIRE) != 2) std::this_thread::yield();
+                return;
+            }
+            while(__atomic_load_n(&_step, __ATOMIC_ACQUIRE) != 1) std::this_thread::yield();
+
+            CHECK(_domain->retire(_domain->construct<node>(round)));
+            _domain.reset();
+            CHECK(live() == 0);
+            __atomic_store_n(&_step, 2, __ATOMIC_RELEASE);
+        });
+    }
+}
+
+int main() {
+    test_reader_holds();
+    test_domain_dies_first();
+    std::printf("test_ebr_domain: ok\n");
+    return 0;
+}
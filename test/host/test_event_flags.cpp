@@ -0,0 +1,87 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * event_flags: wait any/all, clear on exit and sync as a reusable rendezvous,
+ * the last arriver must not block.
+ */
+#include "host_test.hpp"
+#include "core/event_flags.hpp"
+
+using namespace squads;
+
+static void test_wait() {
+    event_flags32 _flags;
+
+    _flags.set(0x5);
+    CHECK(_flags.wait(0x4, false, false, 0) == 0x5);
+    CHECK(_flags.wait(0x7, false, true, 0) == 0x5);
+    CHECK(_flags.wait(0x1, true, true, 0) == 0x5);
+    CHECK(_flags.get() == 0x4);
+
+    std::thread _setter([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        _flags.set(0x3);
+    });
+    CHECK((_flags.wait(0x7, true, true) & 0x7) == 0x7);
+    _setter.join();
+    CHECK(_flags.get() == 0);
+}
+
+static void test_sync_last_arriver() {
+    event_flags32 _flags;
+
+    // the only task of the sync is the last arriver, it returns at once
+    CHECK(_flags.sync(0x3, 0x3, 100) == 0x3);
+    CHECK(_flags.get() == 0);
+    CHECK(_flags.sync(0x1, 0x3, 0) == 0x1);
+    CHECK(_flags.sync(0x2, 0x3, 0) == 0x3);
+    CHECK(_flags.get() == 0);
+}
+
+template <class TFLAGS>
+static void test_sync_rounds(unsigned threads) {
+    TFLAGS _flags;
+    const typename TFLAGS::event_bit_type _all = (typename TFLAGS::event_bit_type(1) << threads) - 1;
+    int _arrived[64] = { };
+    const int _rounds = 500;
+
+    host_test::run_threads(threads, [&](unsigned index) {
+        typename TFLAGS::event_bit_type _bit = typename TFLAGS::event_bit_type(1) << index;
+
+        for(int r = 0; r < _rounds; r++) {
+            __atomic_add_fetch(&_arrived[r % 64], 1, __ATOMIC_RELAXED);
+
+            CHECK((_flags.sync(_bit, _all, 5000) & _all) == _all);
+            // nobody leaves a round, before all arrived
+            CHECK(__atomic_load_n(&_arrived[r % 64], __ATOMIC_RELAXED) >= int(threads));
+            if(index == 0) __atomic_store_n(&_arrived[(r + 32) % 64], 0, __ATOMIC_RELAXED);
+        }
+    });
+    CHECK(_flags.get() == 0);
+    CHECK(_flags.get_waiters() == 0);
+}
+
+int main() {
+    test_wait();
+    test_sync_last_arriver();
+    test_sync_rounds<event_flags32>(2);
+    test_sync_rounds<event_flags32>(host_test::max_threads() + 1);
+    test_sync_rounds<event_flags>(host_test::max_threads());
+    std::printf("test_event_flags: ok\n");
+    return 0;
+}
@@ -0,0 +1,81 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * fast_mutex: mutual exclusion under contention, try_lock and the lock timeout.
+ */
+#include "host_test.hpp"
+#include "core/fast_mutex.hpp"
+
+using namespace squads;
+
+static void test_exclusion() {
+    fast_mutex _mtx;
+    unsigned long _counter = 0;
+    const unsigned _threads = host_test::max_threads();
+    const unsigned long _rounds = 20000;
+
+    host_test::run_threads(_threads, [&](unsigned) {
+        for(unsigned long i = 0; i < _rounds; i++) {
+            CHECK(_mtx.lock() == 0);
+            _counter++;
+            _mtx.unlock();
+        }
+    });
+    CHECK(_counter == _threads * _rounds);
+    CHECK(!_mtx.is_locked());
+}
+
+static void test_try_lock_and_timeout() {
+    fast_mutex _mtx;
+
+    CHECK(_mtx.try_lock());
+    CHECK(!_mtx.try_lock());
+
+    host_test::run_threads(1, [&](unsigned) {
+        CHECK(_mtx.lock(0) == 1);
+        CHECK(_mtx.lock(20) == 1);
+    });
+    _mtx.unlock();
+    CHECK(_mtx.lock(0) == 0);
+    _mtx.unlock();
+}
+
+static void test_handoff_to_parked() {
+    fast_mutex _mtx;
+    volatile bool _got = false;
+
+    CHECK(_mtx.lock() == 0);
+    std::thread _waiter([&] {
+        CHECK(_mtx.lock() == 0);
+        __atomic_store_n(&_got, true, __ATOMIC_RELEASE);
+        _mtx.unlock();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CHECK(!__atomic_load_n(&_got, __ATOMIC_ACQUIRE));
+    _mtx.unlock();
+    _waiter.join();
+    CHECK(_got);
+}
+
+int main() {
+    test_exclusion();
+    test_try_lock_and_timeout();
+    test_handoff_to_parked();
+    std::printf("test_fast_mutex: ok\n");
+    return 0;
+}
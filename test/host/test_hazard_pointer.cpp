@@ -0,0 +1,90 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * hazard pointer domain: a protected node is not freed before the hazard is
+ * cleared, and a domain can die before the tasks that used it. More domains
+ * than task_local slots are created one after the other, each frees its slot.
+ */
+#include "host_test.hpp"
+#include "memory/hazard_pointer.hpp"
+
+#include <memory>
+
+using namespace squads;
+using namespace squads::memory;
+
+static int g_iLive = 0;
+
+struct node {
+    int value;
+    explicit node(int v) : value(v) { __atomic_add_fetch(&g_iLive, 1, __ATOMIC_RELAXED); }
+    ~node() { __atomic_sub_fetch(&g_iLive, 1, __ATOMIC_RELAXED); }
+};
+
+static int live() { return __atomic_load_n(&g_iLive, __ATOMIC_RELAXED); }
+
+static void test_protect() {
+    hazard_domain<> _domain;
+    atomic::basic_atomic_gcc<node*> _head(_domain.construct<node>(1));
+
+    {
+        hazard_domain<>::guard _hp(_domain, 0);
+        node* _n = _hp.protect(_head);
+        CHECK(_n != nullptr && _n->value == 1);
+
+        _head.store(nullptr);
+        _domain.retire(_n);
+        _domain.scan();
+        // still in the hazard slot
+        CHECK(live() == 1 && _n->value == 1);
+    }
+    _domain.scan();
+    CHECK(live() == 0);
+}
+
+static void test_domain_dies_first() {
+    for(int round = 0; round < 3 * SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS; round++) {
+        std::unique_ptr<hazard_domain<>> _domain(new hazard_domain<>());
+        atomic::basic_atomic_gcc<node*> _head(_domain->construct<node>(round));
+        volatile int _step = 0;
+
+        host_test::run_threads(2, [&](unsigned index) {
+            if(index == 0) {
+                // the task binds a record and lives longer than the domain
+                CHECK(_domain->protect(0, _head) != nullptr);
+                _domain->clear(0);
+                __atomic_store_n(&_step, 1, __ATOMIC_RELEASE);
+                while(__atomic_load_n(&_step, __ATOMIC_ACQUIRE) != 2) std::this_thread::yield();
+                return;
+            }
+            while(__atomic_load_n(&_step, __ATOMIC_ACQUIRE) != 1) std::this_thread::yield();
+
+            _domain->retire(_head.exchange(nullptr));
+            _domain.reset();
+            CHECK(live() == 0);
+            __atomic_store_n(&_step, 2, __ATOMIC_RELEASE);
+        });
+    }
+}
+
+int main() {
+    test_protect();
+    test_domain_dies_first();
+    std::printf("test_hazard_pointer: ok\n");
+    return 0;
+}
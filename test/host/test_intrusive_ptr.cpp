@@ -0,0 +1,100 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * ref_counted with biased counting: releases of other tasks race with the
+ * unbias (merge) of the owner, each object must be destroyed exactly once.
+ */
+#include "host_test.hpp"
+#include "core/intrusive_ptr.hpp"
+
+#include <new>
+
+using namespace squads;
+
+static int g_destroyed;
+
+struct object : public ref_counted {
+    int dead = 0;
+protected:
+    // the objects are in a static pool, so a double destroy is found and not a crash
+    void destroy() noexcept override {
+        CHECK(__atomic_exchange_n(&dead, 1, __ATOMIC_ACQ_REL) == 0);
+        __atomic_add_fetch(&g_destroyed, 1, __ATOMIC_RELAXED);
+    }
+};
+
+static void test_owner_only() {
+    object* _obj = new object();
+    {
+        intrusive_ptr<object> _a(_obj);
+        intrusive_ptr<object> _b(_a);
+        CHECK(_obj->use_count() == 2);
+    }
+    CHECK(_obj->dead == 1);
+    delete _obj;
+}
+
+static void test_cross_task_release() {
+    const int _helpers = 3;
+    const int _rounds = 3000;
+    alignas(object) static unsigned char _pool[2][sizeof(object)];
+    object* volatile _slot[_helpers] = { };
+
+    g_destroyed = 0;
+    host_test::run_threads(_helpers + 1, [&](unsigned index) {
+        if(index != 0) {
+            // a helper: release the reference, that the owner handed over
+            for(int r = 0; r < _rounds; r++) {
+                object* _obj;
+                while((_obj = __atomic_load_n(&_slot[index - 1], __ATOMIC_ACQUIRE)) == nullptr)
+                    std::this_thread::yield();
+                __atomic_store_n(&_slot[index - 1], nullptr, __ATOMIC_RELAXED);
+                _obj->release();
+            }
+            return;
+        }
+        unsigned _seed = 12345;
+
+        for(int r = 0; r < _rounds; r++) {
+            object* _obj = new (_pool[r & 1]) object();
+
+            _obj->retain(_helpers + 1);
+            for(int i = 0; i < _helpers; i++)
+                __atomic_store_n(&_slot[i], _obj, __ATOMIC_RELEASE);
+
+            _seed = _seed * 1103515245 + 12345;
+            if((_seed >> 16) & 1) std::this_thread::yield();
+            if((_seed >> 17) & 1) _obj->unbias();
+            _obj->release();
+
+            while(__atomic_load_n(&_obj->dead, __ATOMIC_ACQUIRE) == 0) {
+                ref_counted::merge_queued();
+                std::this_thread::yield();
+            }
+            _obj->~object();
+        }
+    });
+    CHECK(g_destroyed == _rounds);
+}
+
+int main() {
+    test_owner_only();
+    test_cross_task_release();
+    std::printf("test_intrusive_ptr: ok\n");
+    return 0;
+}
@@ -0,0 +1,129 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * basic_job_scheduler: the jobs pop in deadline order (submit order on equal
+ * deadlines), cancel and reschedule keep the heap right, and a job with a far
+ * deadline runs after the aging limit before newer, more urgent jobs.
+ */
+#include "host_test.hpp"
+#include "core/job_scheduler.hpp"
+
+using namespace squads;
+
+class test_job : public basic_job {
+public:
+    test_job() : id(0), cancelled(false) { }
+
+    virtual void on_run() override { }
+    virtual void on_cancel() override { cancelled = true; }
+
+    int id;
+    bool cancelled;
+};
+
+using scheduler_type = basic_job_scheduler<64, 4>;
+
+static void test_deadline_order() {
+    scheduler_type _scheduler;
+    test_job _jobs[40];
+    unsigned _seed = 12345;
+
+    for(int i = 0; i < 40; i++) {
+        _seed = _seed * 1103515245 + 12345;
+        _jobs[i].id = i;
+
+        // many equal deadlines, for the submit order
+        CHECK(_scheduler.submit(&_jobs[i], basic_deadline::from_ticks(100 + (_seed >> 16) % 8)).is_valid());
+    }
+    CHECK(_scheduler.size() == 40);
+
+    basic_deadline _last = basic_deadline::from_ticks(0);
+    int _lastId = -1;
+
+    for(int i = 0; i < 40; i++) {
+        basic_deadline _deadline;
+        test_job* _job = static_cast<test_job*>(_scheduler.pop(&_deadline));
+        CHECK(_job != nullptr);
+
+        int32_t _diff = int32_t(_deadline.get_expire_tick() - _last.get_expire_tick());
+        CHECK(_diff >= 0);
+        if(_diff == 0) CHECK(_job->id > _lastId);
+
+        _last = _deadline;
+        _lastId = _job->id;
+    }
+    CHECK(_scheduler.pop() == nullptr);
+    CHECK(_scheduler.empty());
+}
+
+static void test_cancel_reschedule() {
+    scheduler_type _scheduler;
+    test_job _jobs[3];
+    job_handle _handles[3];
+
+    for(int i = 0; i < 3; i++) {
+        _jobs[i].id = i;
+        _handles[i] = _scheduler.submit(&_jobs[i], basic_deadline::from_ticks(1000 + i * 100));
+    }
+    // the last job first, the first job cancelled
+    CHECK(_scheduler.reschedule(_handles[2], basic_deadline::from_ticks(500)));
+    CHECK(_scheduler.cancel(_handles[0]));
+    CHECK(_jobs[0].cancelled);
+    CHECK(!_scheduler.cancel(_handles[0]));
+
+    basic_deadline _next;
+    CHECK(_scheduler.peek(_next));
+    CHECK(_scheduler.pop() == &_jobs[2]);
+    CHECK(_scheduler.pop() == &_jobs[1]);
+
+    // the handle of a run job is stale, also when the slot is used again
+    job_handle _reused = _scheduler.submit(&_jobs[0], basic_timespan(1000));
+    CHECK(!_scheduler.reschedule(_handles[1], basic_deadline::from_ticks(10)));
+    CHECK(_scheduler.reschedule(_reused, basic_deadline::from_ticks(10)));
+    CHECK(_scheduler.pop() == &_jobs[0]);
+}
+
+static void test_aging() {
+    scheduler_type _scheduler;
+    test_job _old, _urgent, _forever;
+
+    _scheduler.set_aging_limit(basic_timespan(20000));
+
+    // a far deadline, the aging limit makes the key now + 20 ticks
+    _scheduler.submit(&_old, basic_deadline::from_ticks(100000));
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+
+    // newer and more urgent then the deadline, but after the aged key
+    _scheduler.submit(&_urgent, basic_deadline::from_ticks(1000));
+    _scheduler.submit(&_forever, basic_deadline::infinite());
+
+    CHECK(_scheduler.pop() == &_old);
+    CHECK(_scheduler.pop() == &_urgent);
+
+    basic_deadline _deadline;
+    CHECK(_scheduler.pop(&_deadline) == &_forever);
+    CHECK(_deadline.is_infinite());
+}
+
+int main() {
+    test_deadline_order();
+    test_cancel_reschedule();
+    test_aging();
+    std::printf("test_job_scheduler: ok\n");
+    return 0;
+}
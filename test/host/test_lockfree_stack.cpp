@@ -0,0 +1,151 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * lockfree_stack MPMC stress: all threads pop nodes and chains, overwrite the
+ * link while they own the node (like a allocated pool block) and push them
+ * back. No node may be owned twice and no node may get lost.
+ */
+#include "host_test.hpp"
+#include "core/lockfree_stack.hpp"
+
+using namespace squads;
+
+struct node {
+    node* next;
+    int owned;
+};
+
+static node* const g_poison = reinterpret_cast<node*>(uintptr_t(0x10));
+
+static void take(node* n) {
+    CHECK(__atomic_exchange_n(&n->owned, 1, __ATOMIC_ACQ_REL) == 0);
+}
+
+static void give(node* n) {
+    __atomic_store_n(&n->owned, 0, __ATOMIC_RELEASE);
+}
+
+static void test_stress() {
+    const size_t _count = 64;
+    static node _nodes[_count];
+    lockfree_stack<node> _stack;
+
+    for(size_t i = 0; i < _count; i++) _stack.push(&_nodes[i]);
+
+    host_test::run_threads(host_test::max_threads() + 2, [&](unsigned index) {
+        node* _held[8];
+        unsigned _seed = index * 7919 + 1;
+
+        for(int r = 0; r < 20000; r++) {
+            _seed = _seed * 1103515245 + 12345;
+            size_t _n = 0;
+
+            if((_seed >> 16) & 1) {
+                if((_held[0] = _stack.pop()) != nullptr) _n = 1;
+            } else {
+                size_t _max = 1 + (_seed >> 17) % 8;
+                node* _chain = _stack.pop_chain(_max, _n);
+
+                CHECK(_n <= _max);
+                for(size_t i = 0; i < _n; i++, _chain = _chain->next) _held[i] = _chain;
+                CHECK(_chain == nullptr);
+            }
+
+            // the owner reuses the link, a walk of a other task must not follow it
+            for(size_t i = 0; i < _n; i++) {
+                take(_held[i]);
+                _held[i]->next = g_poison;
+            }
+            // let the others run, while the nodes are held
+            if((r & 7) == 0) std::this_thread::yield();
+            for(size_t i = 0; i < _n; i++) give(_held[i]);
+
+            if(_n > 1 && ((_seed >> 20) & 1)) {
+                for(size_t i = 0; i + 1 < _n; i++) _held[i]->next = _held[i + 1];
+                _stack.push_chain(_held[0], _held[_n - 1]);
+            } else {
+                for(size_t i = 0; i < _n; i++) _stack.push(_held[i]);
+            }
+        }
+    });
+
+    size_t _left = 0;
+    for(node* n = _stack.pop_all(); n != nullptr; n = n->next) _left++;
+    CHECK(_left == _count);
+    CHECK(_stack.empty());
+}
+
+static void test_pop_chain() {
+    node _nodes[4] = { };
+    lockfree_stack<node> _stack;
+    size_t _n = 0;
+
+    CHECK(_stack.pop_chain(4, _n) == nullptr && _n == 0);
+    for(node& n : _nodes) _stack.push(&n);
+
+    node* _chain = _stack.pop_chain(3, _n);
+    CHECK(_n == 3);
+    CHECK(_chain == &_nodes[3] && _chain->next == &_nodes[2] && _chain->next->next == &_nodes[1]);
+    CHECK(_chain->next->next->next == nullptr);
+
+    CHECK(_stack.pop_chain(3, _n) == &_nodes[0] && _n == 1);
+    CHECK(_stack.empty());
+}
+
+static void test_tagged_head() {
+    using head_type = atomic::basic_atomic_tagged_ptr<node>;
+    using tagged_type = head_type::value_type;
+
+    static node _static;
+    node _stack;
+    node* _heap = new node();
+    head_type _head;
+
+    // the packed pointer keeps all kinds of addresses
+    for(node* n : { &_static, &_stack, _heap, static_cast<node*>(nullptr) }) {
+        _head.store(n);
+        CHECK(_head.load().ptr == n);
+    }
+    tagged_type _old = _head.load();
+    _head.store(_heap);
+    _head.store(nullptr);
+
+    // the same pointer, but a other version
+    CHECK(_head.load().ptr == _old.ptr);
+    CHECK(!_head.compare_exchange_strong(_old, &_static));
+    CHECK(_old == _head.load());
+    CHECK(_head.compare_exchange_strong(_old, &_static));
+    CHECK(_head.load().ptr == &_static);
+
+#if defined(SQUADS_CONFIG_TAGGED_PTR_ADDRESS_BITS)
+    CHECK(_head.is_lock_free());
+
+    // the version wraps in its bits, the pointer stays
+    for(int i = 0; i < (1 << 20); i++) _head.store(_heap);
+    CHECK(_head.load().ptr == _heap);
+#endif
+    delete _heap;
+}
+
+int main() {
+    test_tagged_head();
+    test_pop_chain();
+    test_stress();
+    std::printf("test_lockfree_stack: ok\n");
+    return 0;
+}
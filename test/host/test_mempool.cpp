@@ -0,0 +1,110 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * mempool: objects of all sizes up to the block size are constructed, each block
+ * is aligned for the alignment basic_storage asks for, and the lock free pool
+ * survives a alloc/free stress without a block owned twice or lost.
+ */
+#include "host_test.hpp"
+#include "memory/basic_mempool.hpp"
+
+using namespace squads;
+using namespace squads::memory;
+
+template <size_t TSIZE>
+struct object {
+    uint8_t data[TSIZE];
+};
+
+template <size_t TSIZE, class TALLOC>
+static void check_size(TALLOC& alloc) {
+    object<TSIZE>* _obj = alloc.template construct<object<TSIZE>>();
+
+    CHECK(_obj != nullptr);
+    CHECK((uintptr_t(_obj) % squads::alignment_for(TSIZE)) == 0);
+    alloc.destroy(_obj);
+}
+
+template <class TALLOC>
+static void check_sizes(TALLOC& alloc) {
+    check_size<1>(alloc);
+    check_size<4>(alloc);
+    check_size<12>(alloc);
+    check_size<16>(alloc);
+    check_size<24>(alloc);
+    check_size<40>(alloc);
+}
+
+static void test_alignment() {
+    using pool = basic_mempool<40, 4>;
+    using lockfree = basic_mempool_lockfree<40, 4>;
+
+    mempool_allocator<40, 4> _pool;
+    mempool_allocator_lockfree<40, 4> _lockfree;
+
+    // alignment_for asks for up to max_alignment
+    CHECK(pool::layout_type::alignment == squads::max_alignment);
+    check_sizes(_pool);
+    check_sizes(_lockfree);
+
+    CHECK(pool::get_free() == 4);
+    CHECK(lockfree::get_free() == 4);
+    CHECK(pool::get_corrupted() == 0);
+
+    // bigger than a block or a stronger alignment than the layout
+    CHECK(pool::allocate(41, 1) == nullptr);
+    CHECK(pool::allocate(8, squads::max_alignment * 2) == nullptr);
+}
+
+static void test_stress() {
+    using pool = basic_mempool_lockfree<24, 32>;
+    const size_t _align = squads::alignment_for(24);
+
+    host_test::run_threads(host_test::max_threads() + 2, [&](unsigned index) {
+        uintptr_t* _held[4];
+        uintptr_t _tag = index + 1;
+
+        for(int r = 0; r < 20000; r++) {
+            size_t _n = 0;
+
+            for(; _n < 4; _n++) {
+                _held[_n] = static_cast<uintptr_t*>(pool::allocate(24, _align));
+                if(_held[_n] == nullptr) break;
+
+                CHECK((uintptr_t(_held[_n]) % _align) == 0);
+                // the owner writes the whole payload, like a object
+                for(size_t i = 0; i < 24 / sizeof(uintptr_t); i++) _held[_n][i] = _tag;
+            }
+            if((r & 7) == 0) std::this_thread::yield();
+
+            for(size_t k = 0; k < _n; k++) {
+                for(size_t i = 0; i < 24 / sizeof(uintptr_t); i++) CHECK(_held[k][i] == _tag);
+                pool::deallocate(_held[k], 24, _align);
+            }
+        }
+    });
+    CHECK(pool::get_free() == 32);
+    CHECK(pool::get_corrupted() == 0);
+}
+
+int main() {
+    test_alignment();
+    test_stress();
+    std::printf("test_mempool: ok\n");
+    return 0;
+}
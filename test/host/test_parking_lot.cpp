@@ -0,0 +1,159 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * parking_lot and its users: a unpark wakes only the waiters of the address,
+ * a unpark_all racing with a timeout counts exactly the woken waiters; latch,
+ * basic_binary_semaphore and atomic wait/notify park and wake on it.
+ */
+#include "host_test.hpp"
+#include "core/parking_lot.hpp"
+#include "core/latch.hpp"
+#include "core/semaphore.hpp"
+#include "atomic/atomic.hpp"
+
+using namespace squads;
+
+static void test_park_unpark() {
+    volatile int _word[2] = { 0, 0 };
+    int _results[3] = { -1, -1, -1 };
+
+    // the validate function fails, no park
+    CHECK(parking_lot::park(&_word[0], [] { return false; }, 100) == parking_lot::park_invalid);
+    CHECK(parking_lot::park(&_word[0], [] { return true; }, 10) == parking_lot::park_timeout);
+    CHECK(!parking_lot::unpark_one(&_word[0]));
+
+    host_test::run_threads(4, [&](unsigned index) {
+        if(index < 3) {
+            const volatile void* _address = &_word[index == 2 ? 1 : 0];
+            _results[index] = parking_lot::park(_address, [] { return true; }, 2000);
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+
+        // only one of the two waiters of the first word
+        CHECK(parking_lot::unpark_one(&_word[0]));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        int _first = __atomic_load_n(&_results[0], __ATOMIC_RELAXED);
+        int _second = __atomic_load_n(&_results[1], __ATOMIC_RELAXED);
+        CHECK((_first == parking_lot::park_woken) != (_second == parking_lot::park_woken));
+        CHECK(__atomic_load_n(&_results[2], __ATOMIC_RELAXED) == -1);
+
+        CHECK(parking_lot::unpark_all(&_word[1]) == 1);
+        CHECK(parking_lot::unpark_all(&_word[0]) == 1);
+    });
+    CHECK(_results[0] == parking_lot::park_woken);
+    CHECK(_results[1] == parking_lot::park_woken);
+    CHECK(_results[2] == parking_lot::park_woken);
+}
+
+static void test_unpark_all_timeout_race() {
+    volatile int _word = 0;
+    const unsigned _waiters = 3;
+    unsigned _woken = 0, _counted = 0;
+
+    for(int round = 0; round < 200; round++) {
+        volatile unsigned _parked = 0;
+
+        host_test::run_threads(_waiters + 1, [&](unsigned index) {
+            if(index < _waiters) {
+                __atomic_add_fetch(&_parked, 1, __ATOMIC_RELEASE);
+                if(parking_lot::park(&_word, [] { return true; }, 1 + round % 2) == parking_lot::park_woken)
+                    __atomic_add_fetch(&_woken, 1, __ATOMIC_RELAXED);
+                return;
+            }
+            while(__atomic_load_n(&_parked, __ATOMIC_ACQUIRE) != _waiters) std::this_thread::yield();
+            if(round % 3 != 0) std::this_thread::sleep_for(std::chrono::microseconds(500 * (round % 4)));
+
+            // a popped waiter returns woken, a timed out waiter is not counted
+            __atomic_add_fetch(&_counted, parking_lot::unpark_all(&_word), __ATOMIC_RELAXED);
+        });
+        CHECK(_woken == _counted);
+        CHECK(parking_lot::unpark_all(&_word) == 0);
+    }
+}
+
+static void test_latch() {
+    const unsigned _threads = host_test::max_threads() + 1;
+    latch _latch(_threads);
+    volatile unsigned _passed = 0;
+
+    CHECK(_latch.wait(10) == 1);
+
+    host_test::run_threads(_threads, [&](unsigned) {
+        CHECK(_latch.arrive_and_wait(1, 5000) == 0);
+        __atomic_add_fetch(&_passed, 1, __ATOMIC_RELAXED);
+    });
+    CHECK(_passed == _threads);
+    CHECK(_latch.try_wait());
+    CHECK(_latch.wait(0) == 0);
+}
+
+static void test_binary_semaphore() {
+    basic_binary_semaphore _sem;
+    volatile long _counter = 0;
+    volatile int _inside = 0;
+
+    CHECK(_sem.lock() == 0);
+    CHECK(_sem.is_locked());
+    CHECK(_sem.lock(10) == 1);
+    _sem.unlock();
+
+    host_test::run_threads(host_test::max_threads() + 2, [&](unsigned) {
+        for(int i = 0; i < 5000; i++) {
+            CHECK(_sem.lock() == 0);
+            CHECK(__atomic_add_fetch(&_inside, 1, __ATOMIC_RELAXED) == 1);
+            _counter = _counter + 1;
+            __atomic_sub_fetch(&_inside, 1, __ATOMIC_RELAXED);
+            _sem.unlock();
+        }
+    });
+    CHECK(_counter == long(host_test::max_threads() + 2) * 5000);
+    CHECK(!_sem.is_locked());
+}
+
+static void test_atomic_wait() {
+    atomic::atomic_int _value(0);
+
+    // not changed, the timeout
+    CHECK(!_value.wait(0, atomic::memory_order::SeqCst, 10));
+    // changed, no park
+    CHECK(_value.wait(1, atomic::memory_order::SeqCst, 10));
+
+    volatile int _seen = -1;
+    host_test::run_threads(3, [&](unsigned index) {
+        if(index < 2) {
+            CHECK(_value.wait(0, atomic::memory_order::SeqCst, 5000));
+            __atomic_store_n(&_seen, _value.load(), __ATOMIC_RELAXED);
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        _value.store(7);
+        _value.notify_all();
+    });
+    CHECK(_seen == 7);
+}
+
+int main() {
+    test_park_unpark();
+    test_unpark_all_timeout_race();
+    test_latch();
+    test_binary_semaphore();
+    test_atomic_wait();
+    std::printf("test_parking_lot: ok\n");
+    return 0;
+}
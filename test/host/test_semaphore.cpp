@@ -0,0 +1,85 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * basic_counting_semaphore: acquire(n)/release(n) under contention never hands
+ * out more permits than exist, the timeout and all permits are free at the end.
+ */
+#include "host_test.hpp"
+#include "core/semaphore.hpp"
+
+using namespace squads;
+
+static void test_stress() {
+    basic_counting_semaphore<8> _sem;
+    int _used = 0;
+    const unsigned _threads = host_test::max_threads() + 2;
+
+    host_test::run_threads(_threads, [&](unsigned index) {
+        unsigned _seed = index * 7919 + 1;
+
+        for(int i = 0; i < 5000; i++) {
+            _seed = _seed * 1103515245 + 12345;
+            size_t _n = 1 + (_seed >> 16) % 4;
+
+            CHECK(_sem.acquire(_n) == 0);
+            int _now = __atomic_add_fetch(&_used, int(_n), __ATOMIC_RELAXED);
+            CHECK(_now <= 8);
+            __atomic_sub_fetch(&_used, int(_n), __ATOMIC_RELAXED);
+            CHECK(_sem.release(_n) == 0);
+        }
+    });
+    CHECK(_sem.get_left() == 8);
+}
+
+static void test_timeout_and_limits() {
+    basic_counting_semaphore<4> _sem(2);
+
+    CHECK(_sem.acquire(5) == 1);
+    CHECK(_sem.try_acquire(2));
+    CHECK(!_sem.try_acquire(1));
+    CHECK(_sem.acquire(1, 10) == 1);
+    CHECK(_sem.release(4) == 0);
+    CHECK(_sem.release(1) == 1);
+    CHECK(_sem.get_left() == 4);
+}
+
+static void test_wake_large_request() {
+    basic_counting_semaphore<4> _sem(0);
+    volatile bool _got = false;
+
+    std::thread _waiter([&] {
+        CHECK(_sem.acquire(3) == 0);
+        __atomic_store_n(&_got, true, __ATOMIC_RELEASE);
+    });
+    _sem.release(1);
+    _sem.release(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(!__atomic_load_n(&_got, __ATOMIC_ACQUIRE));
+    _sem.release(1);
+    _waiter.join();
+    CHECK(_got);
+    CHECK(_sem.get_left() == 0);
+}
+
+int main() {
+    test_stress();
+    test_timeout_and_limits();
+    test_wake_large_request();
+    std::printf("test_semaphore: ok\n");
+    return 0;
+}
@@ -0,0 +1,162 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * shared_mutex and distributed_shared_mutex: readers never see a half written
+ * pair under reader/writer contention; the writer of the distributed mutex
+ * parks until the last reader leaves; downgrade and upgrade of the shared_mutex.
+ */
+#include "host_test.hpp"
+#include "core/shared_mutex.hpp"
+
+using namespace squads;
+
+template <class TMUTEX>
+static void test_contention() {
+    TMUTEX _mutex;
+    volatile long _first = 0, _second = 0;
+    volatile int _readers = 0;
+    volatile int _writers = 0;
+    const int _rounds = 2000;
+
+    host_test::run_threads(host_test::max_threads() + 2, [&](unsigned index) {
+        for(int i = 0; i < _rounds; i++) {
+            if(index % 3 == 0) {
+                CHECK(_mutex.lock() == 0);
+                CHECK(__atomic_add_fetch(&_writers, 1, __ATOMIC_RELAXED) == 1);
+                CHECK(__atomic_load_n(&_readers, __ATOMIC_RELAXED) == 0);
+
+                _first = _first + 1;
+                std::this_thread::yield();
+                _second = _second + 1;
+
+                __atomic_sub_fetch(&_writers, 1, __ATOMIC_RELAXED);
+                _mutex.unlock();
+            } else {
+                CHECK(_mutex.lock_shared() == 0);
+                __atomic_add_fetch(&_readers, 1, __ATOMIC_RELAXED);
+                CHECK(__atomic_load_n(&_writers, __ATOMIC_RELAXED) == 0);
+                CHECK(_first == _second);
+
+                __atomic_sub_fetch(&_readers, 1, __ATOMIC_RELAXED);
+                _mutex.unlock_shared();
+            }
+        }
+    });
+    CHECK(_first == _second);
+    CHECK(_mutex.get_reader_count() == 0);
+    CHECK(!_mutex.is_locked());
+}
+
+static void test_distributed_writer_parks() {
+    distributed_shared_mutex _mutex;
+    volatile bool _held = false;
+    volatile bool _released = false;
+
+    host_test::run_threads(2, [&](unsigned index) {
+        if(index == 0) {
+            CHECK(_mutex.lock_shared() == 0);
+            __atomic_store_n(&_held, true, __ATOMIC_RELEASE);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+            __atomic_store_n(&_released, true, __ATOMIC_RELEASE);
+            _mutex.unlock_shared();
+            return;
+        }
+        while(!__atomic_load_n(&_held, __ATOMIC_ACQUIRE)) std::this_thread::yield();
+
+        // the reader holds longer than the timeout, the gate opens again
+        CHECK(_mutex.lock(10) == 1);
+        CHECK(!_mutex.is_locked());
+
+        double _wait = host_test::measure([&] { CHECK(_mutex.lock(5000) == 0); });
+        CHECK(__atomic_load_n(&_released, __ATOMIC_ACQUIRE));
+        CHECK(_wait < 1.0);
+        CHECK(!_mutex.try_lock_shared());
+        _mutex.unlock();
+    });
+    CHECK(_mutex.try_lock_shared());
+    _mutex.unlock_shared();
+}
+
+static void test_downgrade() {
+    shared_mutex _mutex;
+    volatile bool _downgraded = false;
+    volatile bool _done = false;
+
+    host_test::run_threads(2, [&](unsigned index) {
+        if(index == 0) {
+            CHECK(_mutex.lock() == 0);
+            __atomic_store_n(&_downgraded, true, __ATOMIC_RELEASE);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+            // wakes up the parked reader, the lock is never free between
+            CHECK(_mutex.unlock_and_lock_shared() == 0);
+            CHECK(!_mutex.try_lock());
+            while(!__atomic_load_n(&_done, __ATOMIC_ACQUIRE)) std::this_thread::yield();
+
+            _mutex.unlock_shared();
+            return;
+        }
+        while(!__atomic_load_n(&_downgraded, __ATOMIC_ACQUIRE)) std::this_thread::yield();
+
+        CHECK(_mutex.lock_shared(5000) == 0);
+        CHECK(_mutex.get_reader_count() == 2);
+        _mutex.unlock_shared();
+        __atomic_store_n(&_done, true, __ATOMIC_RELEASE);
+    });
+    CHECK(_mutex.get_reader_count() == 0);
+
+    // no waiter, the fast path
+    CHECK(_mutex.lock() == 0);
+    CHECK(_mutex.unlock_and_lock_shared() == 0);
+    CHECK(_mutex.get_reader_count() == 1);
+    CHECK(!_mutex.is_locked());
+    _mutex.unlock_shared();
+}
+
+static void test_upgrade() {
+    shared_mutex _mutex;
+
+    CHECK(_mutex.lock_shared() == 0);
+    CHECK(_mutex.lock_shared() == 0);
+
+    // two readers, no upgrade
+    CHECK(!_mutex.try_unlock_shared_and_lock());
+    CHECK(_mutex.get_reader_count() == 2);
+    _mutex.unlock_shared();
+
+    CHECK(_mutex.try_unlock_shared_and_lock());
+    CHECK(_mutex.is_locked());
+    CHECK(_mutex.get_reader_count() == 0);
+    CHECK(!_mutex.try_lock_shared());
+
+    CHECK(_mutex.unlock_and_lock_shared() == 0);
+    _mutex.unlock_shared();
+    CHECK(_mutex.try_lock());
+    _mutex.unlock();
+}
+
+int main() {
+    test_contention<shared_mutex>();
+    test_contention<distributed_shared_mutex>();
+    test_distributed_writer_parks();
+    test_downgrade();
+    test_upgrade();
+    std::printf("test_shared_mutex: ok\n");
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * shared_ptr and weak_ptr: the object dies with the last shared pointer, a weak
+ * lock never returns a dead object (also racing with the last release), and a
+ * aliasing pointer shares the ownership of its owner.
+ */
+#include "host_test.hpp"
+#include "core/shared_ptr.hpp"
+#include "core/weak_ptr.hpp"
+
+using namespace squads;
+
+static int g_live = 0;
+
+struct tracked {
+    tracked() : alive(1), value(0) { __atomic_add_fetch(&g_live, 1, __ATOMIC_RELAXED); }
+    virtual ~tracked() {
+        alive = 0;
+        __atomic_sub_fetch(&g_live, 1, __ATOMIC_RELAXED);
+    }
+
+    volatile int alive;
+    int value;
+};
+
+struct derived : public tracked {
+    int extra = 7;
+};
+
+struct counting_delete {
+    int* calls;
+
+    void operator()(tracked* ptr) const noexcept {
+        (*calls)++;
+        delete ptr;
+    }
+};
+
+static void test_weak_lock_expiry() {
+    shared_ptr<tracked> _shared = make_shared<tracked>();
+    weak_ptr<tracked> _weak(_shared);
+
+    CHECK(_shared.use_count() == 1);
+    CHECK(!_weak.expired());
+    {
+        shared_ptr<tracked> _locked = _weak.lock();
+        CHECK(_locked.get() == _shared.get());
+        CHECK(_shared.use_count() == 2);
+    }
+    CHECK(_weak.use_count() == 1);
+
+    // the object dies with the last shared pointer, the weak pointer stays
+    _shared.reset();
+    CHECK(g_live == 0);
+    CHECK(_weak.expired());
+    CHECK(!_weak.lock());
+    CHECK(_weak.use_count() == 0);
+
+    // a deleter runs once, also with weak pointers left
+    int _calls = 0;
+    shared_ptr<tracked> _owned(new tracked(), counting_delete{ &_calls });
+    weak_ptr<tracked> _observer(_owned);
+    shared_ptr<tracked> _copy(_owned);
+
+    _owned.reset();
+    CHECK(_calls == 0 && !_observer.expired());
+    _copy.reset();
+    CHECK(_calls == 1 && _observer.expired());
+    _observer.reset();
+    CHECK(_calls == 1 && g_live == 0);
+}
+
+static void test_weak_lock_race() {
+    for(int round = 0; round < 200; round++) {
+        shared_ptr<tracked> _shared = make_shared<tracked>();
+        weak_ptr<tracked> _weak(_shared);
+        volatile bool _go = false;
+
+        host_test::run_threads(3, [&](unsigned index) {
+            if(index == 0) {
+                while(!__atomic_load_n(&_go, __ATOMIC_ACQUIRE)) std::this_thread::yield();
+                _shared.reset();
+                return;
+            }
+            __atomic_store_n(&_go, true, __ATOMIC_RELEASE);
+
+            // a locked object is alive, until the lock is released
+            for(int i = 0; i < 200; i++) {
+                shared_ptr<tracked> _locked = _weak.lock();
+                if(!_locked) {
+                    CHECK(_weak.expired());
+                    break;
+                }
+                CHECK(_locked->alive == 1);
+            }
+        });
+        CHECK(_weak.expired());
+        CHECK(g_live == 0);
+    }
+}
+
+static void test_aliasing() {
+    shared_ptr<derived> _owner = make_shared<derived>();
+    shared_ptr<int> _alias(_owner, &_owner->extra);
+
+    CHECK(*_alias == 7);
+    CHECK(_owner.use_count() == 2);
+    CHECK(!_alias.owner_before(_owner) && !_owner.owner_before(_alias));
+
+    // the alias keeps the owner alive
+    weak_ptr<int> _weak(_alias);
+    _owner.reset();
+    CHECK(g_live == 1);
+    CHECK(_alias.use_count() == 1);
+
+    shared_ptr<int> _locked = _weak.lock();
+    CHECK(_locked.get() == _alias.get() && *_locked == 7);
+    _locked.reset();
+
+    _alias.reset();
+    CHECK(g_live == 0);
+    CHECK(_weak.expired());
+
+    // a alias of a empty owner owns nothing
+    shared_ptr<int> _empty(shared_ptr<derived>(), nullptr);
+    CHECK(_empty.use_count() == 0);
+}
+
+static void test_conversion() {
+    shared_ptr<derived> _derived = make_shared<derived>();
+    shared_ptr<tracked> _base(_derived);
+    weak_ptr<tracked> _weak(_base);
+
+    CHECK(_base.get() == _derived.get());
+    CHECK(_derived.use_count() == 2);
+
+    _derived.reset();
+    CHECK(!_weak.expired());
+    _base.reset();
+    CHECK(_weak.expired() && g_live == 0);
+
+    using single_ptr = basic_shared_ptr<tracked, shared_count_single>;
+    single_ptr _single = make_shared<tracked, shared_count_single>();
+    single_ptr _second(_single);
+    CHECK(_single.use_count() == 2);
+    _single.reset();
+    _second.reset();
+    CHECK(g_live == 0);
+}
+
+int main() {
+    test_weak_lock_expiry();
+    test_weak_lock_race();
+    test_aliasing();
+    test_conversion();
+    std::printf("test_shared_ptr: ok\n");
+    return 0;
+}
@@ -0,0 +1,134 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * slab allocator stress: all threads allocate objects of mixed sizes, write them,
+ * free a part self and hand the rest to a other thread, which frees them on its
+ * own magazine. No object may be owned twice, and after the threads ended (their
+ * magazines are drained) each depot holds all objects of its pages.
+ */
+#include "host_test.hpp"
+#include "memory/basic_slab_allocator.hpp"
+
+#include <mutex>
+#include <vector>
+
+using namespace squads;
+using namespace squads::memory;
+
+using slab = basic_slab<>;
+
+static const size_t g_sizes[] = { 8, 12, 24, 40, 64, 200 };
+
+struct handoff {
+    void* ptr;
+    size_t size;
+    uintptr_t tag;
+};
+
+static void fill(void* ptr, size_t size, uintptr_t tag) {
+    uintptr_t* _words = static_cast<uintptr_t*>(ptr);
+    for(size_t i = 0; i < size / sizeof(uintptr_t); i++) _words[i] = tag;
+}
+
+static bool verify(void* ptr, size_t size, uintptr_t tag) {
+    uintptr_t* _words = static_cast<uintptr_t*>(ptr);
+    for(size_t i = 0; i < size / sizeof(uintptr_t); i++)
+        if(_words[i] != tag) return false;
+    return true;
+}
+
+static void test_class_of() {
+    CHECK(slab::class_of(1, 1) == 0);
+    CHECK(memory::internal::slab_class_size(slab::class_of(12, 4)) == 12);
+    // a 12 byte object asks for max_alignment, so it gets a class of a multiple
+    CHECK((memory::internal::slab_class_size(slab::class_of(12, squads::alignment_for(12))) % squads::alignment_for(12)) == 0);
+    CHECK(slab::class_of(slab::max_size + 1, 1) == -1);
+    CHECK(slab::class_of(8, squads::max_alignment * 2) == -1);
+}
+
+static void test_stress() {
+    std::mutex _mtx;
+    std::vector<handoff> _shared;
+    const unsigned _threads = host_test::max_threads() + 2;
+
+    host_test::run_threads(_threads, [&](unsigned index) {
+        handoff _held[16];
+        unsigned _seed = index * 7919 + 1;
+
+        for(int r = 0; r < 4000; r++) {
+            size_t _n = 0;
+
+            for(; _n < 16; _n++) {
+                _seed = _seed * 1103515245 + 12345;
+                size_t _size = g_sizes[(_seed >> 16) % (sizeof(g_sizes) / sizeof(g_sizes[0]))];
+                void* _ptr = slab::allocate(_size, squads::alignment_for(_size));
+
+                CHECK(_ptr != nullptr);
+                CHECK((uintptr_t(_ptr) % squads::alignment_for(_size)) == 0);
+
+                uintptr_t _tag = (uintptr_t(index + 1) << 24) | uintptr_t(r * 16 + _n);
+                fill(_ptr, _size, _tag);
+                _held[_n] = handoff{ _ptr, _size, _tag };
+            }
+            if((r & 3) == 0) std::this_thread::yield();
+
+            // free the half self, give the other half a other thread to free
+            for(size_t i = 0; i < _n; i++) {
+                CHECK(verify(_held[i].ptr, _held[i].size, _held[i].tag));
+                if(i & 1) {
+                    std::lock_guard<std::mutex> _lock(_mtx);
+                    _shared.push_back(_held[i]);
+                } else {
+                    slab::deallocate(_held[i].ptr, _held[i].size, squads::alignment_for(_held[i].size));
+                }
+            }
+            for(;;) {
+                handoff _other;
+                {
+                    std::lock_guard<std::mutex> _lock(_mtx);
+                    if(_shared.empty()) break;
+                    _other = _shared.back();
+                    _shared.pop_back();
+                }
+                CHECK(verify(_other.ptr, _other.size, _other.tag));
+                slab::deallocate(_other.ptr, _other.size, squads::alignment_for(_other.size));
+            }
+        }
+    });
+    for(const handoff& h : _shared)
+        slab::deallocate(h.ptr, h.size, squads::alignment_for(h.size));
+    slab::flush();
+
+    for(int i = 0; i < slab::class_count; i++) {
+        slab_stats _stats;
+        CHECK(slab::get_stats(i, _stats));
+        CHECK(_stats.allocations == _stats.frees);
+
+        size_t _page = SQUADS_CONFIG_SLAB_PAGE_SIZE;
+        if(_page < _stats.size * SQUADS_CONFIG_SLAB_MAGAZINE_SIZE)
+            _page = _stats.size * SQUADS_CONFIG_SLAB_MAGAZINE_SIZE;
+        CHECK(_stats.depot == _stats.pages * (_page / _stats.size));
+    }
+}
+
+int main() {
+    test_class_of();
+    test_stress();
+    std::printf("test_slab_allocator: ok\n");
+    return 0;
+}
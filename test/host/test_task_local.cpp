@@ -0,0 +1,115 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * task_local: each thread has its own value, the values are destroyed when the
+ * thread ends, and a destroyed task_local releases its slot and destroys the
+ * values of the living threads.
+ */
+#include "host_test.hpp"
+#include "core/task_local.hpp"
+
+#include <memory>
+
+using namespace squads;
+
+static int g_iLive = 0;
+
+struct tracked {
+    int value;
+    tracked() : value(0) { __atomic_add_fetch(&g_iLive, 1, __ATOMIC_RELAXED); }
+    explicit tracked(int v) : value(v) { __atomic_add_fetch(&g_iLive, 1, __ATOMIC_RELAXED); }
+    tracked(const tracked& other) : value(other.value) { __atomic_add_fetch(&g_iLive, 1, __ATOMIC_RELAXED); }
+    ~tracked() { __atomic_sub_fetch(&g_iLive, 1, __ATOMIC_RELAXED); }
+};
+
+static int live() { return __atomic_load_n(&g_iLive, __ATOMIC_RELAXED); }
+
+static void test_per_thread() {
+    task_local<tracked> _local(tracked(7));
+
+    CHECK(_local.get_slot() >= 0);
+    host_test::run_threads(4, [&](unsigned index) {
+        CHECK(!_local.has_value());
+        CHECK(_local->value == 7);
+        _local->value = int(index);
+        std::this_thread::yield();
+        CHECK(_local->value == int(index));
+    });
+    // the values of the ended threads are gone, only the initial value lives
+    CHECK(live() == 1);
+}
+
+static void test_release_slot() {
+    std::unique_ptr<task_local<tracked>> _local(new task_local<tracked>());
+    const int _slot = _local->get_slot();
+    volatile bool _released = false;
+    volatile int _ready = 0;
+
+    CHECK(_slot >= 0);
+    (*_local)->value = 1;
+
+    host_test::run_threads(2, [&](unsigned index) {
+        if(index == 0) {
+            (*_local)->value = 2;
+            __atomic_add_fetch(&_ready, 1, __ATOMIC_RELEASE);
+            // the value dies with the slot, while the thread lives
+            while(!__atomic_load_n(&_released, __ATOMIC_ACQUIRE)) std::this_thread::yield();
+            return;
+        }
+        while(__atomic_load_n(&_ready, __ATOMIC_ACQUIRE) == 0) std::this_thread::yield();
+        // the initial value, the value of main and of thread 0
+        CHECK(live() == 3);
+        _local.reset();
+        CHECK(live() == 0);
+        __atomic_store_n(&_released, true, __ATOMIC_RELEASE);
+    });
+    CHECK(live() == 0);
+
+    // the slot is free again and the new object sees no stale value
+    task_local<int> _next;
+    CHECK(_next.get_slot() == _slot);
+    CHECK(!_next.has_value());
+    CHECK(*_next == 0);
+}
+
+static void test_all_slots() {
+    std::unique_ptr<task_local<int>> _locals[SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS + 1];
+    int _used = 0;
+
+    // take the free slots, until one is missing
+    while(_used <= SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS) {
+        _locals[_used].reset(new task_local<int>());
+        if(_locals[_used]->get_slot() < 0) break;
+        _used++;
+    }
+    CHECK(_used > 0 && _used < SQUADS_CONFIG_TASK_LOCAL_MAX_SLOTS + 1);
+    CHECK(_locals[_used]->get() == nullptr);
+
+    _locals[0].reset();
+    task_local<int> _again;
+    CHECK(_again.get_slot() >= 0);
+    CHECK(*_again == 0);
+}
+
+int main() {
+    test_per_thread();
+    test_release_slot();
+    test_all_slots();
+    std::printf("test_task_local: ok\n");
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*
+*This file is part of the SQUADS Library (https://github.com/eotpcomic/squads ).
+*Copyright (c) 2023 Amber-Sophia Schroeck
+*
+*The SQUADS Library is free software; you can redistribute it and/or modify
+*it under the terms of the GNU Lesser General Public License as published by
+*the Free Software Foundation, version 2.1, or (at your option) any later version.
+
+*The SQUADS Library is distributed in the hope that it will be useful, but
+*WITHOUT ANY WARRANTY; without even the implied warranty of
+*MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+*General Public License for more details.
+*
+*You should have received a copy of the GNU Lesser General Public
+*License along with the SQUADS  Library; if not, see
+*<https://www.gnu.org/licenses/>.
+*/
+/*
+ * wait_queue: a foreign notification on the park index (task::notify, a mailbox)
+ * never lets a waiter return, neither while it waits nor while a waker still
+ * holds its popped node; the timeout removes the node.
+ */
+#include "host_test.hpp"
+#include "core/wait_queue.hpp"
+
+using namespace squads;
+
+static void test_foreign_notify() {
+    wait_queue _queue;
+    void* volatile _task = nullptr;
+    volatile bool _queued = false;
+    volatile bool _released = false;
+    wait_node* volatile _node = nullptr;
+
+    host_test::run_threads(2, [&](unsigned index) {
+        if(index == 0) {
+            wait_node _self;
+
+            _queue.lock();
+            _queue.push_back(&_self);
+            _node = &_self;
+            _task = _self.task;
+            __atomic_store_n(&_queued, true, __ATOMIC_RELEASE);
+
+            CHECK(_queue.wait(_self, SQUADS_PORTMAX_DELAY));
+            CHECK(__atomic_load_n(&_released, __ATOMIC_ACQUIRE));
+            return;
+        }
+        while(!__atomic_load_n(&_queued, __ATOMIC_ACQUIRE)) std::this_thread::yield();
+
+        // a stray notify while the node is queued
+        arch::arch_notify_give(_task);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        _queue.lock();
+        wait_node* _chain = _queue.front();
+        CHECK(_chain == _node);
+        _queue.pop(_chain);
+        _queue.unlock();
+
+        // and one while the waker still reads the popped node
+        arch::arch_notify_give(_task);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        CHECK(_chain->task == _task);
+
+        __atomic_store_n(&_released, true, __ATOMIC_RELEASE);
+        wait_queue::wake_chain(_chain);
+    });
+}
+
+static void test_timeout() {
+    wait_queue _queue;
+    wait_node _self;
+
+    _queue.lock();
+    _queue.push_back(&_self);
+    CHECK(!_queue.wait(_self, 20));
+
+    _queue.lock();
+    CHECK(_queue.empty());
+    CHECK(_queue.pop_front() == nullptr);
+    _queue.unlock();
+}
+
+int main() {
+    test_foreign_notify();
+    test_timeout();
+    std::printf("test_wait_queue: ok\n");
+    return 0;
+}